@@ -41,10 +41,17 @@ Based on example file from SideFX
 #define __HAPI_CPP_h__
 
 #include <HAPI/HAPI.h>
+#include <daHoudiniEngine/hapiTrace.h>
+#include <daHoudiniEngine/hapiVersion.h>
+#ifdef DA_HAPI_STANDIN
+#include <daHoudiniEngine/hapiStandIn.h>
+#endif
+#include <cstring>
 #include <string>
 #include <vector>
 #include <map>
 #include <stdexcept>
+#include <algorithm>
 // for cout
 #include <iostream>
 
@@ -113,6 +120,54 @@ static void throwOnFailure(HAPI_Result result)
 //----------------------------------------------------------------------------
 // Utility functions:
 
+// Strings of the handles resolved since the last cook. A cook can hand out
+// new handles and reuse old ones, so Node::cook() starts a new generation,
+// and so must whoever sees a cook finish (newCookGeneration): an async cook
+// or a node cooked on creation hands them out after cook() has returned.
+// One instance for the whole module; like the rest of this file it isn't
+// thread safe
+class StringCache
+{
+public:
+    static StringCache &instance()
+    {
+	static StringCache cache;
+	return cache;
+    }
+
+    void newGeneration()
+    {
+	_strings.clear();
+	_generation++;
+    }
+
+    int generation() const
+    { return _generation; }
+
+    bool find(const HAPI_Session* session, int string_handle, std::string &value) const
+    {
+	std::map<Key, std::string>::const_iterator it =
+	    _strings.find(Key(session, string_handle));
+	if (it == _strings.end())
+	    return false;
+	value = it->second;
+	return true;
+    }
+
+    bool contains(const HAPI_Session* session, int string_handle) const
+    { return _strings.count(Key(session, string_handle)) > 0; }
+
+    void insert(const HAPI_Session* session, int string_handle, const std::string &value)
+    { _strings[Key(session, string_handle)] = value; }
+
+private:
+    StringCache() : _generation(0) {}
+
+    typedef std::pair<const HAPI_Session*, int> Key;
+    std::map<Key, std::string> _strings;
+    int _generation;
+};
+
 // Return a std::string corresponding to a string handle.
 static std::string getString(HAPI_Session* session, int string_handle)
 {
@@ -122,16 +177,115 @@ static std::string getString(HAPI_Session* session, int string_handle)
     if (string_handle == 0)
 	return "";
 
+    std::string result;
+    if (StringCache::instance().find(session, string_handle, result))
+	return result;
+
     int buffer_length;
-    throwOnFailure(HAPI_GetStringBufLength(session, string_handle, &buffer_length));
+    throwOnFailure(HAPI_TRACE(sizeof(int), HAPI_GetStringBufLength(session, string_handle, &buffer_length)));
+
+    std::vector<char> buf(buffer_length + 1, '\0');
+
+    throwOnFailure(HAPI_TRACE(buffer_length, HAPI_GetString(session, string_handle, &buf[0], buffer_length)));
+    result = &buf[0];
+    StringCache::instance().insert(session, string_handle, result);
+    return result;
+}
+
+// Resolve many handles at once: the ones not cached yet are fetched with a
+// single HAPI_GetStringBatchSize / HAPI_GetStringBatch pair, or one by one
+// before Houdini Engine 3.2
+static std::vector<std::string> getStrings(HAPI_Session* session, const std::vector<int> &string_handles)
+{
+    StringCache &cache = StringCache::instance();
 
-    char * buf = new char[ buffer_length ];
+    std::vector<int> missing;
+    for (size_t i = 0; i < string_handles.size(); ++i)
+    {
+	int handle = string_handles[i];
+	if (handle != 0 && !cache.contains(session, handle))
+	    missing.push_back(handle);
+    }
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
 
-    throwOnFailure(HAPI_GetString(session, string_handle, buf, buffer_length));
-    std::string result(buf);
+#if HAPI_HAS_STRING_BATCH
+    if (!missing.empty())
+    {
+	int buffer_size = 0;
+	throwOnFailure(HAPI_TRACE(missing.size() * sizeof(int), HAPI_GetStringBatchSize(
+	    session, &missing[0], int(missing.size()), &buffer_size)));
+
+	// the strings, each null terminated, in the order of the handles
+	std::vector<char> buf(buffer_size + 1, '\0');
+	if (buffer_size > 0)
+	    throwOnFailure(HAPI_TRACE(buffer_size, HAPI_GetStringBatch(
+		session, &buf[0], buffer_size)));
+
+	const char* c = &buf[0];
+	const char* end = c + buffer_size;
+	for (size_t i = 0; i < missing.size(); ++i)
+	{
+	    std::string value(c < end ? c : "");
+	    cache.insert(session, missing[i], value);
+	    c += value.size() + 1;
+	}
+    }
+#else
+    for (size_t i = 0; i < missing.size(); ++i)
+	getString(session, missing[i]);
+#endif
+
+    std::vector<std::string> result(string_handles.size());
+    for (size_t i = 0; i < string_handles.size(); ++i)
+	if (string_handles[i] != 0)
+	    cache.find(session, string_handles[i], result[i]);
     return result;
 }
 
+// Object, geo and part infos fetched since the last cook. The wrappers are
+// copied around a lot during the traversal and each copy used to query its
+// own info again; this keeps one query per node (and one bulk query for all
+// the objects of an asset) per cook. Like StringCache, not thread safe
+class InfoCache
+{
+public:
+    static InfoCache &instance()
+    {
+	static InfoCache cache;
+	return cache;
+    }
+
+    void newGeneration()
+    {
+	objectInfos.clear();
+	objectTransforms.clear();
+	geoInfos.clear();
+	partInfos.clear();
+    }
+
+    typedef std::pair<const HAPI_Session*, HAPI_NodeId> NodeKey;
+    typedef std::pair<NodeKey, HAPI_PartId> PartKey;
+
+    // keyed by the asset node
+    std::map<NodeKey, std::vector<HAPI_ObjectInfo> > objectInfos;
+    std::map<NodeKey, std::vector<HAPI_Transform> > objectTransforms;
+    // keyed by the object node
+    std::map<NodeKey, HAPI_GeoInfo> geoInfos;
+    // keyed by the geo node and part id
+    std::map<PartKey, HAPI_PartInfo> partInfos;
+
+private:
+    InfoCache() {}
+};
+
+// A cook (or a deleted node) invalidates the handles and infos from before
+static void newCookGeneration()
+{
+    StringCache::instance().newGeneration();
+    InfoCache::instance().newGeneration();
+}
+
 //----------------------------------------------------------------------------
 // Classes:
 // TODO:
@@ -159,57 +313,46 @@ class Asset;
 class Node
 {
 public:
+    // The infos of these wrappers are held by value, so the implicit copy
+    // constructor and assignment are plain memberwise copies, no allocation
     Node(int id, HAPI_Session* mySession)
-    : nodeid(id), _nodeInfo(NULL), session(mySession)
+    : nodeid(id), session(mySession), _hasNodeInfo(false)
     {}
 
-    Node(const Node &node)
-    : nodeid(node.nodeid)
-    , _nodeInfo(node._nodeInfo ? new HAPI_NodeInfo(*node._nodeInfo) : NULL)
-	, session(node.session)
-    {}
-
-    ~Node()
-    {
-	delete this->_nodeInfo;
-    }
-
-    Node &operator=(const Node &node)
-    {
-	if (this != &node)
-	{
-	    delete this->_nodeInfo;
-	    this->nodeid = node.nodeid;
-	    this->_nodeInfo = node._nodeInfo
-		? new HAPI_NodeInfo(*node._nodeInfo) : NULL;
-	}
-	return *this;
-    }
-
     const HAPI_NodeInfo &nodeInfo() const
     {
-	if (!this->_nodeInfo)
+	if (!this->_hasNodeInfo)
 	{
-	    this->_nodeInfo = new HAPI_NodeInfo();
-	    throwOnFailure(HAPI_GetNodeInfo(
+	    throwOnFailure(HAPI_TRACE(sizeof(HAPI_NodeInfo), HAPI_GetNodeInfo(
 		session,
-		nodeid, this->_nodeInfo));
+		nodeid, &this->_nodeInfo)));
+	    this->_hasNodeInfo = true;
 	}
-	return *this->_nodeInfo;
+	return this->_nodeInfo;
     }
 
     std::vector<Parm> parms() const;
     std::map<std::string, Parm> parmMap() const;
 
+    // A single parm by name, one call instead of the whole parms() list.
+    // Returns false if the node has no such parm
+    bool findParm(const char *parm_name, HAPI_ParmInfo &parm_info) const
+    {
+	HAPI_Result result = HAPI_TRACE(sizeof(HAPI_ParmInfo), HAPI_GetParmInfoFromName(
+		session,
+	    this->nodeid, parm_name, &parm_info));
+	return result == HAPI_RESULT_SUCCESS && parm_info.id >= 0;
+    }
+
     bool isValid() const
     {
 	HAPI_Bool is_valid = 0;
 	try
 	{
         // always succeeds
-	    throwOnFailure(HAPI_IsNodeValid(
+	    throwOnFailure(HAPI_TRACE(sizeof(HAPI_Bool), HAPI_IsNodeValid(
 		session,
-		this->nodeid, this->nodeInfo().uniqueHoudiniNodeId, &is_valid));
+		this->nodeid, this->nodeInfo().uniqueHoudiniNodeId, &is_valid)));
 	    return is_valid;
 	}
 	catch (Failure &failure)
@@ -225,19 +368,29 @@ public:
     { return getString(session, nodeInfo().internalNodePathSH); }
 
     void deleteNode() const
-    { throwOnFailure(HAPI_DeleteNode(session, this->nodeid)); }
+    {
+	newCookGeneration();
+	throwOnFailure(HAPI_TRACE(0, HAPI_DeleteNode(session, this->nodeid)));
+    }
 
     void cook() const
-    { throwOnFailure(HAPI_CookNode(session, this->nodeid, NULL)); }
+    {
+	newCookGeneration();
+	throwOnFailure(HAPI_TRACE(0, HAPI_CookNode(session, this->nodeid, NULL)));
+    }
 
     void cook(HAPI_CookOptions* cook_options) const
-    { throwOnFailure(HAPI_CookNode(session, this->nodeid, cook_options)); }
+    {
+	newCookGeneration();
+	throwOnFailure(HAPI_TRACE(0, HAPI_CookNode(session, this->nodeid, cook_options)));
+    }
 
     int nodeid;
 	HAPI_Session* session;
 
 protected:
-    mutable HAPI_NodeInfo *_nodeInfo;
+    mutable HAPI_NodeInfo _nodeInfo;
+    mutable bool _hasNodeInfo;
 };
 
 class Object;
@@ -247,40 +400,22 @@ class Asset : public Node
 {
 public:
     Asset(int nodeid, HAPI_Session* mySession)
-    : Node(nodeid, mySession), _info(NULL)
+    : Node(nodeid, mySession), _hasInfo(false)
     {}
 
-    Asset(const Asset &asset) : Node(asset)
-    , _info(asset._info ? new HAPI_AssetInfo(*asset._info) : NULL)
-    {
-    }
-
-    ~Asset()
-    {
-	delete this->_info;
-    }
-
-    Asset &operator=(const Asset &asset)
-    {
-	if (this != &asset)
-	{
-        Node::operator=(asset);
-	    delete this->_info;
-	    this->_info = asset._info ? new HAPI_AssetInfo(*asset._info) : NULL;
-	}
-	return *this;
-    }
-
     const HAPI_AssetInfo &info() const
     {
-	if (!this->_info)
+	if (!this->_hasInfo)
 	{
-	    this->_info = new HAPI_AssetInfo();
-	    throwOnFailure(HAPI_GetAssetInfo(session, this->nodeid, this->_info));
+	    throwOnFailure(HAPI_TRACE(sizeof(HAPI_AssetInfo), HAPI_GetAssetInfo(session, this->nodeid, &this->_info)));
+	    this->_hasInfo = true;
 	}
-	return *this->_info;
+	return this->_info;
     }
 
+    // The infos and transforms of all the objects come from one compose
+    // and two bulk calls, cached until the next cook
+    const std::vector<HAPI_ObjectInfo> &objectInfos() const;
     std::vector<Object> objects() const;
     std::vector<HAPI_Transform> transforms() const;
 
@@ -294,9 +429,9 @@ public:
         HAPI_RSTOrder rst_order, int relative_to_node_id) const
     {
 	HAPI_Transform result;
-	throwOnFailure(HAPI_GetObjectTransform(
+	throwOnFailure(HAPI_TRACE(sizeof(HAPI_Transform), HAPI_GetObjectTransform(
 		session,
-	    this->nodeid, relative_to_node_id, rst_order, &result));
+	    this->nodeid, relative_to_node_id, rst_order, &result)));
 	return result;
     }
 
@@ -304,13 +439,14 @@ public:
     {
         HAPI_Transform transform =
             this->getTransform( HAPI_SRT, -1 );
-	throwOnFailure(HAPI_ConvertTransformQuatToMatrix(
+	throwOnFailure(HAPI_TRACE(16 * sizeof(float), HAPI_ConvertTransformQuatToMatrix(
 		session,
-	    &transform, result_matrix ) );
+	    &transform, result_matrix )) );
     }
 
 private:
-    mutable HAPI_AssetInfo *_info;
+    mutable HAPI_AssetInfo _info;
+    mutable bool _hasInfo;
 };
 
 class Geo;
@@ -319,66 +455,30 @@ class Object
 {
 public:
     Object(int asset_id, int object_id, HAPI_Session* mySession)
-    : asset(asset_id, mySession), id(object_id), _info(NULL), session(mySession)
+    : asset(asset_id, mySession), id(object_id), session(mySession), _hasInfo(false)
     {}
 
     Object(const Asset &asset, int id)
-    : asset(asset), id(id), _info(NULL), session(asset.session)
+    : asset(asset), id(id), session(asset.session), _hasInfo(false)
     {}
 
-    Object(const Object &object)
-    : asset(object.asset)
-    , id(object.id)
-    , _info(object._info ? new HAPI_ObjectInfo(*object._info) : NULL)
-	, session(object.session)
+    Object(const Asset &asset, int id, const HAPI_ObjectInfo &info)
+    : asset(asset), id(id), session(asset.session), _info(info), _hasInfo(true)
     {}
 
-    ~Object()
-    { delete this->_info; }
-
-    Object &operator=(const Object &object)
-    {
-	if (this != &object)
-	{
-	    delete this->_info;
-	    asset = object.asset;
-	    this->id = object.id;
-	    this->_info = object._info
-		? new HAPI_ObjectInfo(*object._info) : NULL;
-	}
-	return *this;
-    }
-
     const HAPI_ObjectInfo &info() const
     {
-	if (!this->_info)
+	if (!this->_hasInfo)
 	{
-		// std::cout << "Object: No info, fetching.." << std::endl;
-		// std::cout << "Object:   asset id: " << this->asset.nodeid << std::endl;
-		// std::cout << "Object:   object id: " << this->id << std::endl;
-        _info = new HAPI_ObjectInfo();
-		// this doesn't work!!
-// 		throwOnFailure(HAPI_GetObjectInfo(
-// 			session,
-// 			this->asset.nodeid,
-// 			_info));
-		// this works..
-        int objectCount;
-        throwOnFailure(HAPI_ComposeObjectList(
-            session, this->asset.nodeid, NULL, &objectCount ));
-
-		throwOnFailure(HAPI_GetComposedObjectList(
-		session,
-		this->asset.nodeid,
-		_info,
-		this->id,
-		1));
-		// cout << "Object: Check some info.." << std::endl <<
-		// "Object:   nodeId: " << _info->nodeId << std::endl <<
-		// "Object:   isVisible: " << _info->isVisible << std::endl <<
-		// "Object:   instancer: "<< _info->isInstancer << std::endl;
+	    // HAPI_GetObjectInfo on the asset node doesn't work, the infos
+	    // come from the asset's composed object list
+	    const std::vector<HAPI_ObjectInfo> &infos = this->asset.objectInfos();
+	    if (this->id < 0 || this->id >= int(infos.size()))
+		throw Failure(HAPI_RESULT_INVALID_ARGUMENT);
+	    this->_info = infos[this->id];
+	    this->_hasInfo = true;
 	}
-	return *this->_info;
+	return this->_info;
     }
 
     std::vector<Geo> geos() const;
@@ -395,7 +495,8 @@ public:
 	HAPI_Session* session;
 
 private:
-    mutable HAPI_ObjectInfo *_info;
+    mutable HAPI_ObjectInfo _info;
+    mutable bool _hasInfo;
 };
 
 class Part;
@@ -406,47 +507,33 @@ class Geo
 {
 public:
     Geo(const Object &object, int id)
-    : object(object), id(id), _info(NULL), session(object.session)
+    : object(object), id(id), session(object.session), _hasInfo(false)
     {}
 
     Geo(int asset_id, int object_id, int geo_id, HAPI_Session* mySession)
-    : object(asset_id, object_id, mySession), id(geo_id), _info(NULL), session(mySession)
-    {}
-
-    Geo(const Geo &geo)
-    : object(geo.object)
-    , id(geo.id)
-    , _info(geo._info ? new HAPI_GeoInfo(*geo._info) : NULL)
-	, session(geo.session)
+    : object(asset_id, object_id, mySession), id(geo_id), session(mySession), _hasInfo(false)
     {}
 
-    ~Geo()
-    { delete _info; }
-
-    Geo &operator=(const Geo &geo)
-    {
-	if (this != &geo)
-	{
-	    delete this->_info;
-	    this->object = geo.object;
-	    this->id = geo.id;
-	    this->_info = geo._info ? new HAPI_GeoInfo(*geo._info) : NULL;
-	}
-	return *this;
-    }
-
     const HAPI_GeoInfo &info() const
     {
-	if (!this->_info)
+	if (!this->_hasInfo)
 	{
-		// std::cout << "Geo: no info, fetching.." << std::endl;
-		// std::cout << "Geo:   with object id " << this->object.info().nodeId << std::endl;
-	    this->_info = new HAPI_GeoInfo();
-	    throwOnFailure(HAPI_GetDisplayGeoInfo(
-		session,
-		this->object.info().nodeId, this->_info));
+	    InfoCache &cache = InfoCache::instance();
+	    InfoCache::NodeKey key(session, this->object.info().nodeId);
+	    std::map<InfoCache::NodeKey, HAPI_GeoInfo>::const_iterator it =
+		cache.geoInfos.find(key);
+	    if (it == cache.geoInfos.end())
+	    {
+		HAPI_GeoInfo info;
+		throwOnFailure(HAPI_TRACE(sizeof(HAPI_GeoInfo), HAPI_GetDisplayGeoInfo(
+		    session,
+		    key.second, &info)));
+		it = cache.geoInfos.insert(std::make_pair(key, info)).first;
+	    }
+	    this->_info = it->second;
+	    this->_hasInfo = true;
 	}
-	return *this->_info;
+	return this->_info;
     }
 
     std::string name() const
@@ -459,7 +546,8 @@ public:
 	HAPI_Session* session;
 
 private:
-    mutable HAPI_GeoInfo *_info;
+    mutable HAPI_GeoInfo _info;
+    mutable bool _hasInfo;
 };
 
 // TODO parts:
@@ -470,49 +558,36 @@ class Part
 {
 public:
     Part(const Geo &geo, int id)
-    : geo(geo), id(id), _info(NULL), session(geo.session)
+    : geo(geo), id(id), session(geo.session), _hasInfo(false)
     {}
 
     Part(int asset_id, int object_id, int geo_id, int part_id, HAPI_Session* mySession)
-    : geo(asset_id, object_id, geo_id, mySession), id(part_id), _info(NULL), session(mySession)
-    {}
-
-    Part(const Part &part)
-    : geo(part.geo)
-    , id(part.id)
-    , _info(part._info ? new HAPI_PartInfo(*part._info) : NULL)
-	, session(part.session)
+    : geo(asset_id, object_id, geo_id, mySession), id(part_id), session(mySession), _hasInfo(false)
     {}
 
-    ~Part()
-    { delete _info; }
-
-    Part &operator=(const Part &part)
-    {
-	if (this != &part)
-	{
-	    delete this->_info;
-	    this->geo = part.geo;
-	    this->id = part.id;
-	    this->_info = part._info ? new HAPI_PartInfo(*part._info) : NULL;
-	}
-	return *this;
-    }
-
     const HAPI_PartInfo &info() const
     {
-	if (!this->_info)
+	if (!this->_hasInfo)
 	{
-	    this->_info = new HAPI_PartInfo();
-		// std::cout << "Part: no info, fetching.." << std::endl;
-		// std::cout << "Part:   with geo's nodeid " << this->geo.info().nodeId << std::endl;
-	    throwOnFailure(HAPI_GetPartInfo(
+	    InfoCache &cache = InfoCache::instance();
+	    InfoCache::PartKey key(
+		InfoCache::NodeKey(session, this->geo.info().nodeId), this->id);
+	    std::map<InfoCache::PartKey, HAPI_PartInfo>::const_iterator it =
+		cache.partInfos.find(key);
+	    if (it == cache.partInfos.end())
+	    {
+		HAPI_PartInfo info;
+		throwOnFailure(HAPI_TRACE(sizeof(HAPI_PartInfo), HAPI_GetPartInfo(
 		    session,
-		    this->geo.info().nodeId,
-            this->id,
-            this->_info ));
+		    key.first.second,
+		    this->id,
+		    &info )));
+		it = cache.partInfos.insert(std::make_pair(key, info)).first;
+	    }
+	    this->_info = it->second;
+	    this->_hasInfo = true;
 	}
-	return *this->_info;
+	return this->_info;
     }
 
     std::string name() const
@@ -523,37 +598,58 @@ public:
     	return this->info().attributeCounts[attrib_owner];
     }
 
-    std::vector<std::string> attribNames(HAPI_AttributeOwner attrib_owner) const
+    std::vector<int> attribNameHandles(HAPI_AttributeOwner attrib_owner) const
     {
 	int num_attribs = numAttribs(attrib_owner);
-	std::vector<std::string> result;
+	std::vector<int> attrib_names_sh;
 
     // HAPI_GetAttributeNames() will fail if num_attribs given is 0, even if
     // that is the number of attributes. Return empty string vector if that is the case.
     if (num_attribs == 0) {
-        return result;
+        return attrib_names_sh;
     }
-	std::vector<int> attrib_names_sh(num_attribs);
+	attrib_names_sh.resize(num_attribs);
 
-	throwOnFailure(HAPI_GetAttributeNames(
+	throwOnFailure(HAPI_TRACE(num_attribs * sizeof(int), HAPI_GetAttributeNames(
 		session,
 	    this->geo.info().nodeId,
-	    this->id, attrib_owner, &attrib_names_sh[0], num_attribs));
+	    this->id, attrib_owner, &attrib_names_sh[0], num_attribs)));
+	return attrib_names_sh;
+    }
 
-	for (int attrib_index=0; attrib_index < int(attrib_names_sh.size());
-		++attrib_index)
-	    result.push_back(getString(session, attrib_names_sh[attrib_index]));
-	return result;
+    std::vector<std::string> attribNames(HAPI_AttributeOwner attrib_owner) const
+    { return getStrings(session, attribNameHandles(attrib_owner)); }
+
+    // the attribute names of every owner, indexed by HAPI_AttributeOwner,
+    // with the strings (and the part's name) resolved in one batch
+    void allAttribNames(std::vector<std::string> names[HAPI_ATTROWNER_MAX]) const
+    {
+	std::vector<int> handles(1, info().nameSH);
+	int counts[HAPI_ATTROWNER_MAX];
+	for (int owner = 0; owner < HAPI_ATTROWNER_MAX; ++owner)
+	{
+	    std::vector<int> owner_handles = attribNameHandles(HAPI_AttributeOwner(owner));
+	    counts[owner] = int(owner_handles.size());
+	    handles.insert(handles.end(), owner_handles.begin(), owner_handles.end());
+	}
+
+	std::vector<std::string> strings = getStrings(session, handles);
+	std::vector<std::string>::const_iterator it = strings.begin() + 1;
+	for (int owner = 0; owner < HAPI_ATTROWNER_MAX; ++owner)
+	{
+	    names[owner].assign(it, it + counts[owner]);
+	    it += counts[owner];
+	}
     }
 
     HAPI_AttributeInfo attribInfo(
 	HAPI_AttributeOwner attrib_owner, const char *attrib_name) const
     {
 	HAPI_AttributeInfo result;
-	throwOnFailure(HAPI_GetAttributeInfo(
+	throwOnFailure(HAPI_TRACE(sizeof(HAPI_AttributeInfo), HAPI_GetAttributeInfo(
 		session,
 	    this->geo.info().nodeId,
-	    this->id, attrib_name, attrib_owner, &result));
+	    this->id, attrib_name, attrib_owner, &result)));
 	return result;
     }
 
@@ -565,12 +661,22 @@ public:
 	    length = attrib_info.count - start;
 
 	float *result = new float[attrib_info.count * attrib_info.tupleSize];
-	throwOnFailure(HAPI_GetAttributeFloatData(
+	getFloatAttribData(attrib_info, attrib_name, result);
+	return result;
+    }
+
+    // fill caller-owned storage, eg. an osg::Vec3Array sized to the part.
+    // each element starts stride floats after the previous one (-1 packs
+    // them at tupleSize); HAPI uses max(stride, tupleSize)
+    void getFloatAttribData(
+	HAPI_AttributeInfo &attrib_info, const char *attrib_name,
+	float *data, int stride=-1) const
+    {
+	throwOnFailure(HAPI_TRACE(attrib_info.count * attrib_info.tupleSize * sizeof(float), HAPI_GetAttributeFloatData(
 		session,
 	    this->geo.info().nodeId,
-	    this->id, attrib_name, &attrib_info, /*stride=*/-1,
-        result, /*start=*/0, attrib_info.count));
-	return result;
+	    this->id, attrib_name, &attrib_info, stride,
+        data, /*start=*/0, attrib_info.count)));
     }
 
     int *getNewIntAttribData(
@@ -581,11 +687,11 @@ public:
 	    length = attrib_info.count - start;
 
 	int *result = new int[attrib_info.count * attrib_info.tupleSize];
-	throwOnFailure(HAPI_GetAttributeIntData(
+	throwOnFailure(HAPI_TRACE(attrib_info.count * attrib_info.tupleSize * sizeof(int), HAPI_GetAttributeIntData(
 		session,
 	    this->geo.info().nodeId,
 	    this->id, attrib_name, &attrib_info, /*stride=*/-1,
-        result, /*start=*/0, attrib_info.count));
+        result, /*start=*/0, attrib_info.count)));
 	return result;
     }
 
@@ -596,7 +702,8 @@ public:
 	HAPI_Session* session;
 
 private:
-    mutable HAPI_PartInfo *_info;
+    mutable HAPI_PartInfo _info;
+    mutable bool _hasInfo;
 };
 
 class ParmChoice;
@@ -628,68 +735,80 @@ public:
     int getIntValue(int sub_index) const
     {
 	int result;
-	throwOnFailure(HAPI_GetParmIntValues(
+	throwOnFailure(HAPI_TRACE(sizeof(int), HAPI_GetParmIntValues(
 		session,
 	    this->node_id, &result, this->_info.intValuesIndex + sub_index,
-	    /*length=*/1));
+	    /*length=*/1)));
 	return result;
     }
 
     float getFloatValue(int sub_index) const
     {
 	float result;
-	throwOnFailure(HAPI_GetParmFloatValues(
+	throwOnFailure(HAPI_TRACE(sizeof(float), HAPI_GetParmFloatValues(
 		session,
 	    this->node_id, &result, this->_info.floatValuesIndex + sub_index,
-	    /*length=*/1));
+	    /*length=*/1)));
+	return result;
+    }
+
+    // all size values in one call
+    std::vector<float> getFloatValues() const
+    {
+	std::vector<float> result(_info.size);
+	if (_info.size > 0)
+	    throwOnFailure(HAPI_TRACE(result.size() * sizeof(float), HAPI_GetParmFloatValues(
+		session,
+		this->node_id, &result[0], this->_info.floatValuesIndex,
+		_info.size)));
 	return result;
     }
 
     std::string getStringValue(int sub_index) const
     {
 	int string_handle;
-	throwOnFailure(HAPI_GetParmStringValues(
+	throwOnFailure(HAPI_TRACE(sizeof(int), HAPI_GetParmStringValues(
 		session,
 	    this->node_id, true, &string_handle,
-	    this->_info.stringValuesIndex + sub_index, /*length=*/1));
+	    this->_info.stringValuesIndex + sub_index, /*length=*/1)));
 	return getString(session, string_handle);
     }
 
     void setIntValue(int sub_index, int value)
     {
-	throwOnFailure(HAPI_SetParmIntValues(
+	throwOnFailure(HAPI_TRACE(sizeof(int), HAPI_SetParmIntValues(
 		session,
 	    this->node_id, &value, this->_info.intValuesIndex + sub_index,
-	    /*length=*/1));
+	    /*length=*/1)));
     }
 
     void setFloatValue(int sub_index, float value)
     {
-	throwOnFailure(HAPI_SetParmFloatValues(
+	throwOnFailure(HAPI_TRACE(sizeof(float), HAPI_SetParmFloatValues(
 		session,
 	    this->node_id, &value, this->_info.floatValuesIndex + sub_index,
-	    /*length=*/1));
+	    /*length=*/1)));
     }
 
     void setStringValue(int sub_index, const char *value)
     {
-	throwOnFailure(HAPI_SetParmStringValue(
+	throwOnFailure(HAPI_TRACE(strlen(value), HAPI_SetParmStringValue(
 		session,
-	    this->node_id, value, this->_info.id, sub_index));
+	    this->node_id, value, this->_info.id, sub_index)));
     }
 
     void insertMultiparmInstance(int instance_position)
     {
-	throwOnFailure(HAPI_InsertMultiparmInstance(
+	throwOnFailure(HAPI_TRACE(0, HAPI_InsertMultiparmInstance(
 		session,
-	    this->node_id, this->_info.id, instance_position));
+	    this->node_id, this->_info.id, instance_position)));
     }
 
     void removeMultiparmInstance(int instance_position)
     {
-	throwOnFailure(HAPI_RemoveMultiparmInstance(
+	throwOnFailure(HAPI_TRACE(0, HAPI_RemoveMultiparmInstance(
 		session,
-	    this->node_id, this->_info.id, instance_position));
+	    this->node_id, this->_info.id, instance_position)));
     }
 
     int node_id;
@@ -727,49 +846,67 @@ inline Parm::Parm(int node_id, const HAPI_ParmInfo &info,
 	HAPI_ParmChoiceInfo *all_choice_infos, HAPI_Session* mySession)
     : node_id(node_id), _info(info), session(mySession)
 {
+    // NULL when the parm was looked up on its own, without its choices
+    if (all_choice_infos == NULL)
+	return;
     for (int i=0; i < info.choiceCount; ++i)
 	this->choices.push_back(ParmChoice(
 	    all_choice_infos[info.choiceIndex + i], session));
 }
 
-inline std::vector<Object> Asset::objects() const
+inline const std::vector<HAPI_ObjectInfo> &Asset::objectInfos() const
 {
-    std::vector<Object> result;
+    InfoCache &cache = InfoCache::instance();
+    InfoCache::NodeKey key(session, nodeid);
+    std::map<InfoCache::NodeKey, std::vector<HAPI_ObjectInfo> >::const_iterator it =
+	cache.objectInfos.find(key);
+    if (it != cache.objectInfos.end())
+	return it->second;
+
+    // the transforms are fetched along, so the list is composed only once
+    int object_count = 0;
+    throwOnFailure(HAPI_TRACE(sizeof(int), HAPI_ComposeObjectList(
+        session, nodeid, NULL, &object_count )));
+    std::vector< HAPI_ObjectInfo > object_infos( object_count );
+    std::vector< HAPI_Transform > transforms( object_count );
+    if (object_count > 0)
+    {
+	throwOnFailure(HAPI_TRACE(object_count * sizeof(HAPI_ObjectInfo), HAPI_GetComposedObjectList(
+	    this->session,
+	    this->nodeid,
+	    &object_infos[0],
+	    0,
+	    object_count )));
+	throwOnFailure(HAPI_TRACE(object_count * sizeof(HAPI_Transform), HAPI_GetComposedObjectTransforms(
+	    this->session,
+	    this->nodeid,
+	    HAPI_RSTORDER_DEFAULT,
+	    &transforms[0],
+	    0,
+	    object_count )));
+    }
+
+    cache.objectTransforms[key].swap(transforms);
+    std::vector<HAPI_ObjectInfo> &result = cache.objectInfos[key];
+    result.swap(object_infos);
+    return result;
+}
 
-    int objectCount;
-    throwOnFailure(HAPI_ComposeObjectList(
-        session, nodeid, NULL, &objectCount ));
+inline std::vector<Object> Asset::objects() const
+{
+    const std::vector<HAPI_ObjectInfo> &infos = objectInfos();
 
-    for (int object_id=0; object_id < objectCount; ++object_id) {
-	    result.push_back(Object(*this, object_id));
-    }
-    // std::cout << "Asset: getting " << result.size() << " objects" << std::endl;
+    std::vector<Object> result;
+    result.reserve(infos.size());
+    for (int object_id=0; object_id < int(infos.size()); ++object_id)
+	result.push_back(Object(*this, object_id, infos[object_id]));
     return result;
 }
 
 inline std::vector< HAPI_Transform > Asset::transforms() const
 {
-    int object_count = 0;
-    throwOnFailure(HAPI_ComposeObjectList(
-        session, nodeid, NULL, &object_count ));
-    std::vector< HAPI_ObjectInfo > object_infos( object_count );
-    throwOnFailure(HAPI_GetComposedObjectList(
-        this->session,
-        this->nodeid,
-        object_infos.data(),
-        0,
-        object_count ));
-    std::vector< HAPI_Transform > result( object_count );
-    throwOnFailure(HAPI_GetComposedObjectTransforms(
-        this->session,
-        this->nodeid,
-        HAPI_RSTORDER_DEFAULT,
-        result.data(),
-        0,
-        object_count ));
-    // std::cout << "Object: getting " <<  object_count << " transforms" << std::endl;
-
-    return result;
+    objectInfos();
+    return InfoCache::instance().objectTransforms[InfoCache::NodeKey(session, nodeid)];
 }
 
 inline std::vector<Parm> Node::parms() const
@@ -777,17 +914,17 @@ inline std::vector<Parm> Node::parms() const
     // Get all the parm infos.
     int num_parms = nodeInfo().parmCount;
     std::vector<HAPI_ParmInfo> parm_infos(num_parms);
-    throwOnFailure(HAPI_GetParameters(
+    throwOnFailure(HAPI_TRACE(num_parms * sizeof(HAPI_ParmInfo), HAPI_GetParameters(
 	this->session,
-	this->nodeid, &parm_infos[0], /*start=*/0, num_parms));
+	this->nodeid, &parm_infos[0], /*start=*/0, num_parms)));
 
     // Get all the parm choice infos.
     std::vector<HAPI_ParmChoiceInfo> parm_choice_infos(
 	this->nodeInfo().parmChoiceCount);
-    throwOnFailure(HAPI_GetParmChoiceLists(
+    throwOnFailure(HAPI_TRACE(parm_choice_infos.size() * sizeof(HAPI_ParmChoiceInfo), HAPI_GetParmChoiceLists(
 	session,
 	this->nodeid, &parm_choice_infos[0], /*start=*/0,
-	this->nodeInfo().parmChoiceCount));
+	this->nodeInfo().parmChoiceCount)));
 
     // Build and return a vector of Parm objects.
     std::vector<Parm> result;
@@ -801,6 +938,12 @@ inline std::map<std::string, Parm> Node::parmMap() const
 {
     std::vector<Parm> parms = this->parms();
 
+    // resolve all the names in one batch, name() then finds them cached
+    std::vector<int> name_handles(parms.size());
+    for (int i=0; i < int(parms.size()); ++i)
+	name_handles[i] = parms[i].info().nameSH;
+    getStrings(session, name_handles);
+
     std::map<std::string, Parm> result;
     for (int i=0; i < int(parms.size()); ++i)
 	result.insert(std::make_pair(parms[i].name(), parms[i]));
@@ -835,7 +978,7 @@ inline Geo Object::displayGeo() const
 inline std::vector<Part> Geo::parts() const
 {
     std::vector<Part> result;
-    // std::cout << "Geo: getting parts for geo with id " << this->id << " part count is " << info().partCount << std::endl;
+    result.reserve(info().partCount);
     for (int part_id=0; part_id < info().partCount; ++part_id)
 	result.push_back(Part(*this, part_id));
     return result;
@@ -844,13 +987,13 @@ inline std::vector<Part> Geo::parts() const
 inline std::vector< HAPI_NodeId > Part::materialNodeIdsOnFaces(bool &all_same) const
 {
     std::vector< HAPI_NodeId > result( info().faceCount );
-    throwOnFailure(HAPI_GetMaterialNodeIdsOnFaces(
+    throwOnFailure(HAPI_TRACE(result.size() * sizeof(HAPI_NodeId), HAPI_GetMaterialNodeIdsOnFaces(
 		session,
 		geo.info().nodeId,
 		id,
 		&all_same /* are_all_the_same*/,
 		result.data(),
-		0, info().faceCount ));
+		0, info().faceCount )));
     return result;
 }
 
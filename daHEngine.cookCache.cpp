@@ -0,0 +1,602 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	module to display geometry from Houdini Engine in omegalib
+	this file contains the on-disk cache of cook results, keyed by the asset
+	and its parameter values
+
+******************************************************************************/
+
+#include <daHoudiniEngine/daHEngine.h>
+#include <daHoudiniEngine/houdiniGeometry.h>
+#include <daHoudiniEngine/sharedDataTools.h>
+#include <daHoudiniEngine/geometryCodec.h>
+#include <daHoudiniEngine/geometryCache.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+
+using namespace houdiniEngine;
+
+// bump when the file layout or anything feeding the key changes
+static const int COOK_CACHE_VERSION = 3;
+static const int COOK_CACHE_MAGIC = 0x4b434548; // "HECK"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// binary file streams with the interface the sharedDataTools/geometryCodec
+// helpers expect
+class CookCacheWriter
+{
+public:
+	CookCacheWriter(const String& path): myFile(path.c_str(), std::ios::binary | std::ios::trunc) {}
+
+	bool ok() { return myFile.good(); }
+
+	void write(const void* data, const size_t size) {
+		myFile.write(static_cast<const char*>(data), size);
+	}
+
+	template<typename T>
+	CookCacheWriter& operator<<(const T& value) {
+		write(&value, sizeof(T));
+		return *this;
+	}
+
+	CookCacheWriter& operator<<(const String& value) {
+		*this << int(value.size());
+		write(value.data(), value.size());
+		return *this;
+	}
+
+private:
+	std::ofstream myFile;
+};
+
+class CookCacheReader
+{
+public:
+	CookCacheReader(const String& path): myFile(path.c_str(), std::ios::binary) {}
+
+	bool ok() { return myFile.good(); }
+
+	void read(void* data, const size_t size) {
+		myFile.read(static_cast<char*>(data), size);
+	}
+
+	template<typename T>
+	CookCacheReader& operator>>(T& value) {
+		read(&value, sizeof(T));
+		return *this;
+	}
+
+	CookCacheReader& operator>>(String& value) {
+		int size = 0;
+		*this >> size;
+		if (size < 0 || !ok()) {
+			size = 0;
+		}
+		value.resize(size);
+		if (size > 0) {
+			read(&value[0], size);
+		}
+		return *this;
+	}
+
+private:
+	std::ifstream myFile;
+};
+
+// one drawable as read back from a cache file
+struct CachedPart {
+	PartArrays arrays;
+	int matId;
+	bool transparent;
+	int instanceCount; // -1 if not instanced
+	vector<osg::Matrixf> instances;
+};
+
+struct CachedObject {
+	osg::Vec3d pos;
+	osg::Quat rot;
+	osg::Vec3d scale;
+	vector< vector<CachedPart> > geodes;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// only run on master
+// cache file for the asset's current parameter values, empty if the cook
+// cache is off. The key covers the asset name, every int, float and string
+// parameter value, the current time and the settings shaping the arrays
+String HoudiniEngine::cook_cache_path(const hapi::Asset& asset)
+{
+	if (myCookCacheDir.empty()) {
+		return "";
+	}
+
+	String name = asset.name();
+
+	// fresh, the parameter counts of a long lived asset change with multiparms
+	HAPI_NodeInfo info;
+	ENSURE_SUCCESS(asset.session, HAPI_GetNodeInfo(asset.session, asset.nodeid, &info));
+
+	HashValue h = hashBytes(&COOK_CACHE_VERSION, sizeof(COOK_CACHE_VERSION));
+	h = hashBytes(name.data(), name.size(), h);
+	h = hashBytes(&info.parmCount, sizeof(info.parmCount), h);
+
+	vector<int> intValues(info.parmIntValueCount);
+	if (!intValues.empty()) {
+		ENSURE_SUCCESS_BYTES(asset.session, intValues.size() * sizeof(int), HAPI_GetParmIntValues(asset.session, asset.nodeid,
+			&intValues[0], 0, int(intValues.size())));
+	}
+	h = hashArray(&intValues, h);
+
+	vector<float> floatValues(info.parmFloatValueCount);
+	if (!floatValues.empty()) {
+		ENSURE_SUCCESS_BYTES(asset.session, floatValues.size() * sizeof(float), HAPI_GetParmFloatValues(asset.session, asset.nodeid,
+			&floatValues[0], 0, int(floatValues.size())));
+	}
+	h = hashArray(&floatValues, h);
+
+	vector<HAPI_StringHandle> stringValues(info.parmStringValueCount);
+	if (!stringValues.empty()) {
+		ENSURE_SUCCESS_BYTES(asset.session, stringValues.size() * sizeof(HAPI_StringHandle), HAPI_GetParmStringValues(asset.session, asset.nodeid, true,
+			&stringValues[0], 0, int(stringValues.size())));
+	}
+	// fetch the uncached values in one batch
+	hapi::getStrings(asset.session, stringValues);
+	for (int i = 0; i < int(stringValues.size()); ++i) {
+		String value = get_string(asset.session, stringValues[i]);
+		int size = int(value.size());
+		h = hashBytes(&size, sizeof(size), h);
+		h = hashBytes(value.data(), value.size(), h);
+	}
+
+	float time = 0;
+	HAPI_TRACE(sizeof(float), HAPI_GetTime(asset.session, &time));
+	h = hashBytes(&time, sizeof(time), h);
+	h = hashBytes(&myIndexedGeometry, sizeof(myIndexedGeometry), h);
+	h = hashBytes(&myTriangulateGeometry, sizeof(myTriangulateGeometry), h);
+	h = hashBytes(&myCurveTolerance, sizeof(myCurveTolerance), h);
+
+	// the cook options shape the result too. Field by field, the struct
+	// has padding
+	const HAPI_CookOptions& co = myCookOptions;
+	h = hashBytes(&co.splitGeosByGroup, sizeof(co.splitGeosByGroup), h);
+	h = hashBytes(&co.maxVerticesPerPrimitive, sizeof(co.maxVerticesPerPrimitive), h);
+	h = hashBytes(&co.refineCurveToLinear, sizeof(co.refineCurveToLinear), h);
+	h = hashBytes(&co.curveRefineLOD, sizeof(co.curveRefineLOD), h);
+	h = hashBytes(&co.cookTemplatedGeos, sizeof(co.cookTemplatedGeos), h);
+	h = hashBytes(&co.splitPointsByVertexAttributes, sizeof(co.splitPointsByVertexAttributes), h);
+	h = hashBytes(&co.packedPrimInstancingMode, sizeof(co.packedPrimInstancingMode), h);
+	h = hashBytes(&co.handleBoxPartTypes, sizeof(co.handleBoxPartTypes), h);
+	h = hashBytes(&co.handleSpherePartTypes, sizeof(co.handleSpherePartTypes), h);
+
+	// node names can contain path separators
+	for (int i = 0; i < int(name.size()); ++i) {
+		if (!isalnum(name[i]) && name[i] != '_' && name[i] != '-') {
+			name[i] = '_';
+		}
+	}
+
+	return ostr("%1%/%2%-%3$016x.hcook", %myCookCacheDir %name %h);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// only run on master
+// put the asset back the way a cook with the same parameters left it.
+// Returns false if there is no usable cache file
+bool HoudiniEngine::load_cooked(const String& asset_name, const String& path)
+{
+	CookCacheReader in(path);
+	if (!in.ok()) {
+		return false;
+	}
+
+	int magic = 0, version = 0, compression = COMPRESS_NONE;
+	in >> magic >> version >> compression;
+	if (!in.ok() || magic != COOK_CACHE_MAGIC || version != COOK_CACHE_VERSION) {
+		ofwarn("[HoudiniEngine::load_cooked] ignoring %1%, not a cook cache file of this version", %path);
+		return false;
+	}
+
+	// read everything before touching the scene, so a truncated file
+	// leaves the asset as it is
+	bool arraysOk = true;
+
+	int objectCount = 0;
+	in >> objectCount;
+	vector<CachedObject> objects(std::max(objectCount, 0));
+
+	for (int obj = 0; obj < objectCount && in.ok(); ++obj) {
+		CachedObject& co = objects[obj];
+		in >> co.pos[0] >> co.pos[1] >> co.pos[2];
+		in >> co.rot[0] >> co.rot[1] >> co.rot[2] >> co.rot[3];
+		in >> co.scale[0] >> co.scale[1] >> co.scale[2];
+
+		int geodeCount = 0;
+		in >> geodeCount;
+		co.geodes.resize(std::max(geodeCount, 0));
+
+		for (int g = 0; g < geodeCount && in.ok(); ++g) {
+			int drawableCount = 0;
+			in >> drawableCount;
+			co.geodes[g].resize(std::max(drawableCount, 0));
+
+			for (int d = 0; d < drawableCount && in.ok(); ++d) {
+				CachedPart& cp = co.geodes[g][d];
+
+				int count = 0;
+				in >> count;
+				arraysOk &= readPositionArrayData(in, cp.arrays.vertices.get(), count, compression);
+				in >> count;
+				if (count > 0) {
+					arraysOk &= readNormalArrayData(in, cp.arrays.getOrCreateNormals(), count, compression);
+				}
+				in >> count;
+				if (count > 0) {
+					arraysOk &= readColorArrayData(in, cp.arrays.getOrCreateColors(), count, compression);
+				}
+				in >> count;
+				if (count > 0) {
+					arraysOk &= readFloatArrayData(in, cp.arrays.getOrCreateUVs(), count, compression);
+				}
+
+				int psCount = 0;
+				in >> psCount;
+				for (int j = 0; j < psCount && in.ok(); ++j) {
+					osg::PrimitiveSet::Mode mode;
+					int startIndex, count;
+					in >> mode >> startIndex >> count;
+					if (startIndex < 0) {
+						osg::DrawElementsUInt* de = cp.arrays.addPrimitiveElements(mode);
+						arraysOk &= readFloatArrayData(in, de, count, compression);
+					} else {
+						cp.arrays.addPrimitiveOsg(mode, startIndex, count);
+					}
+				}
+
+				in >> cp.matId >> cp.transparent;
+
+				in >> cp.instanceCount;
+				if (cp.instanceCount > 0 && in.ok()) {
+					cp.instances.resize(cp.instanceCount);
+					arraysOk &= readBlob(in, &cp.instances[0], cp.instanceCount * sizeof(osg::Matrixf), sizeof(float));
+				}
+			}
+		}
+	}
+
+	Vector<MatStruct> materials;
+	int matCount = 0;
+	in >> matCount;
+	for (int i = 0; i < matCount && in.ok(); ++i) {
+		MatStruct ms;
+		in >> ms.matId >> ms.partId >> ms.geoId >> ms.objId;
+		int parmCount = 0;
+		in >> parmCount;
+		for (int k = 0; k < parmCount && in.ok(); ++k) {
+			String parm;
+			in >> parm;
+			ParmStruct& ps = ms.parms[parm];
+			int valueCount = 0;
+			in >> ps.type >> valueCount;
+			ps.intValues.resize(std::max(valueCount, 0));
+			for (int v = 0; v < valueCount; ++v) in >> ps.intValues[v];
+			in >> valueCount;
+			ps.floatValues.resize(std::max(valueCount, 0));
+			for (int v = 0; v < valueCount; ++v) in >> ps.floatValues[v];
+			in >> valueCount;
+			ps.stringValues.resize(std::max(valueCount, 0));
+			for (int v = 0; v < valueCount; ++v) in >> ps.stringValues[v];
+		}
+		materials.push_back(ms);
+	}
+
+	if (!in.ok() || !arraysOk) {
+		ofwarn("[HoudiniEngine::load_cooked] ignoring corrupt cache file %1%", %path);
+		return false;
+	}
+
+	hflog("[HoudiniEngine::load_cooked] %1% from %2%", %asset_name %path);
+
+	HoudiniGeometry* hg;
+	if (myHoudiniGeometrys.count(asset_name) > 0) {
+		hg = myHoudiniGeometrys[asset_name];
+	} else {
+		hg = HoudiniGeometry::create(asset_name);
+		myHoudiniGeometrys[asset_name] = hg;
+	}
+
+	if (hg->getObjectCount() < objectCount) {
+		hg->addObject(objectCount - hg->getObjectCount());
+	}
+
+	for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
+		if (obj >= objectCount) {
+			hg->clearObj(obj);
+			continue;
+		}
+
+		CachedObject& co = objects[obj];
+		osg::PositionAttitudeTransform* pat = hg->getOsgNode()->asGroup()->getChild(obj)->asTransform()->
+			asPositionAttitudeTransform();
+		pat->setPosition(co.pos);
+		pat->setAttitude(co.rot);
+		pat->setScale(co.scale);
+
+		int geodeCount = int(co.geodes.size());
+		if (hg->getGeodeCount(obj) < geodeCount) {
+			hg->addGeode(geodeCount - hg->getGeodeCount(obj), obj);
+		}
+
+		for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
+			if (g >= geodeCount) {
+				hg->clearGeode(g, obj);
+				continue;
+			}
+
+			int drawableCount = int(co.geodes[g].size());
+			if (hg->getDrawableCount(g, obj) < drawableCount) {
+				hg->addDrawable(drawableCount - hg->getDrawableCount(g, obj), g, obj);
+			}
+
+			for (int d = 0; d < hg->getDrawableCount(g, obj); ++d) {
+				if (d >= drawableCount) {
+					hg->clearDrawable(d, g, obj);
+					continue;
+				}
+
+				CachedPart& cp = co.geodes[g][d];
+				hg->setPartArrays(cp.arrays, d, g, obj);
+				hg->setMatId(cp.matId, d, g, obj);
+				hg->setTransparent(cp.transparent, d, g, obj);
+				if (cp.instanceCount >= 0) {
+					hg->setInstances(cp.instances, d, g, obj);
+				} else {
+					hg->clearInstances(d, g, obj);
+				}
+
+				apply_material_state(hg, d, g, obj);
+			}
+		}
+	}
+
+	// rehash everything, cleared parts included, like process_asset
+	for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
+		for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
+			for (int d = 0; d < hg->getDrawableCount(g, obj); ++d) {
+				hg->updateHash(d, g, obj);
+			}
+		}
+	}
+
+	hg->objectsChanged = true;
+	hg->hapiSynced = false;
+
+	assetMaterialParms[asset_name] = materials;
+	apply_material_parms(asset_name);
+
+	if (mySceneManager->getModel(asset_name) == NULL) {
+		mySceneManager->addModel(hg);
+	}
+
+	myCookCacheHits++;
+	updateGeos = true;
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// only run on master
+// write the asset's processed geometry and material parms to path. Written
+// to a temporary file first, so readers never see half a cache file
+void HoudiniEngine::store_cooked(const String& asset_name, const String& path)
+{
+	if (myHoudiniGeometrys.count(asset_name) == 0) {
+		return;
+	}
+
+	typedef Dictionary <String, ParmStruct > PS;
+
+	// textures live in the scene manager, not in the cache, so a cached
+	// cook of a textured asset would come back without them
+	Vector<MatStruct>& materials = assetMaterialParms[asset_name];
+	for (int i = 0; i < materials.size(); ++i) {
+		if (materials[i].parms.count("diffuseMapName") || materials[i].parms.count("normalMapName")) {
+			hflog("[HoudiniEngine::store_cooked] not caching %1%, it has texture maps", %asset_name);
+			return;
+		}
+	}
+
+	String tmpPath = path + ".tmp";
+	{
+		CookCacheWriter out(tmpPath);
+		if (!out.ok()) {
+			ofwarn("[HoudiniEngine::store_cooked] unable to write %1%", %tmpPath);
+			return;
+		}
+
+		// lossless, the cache has to give back exactly what the cook made
+		const int compression = COMPRESS_LZ;
+		out << COOK_CACHE_MAGIC << COOK_CACHE_VERSION << compression;
+
+		HoudiniGeometry* hg = myHoudiniGeometrys[asset_name];
+		out << hg->getObjectCount();
+
+		for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
+			osg::PositionAttitudeTransform* pat = hg->getOsgNode()->asGroup()->getChild(obj)->asTransform()->
+				asPositionAttitudeTransform();
+			osg::Vec3d pos = pat->getPosition();
+			osg::Quat rot = pat->getAttitude();
+			osg::Vec3d scale = pat->getScale();
+			out << pos[0] << pos[1] << pos[2];
+			out << rot[0] << rot[1] << rot[2] << rot[3];
+			out << scale[0] << scale[1] << scale[2];
+
+			out << hg->getGeodeCount(obj);
+			for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
+				out << hg->getDrawableCount(g, obj);
+				for (int d = 0; d < hg->getDrawableCount(g, obj); ++d) {
+					writePositionArray(out, hg->getVertexArray(d, g, obj), compression);
+					writeNormalArray(out, hg->getNormalArray(d, g, obj), compression);
+					writeColorArray(out, hg->getColorArray(d, g, obj), compression);
+					writeFloatArray(out, hg->getUVArray(d, g, obj), compression);
+
+					osg::Geometry* geo = hg->getGeometry(d, g, obj);
+
+					// the same sets commitSharedData sends
+					osg::Geometry::PrimitiveSetList psl;
+					for (int i = 0; i < geo->getNumPrimitiveSets(); ++i) {
+						osg::PrimitiveSet* ps = geo->getPrimitiveSet(i);
+						if (dynamic_cast<osg::DrawElementsUInt*>(ps) == NULL &&
+							dynamic_cast<osg::DrawArrays*>(ps) == NULL) {
+							ofwarn("[HoudiniEngine::store_cooked] O%1%G%2% D%3%: skipping unsupported primitive set %4%",
+								%obj %g %d %ps->className());
+							continue;
+						}
+						psl.push_back(ps);
+					}
+					out << int(psl.size());
+					for (int i = 0; i < psl.size(); ++i) {
+						osg::DrawElementsUInt* de = dynamic_cast<osg::DrawElementsUInt*>(psl[i].get());
+						if (de != NULL) {
+							out << de->getMode() << int(-1);
+							writeFloatArray(out, de, compression);
+							continue;
+						}
+						osg::DrawArrays* da = dynamic_cast<osg::DrawArrays*>(psl[i].get());
+						out << da->getMode() << int(da->getFirst()) << int(da->getCount());
+					}
+
+					out << hg->getMatId(d, g, obj) << hg->isTransparent(d, g, obj);
+
+					int instanceCount = hg->isInstanced(d, g, obj) ? int(hg->getInstances(d, g, obj).size()) : -1;
+					out << instanceCount;
+					if (instanceCount > 0) {
+						writeBlob(out, &hg->getInstances(d, g, obj)[0],
+							instanceCount * sizeof(osg::Matrixf), sizeof(float), compression);
+					}
+				}
+			}
+		}
+
+		out << int(materials.size());
+		for (int i = 0; i < materials.size(); ++i) {
+			MatStruct& ms = materials[i];
+			out << ms.matId << ms.partId << ms.geoId << ms.objId;
+			out << int(ms.parms.size());
+			foreach(PS::Item mp, ms.parms) {
+				out << mp.first << mp.second.type;
+				out << int(mp.second.intValues.size());
+				for (int v = 0; v < mp.second.intValues.size(); ++v) out << mp.second.intValues[v];
+				out << int(mp.second.floatValues.size());
+				for (int v = 0; v < mp.second.floatValues.size(); ++v) out << mp.second.floatValues[v];
+				out << int(mp.second.stringValues.size());
+				for (int v = 0; v < mp.second.stringValues.size(); ++v) out << mp.second.stringValues[v];
+			}
+		}
+
+		if (!out.ok()) {
+			ofwarn("[HoudiniEngine::store_cooked] failed writing %1%", %tmpPath);
+			remove(tmpPath.c_str());
+			return;
+		}
+	}
+
+	if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+		ofwarn("[HoudiniEngine::store_cooked] unable to move %1% into place", %tmpPath);
+		remove(tmpPath.c_str());
+		return;
+	}
+
+	hflog("[HoudiniEngine::store_cooked] %1% to %2%", %asset_name %path);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// geometry cache files, see geometryCache.h
+bool HoudiniEngine::saveGeometryCache(const String& asset_name, const String& path)
+{
+	if (myHoudiniGeometrys.count(asset_name) == 0) {
+		ofwarn("[HoudiniEngine::saveGeometryCache] No asset of name %1%", %asset_name);
+		return false;
+	}
+
+	return houdiniEngine::saveGeometryCache(myHoudiniGeometrys[asset_name], path);
+}
+
+// runs on master and slaves alike, no session needed. Every node is expected
+// to load the same file, so the master doesn't send the loaded parts on
+bool HoudiniEngine::loadGeometryCache(const String& asset_name, const String& path)
+{
+	HoudiniGeometry* hg;
+	if (myHoudiniGeometrys.count(asset_name) > 0) {
+		hg = myHoudiniGeometrys[asset_name];
+	} else {
+		hg = HoudiniGeometry::create(asset_name);
+		myHoudiniGeometrys[asset_name] = hg;
+	}
+
+	if (!houdiniEngine::loadGeometryCache(hg, path)) {
+		ofwarn("[HoudiniEngine::loadGeometryCache] unable to load %1% from %2%", %asset_name %path);
+		return false;
+	}
+
+	for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
+		for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
+			for (int d = 0; d < hg->getDrawableCount(g, obj); ++d) {
+				apply_material_state(hg, d, g, obj);
+
+				if (SystemManager::instance()->isMaster()) {
+					hg->setDrawableSent(d, g, obj);
+				}
+			}
+		}
+
+		if (SystemManager::instance()->isMaster()) {
+			hg->setTransformSent(obj);
+		}
+	}
+
+	if (mySceneManager->getModel(asset_name) == NULL) {
+		mySceneManager->addModel(hg);
+	}
+
+	hflog("[HoudiniEngine::loadGeometryCache] %1% from %2%", %asset_name %path);
+
+	return true;
+}
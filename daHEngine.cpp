@@ -43,11 +43,16 @@ daHEngine
 #include <daHoudiniEngine/houdiniAsset.h>
 #include <daHoudiniEngine/houdiniGeometry.h>
 #include <daHoudiniEngine/houdiniParameter.h>
+#include <daHoudiniEngine/geometryCodec.h>
 #if DA_ENABLE_HENGINE > 0
 	#include <daHEngine.static.cpp>
 #endif
 #include <daHoudiniEngine/loaderTools.h>
 
+#include <OpenThreads/Thread>
+
+#include <algorithm>
+
 
 using namespace houdiniEngine;
 
@@ -97,8 +102,55 @@ BOOST_PYTHON_MODULE(daHEngine)
  		PYAPI_METHOD(HoudiniEngine, getTime)
  		PYAPI_METHOD(HoudiniEngine, setTime)
  		PYAPI_METHOD(HoudiniEngine, cook)
+ 		PYAPI_METHOD(HoudiniEngine, isAsyncCooking)
+ 		PYAPI_METHOD(HoudiniEngine, setAsyncCooking)
+ 		PYAPI_METHOD(HoudiniEngine, isCooking)
+ 		PYAPI_METHOD(HoudiniEngine, onCookDone)
+ 		PYAPI_METHOD(HoudiniEngine, getSessionCount)
+ 		PYAPI_METHOD(HoudiniEngine, getAssetSession)
+ 		PYAPI_METHOD(HoudiniEngine, getCookInterval)
+ 		PYAPI_METHOD(HoudiniEngine, setCookInterval)
+ 		PYAPI_METHOD(HoudiniEngine, getCooksRequested)
+ 		PYAPI_METHOD(HoudiniEngine, getCooksPerformed)
+ 		PYAPI_METHOD(HoudiniEngine, resetCookCounters)
+ 		PYAPI_METHOD(HoudiniEngine, getCookCacheDir)
+ 		PYAPI_METHOD(HoudiniEngine, setCookCacheDir)
+ 		PYAPI_METHOD(HoudiniEngine, getCookCacheHits)
+ 		PYAPI_METHOD(HoudiniEngine, getTexturesExtracted)
+ 		PYAPI_METHOD(HoudiniEngine, getTextureCacheHits)
+ 		PYAPI_METHOD(HoudiniEngine, getMaterialsRead)
+ 		PYAPI_METHOD(HoudiniEngine, getMaterialCacheHits)
+ 		PYAPI_METHOD(HoudiniEngine, getTextureFrameBudget)
+ 		PYAPI_METHOD(HoudiniEngine, setTextureFrameBudget)
+ 		PYAPI_METHOD(HoudiniEngine, getTexturesPending)
+ 		PYAPI_METHOD(HoudiniEngine, getMaterialStateSets)
+ 		PYAPI_METHOD(HoudiniEngine, getMaterialStateDrawables)
+ 		PYAPI_METHOD(HoudiniEngine, saveGeometryCache)
+ 		PYAPI_METHOD(HoudiniEngine, loadGeometryCache)
  		PYAPI_METHOD(HoudiniEngine, getCookOptions)
  		PYAPI_METHOD(HoudiniEngine, setCookOptions)
+ 		PYAPI_METHOD(HoudiniEngine, getGeometryCompression)
+ 		PYAPI_METHOD(HoudiniEngine, setGeometryCompression)
+ 		PYAPI_METHOD(HoudiniEngine, isIndexedGeometry)
+ 		PYAPI_METHOD(HoudiniEngine, setIndexedGeometry)
+ 		PYAPI_METHOD(HoudiniEngine, isTriangulateGeometry)
+ 		PYAPI_METHOD(HoudiniEngine, setTriangulateGeometry)
+ 		PYAPI_METHOD(HoudiniEngine, getCurveTolerance)
+ 		PYAPI_METHOD(HoudiniEngine, setCurveTolerance)
+ 		PYAPI_METHOD(HoudiniEngine, getConversionThreads)
+ 		PYAPI_METHOD(HoudiniEngine, setConversionThreads)
+ 		PYAPI_METHOD(HoudiniEngine, isIncrementalUpdates)
+ 		PYAPI_METHOD(HoudiniEngine, setIncrementalUpdates)
+ 		PYAPI_METHOD(HoudiniEngine, isTopologyFastPath)
+ 		PYAPI_METHOD(HoudiniEngine, setTopologyFastPath)
+ 		PYAPI_METHOD(HoudiniEngine, isTrustPartTopology)
+ 		PYAPI_METHOD(HoudiniEngine, setTrustPartTopology)
+ 		PYAPI_METHOD(HoudiniEngine, isHapiTracing)
+ 		PYAPI_METHOD(HoudiniEngine, setHapiTracing)
+ 		PYAPI_METHOD(HoudiniEngine, clearHapiTrace)
+ 		PYAPI_METHOD(HoudiniEngine, getHapiTraceCallCount)
+ 		PYAPI_METHOD(HoudiniEngine, writeHapiTrace)
+ 		PYAPI_METHOD(HoudiniEngine, getHapiTraceSummary)
  		PYAPI_METHOD(HoudiniEngine, isLoggingEnabled)
  		PYAPI_METHOD(HoudiniEngine, setLoggingEnabled)
  		PYAPI_METHOD(HoudiniEngine, showMappings)
@@ -199,6 +251,23 @@ BOOST_PYTHON_MODULE(daHEngine)
 		.value("Max", HAPI_PARMTYPE_MAX)
 	;
 
+	// flags for setGeometryCompression, combine with |
+	enum_<GeometryCompression>("GeometryCompression")
+		.value("Off", COMPRESS_NONE)
+		.value("LZ", COMPRESS_LZ)
+		.value("Positions", COMPRESS_POSITIONS)
+		.value("Normals", COMPRESS_NORMALS)
+		.value("Colors", COMPRESS_COLORS)
+		.value("All", COMPRESS_ALL)
+	;
+
+	// HAPI_PackedPrimInstancingMode, for CookOptions.packedPrimInstancingMode
+	enum_<HAPI_PackedPrimInstancingMode>("PackedPrimInstancingMode")
+		.value("Disabled", HAPI_PACKEDPRIM_INSTANCING_MODE_DISABLED)
+		.value("Hierarchy", HAPI_PACKEDPRIM_INSTANCING_MODE_HIERARCHY)
+		.value("Flat", HAPI_PACKEDPRIM_INSTANCING_MODE_FLAT)
+	;
+
 	// HAPI_CookOptions
 	class_<HAPI_CookOptions>("CookOptions")
 	    .def_readwrite("splitGeosByGroup", &HAPI_CookOptions::splitGeosByGroup)
@@ -208,7 +277,7 @@ BOOST_PYTHON_MODULE(daHEngine)
 		.def_readwrite("clearErrorsAndWarnings", &HAPI_CookOptions::clearErrorsAndWarnings)
 		.def_readwrite("cookTemplatedGeos", &HAPI_CookOptions::cookTemplatedGeos)
 		.def_readwrite("splitPointsByVertexAttributes", &HAPI_CookOptions::splitPointsByVertexAttributes)
-		// PYAPI_REF_PROPERTY(HAPI_CookOptions, packedPrimInstancingMode)
+		.def_readwrite("packedPrimInstancingMode", &HAPI_CookOptions::packedPrimInstancingMode)
 		.def_readwrite("handleBoxPartTypes", &HAPI_CookOptions::handleBoxPartTypes)
 		.def_readwrite("handleSpherePartTypes", &HAPI_CookOptions::handleSpherePartTypes)
 	;
@@ -235,6 +304,14 @@ HoudiniEngine* HoudiniEngine::createAndInitialize()
 	int houdiniVersionMajor = 0;
 	int hEngineVersionMajor = 0;
 
+#ifdef DA_HAPI_STANDIN
+	// record or replay HAPI from here on, the master is the only node
+	// talking to Houdini Engine
+	if (SystemManager::instance()->isMaster()) {
+		hapi::StandIn::startFromEnvironment();
+	}
+#endif
+
 	ENSURE_SUCCESS(NULL, HAPI_GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_MAJOR, &houdiniVersionMajor ));
 	ENSURE_SUCCESS(NULL, HAPI_GetEnvInt(HAPI_ENVINT_VERSION_HOUDINI_ENGINE_MAJOR, &hEngineVersionMajor ));
 
@@ -263,10 +340,32 @@ HoudiniEngine::HoudiniEngine():
 
 	EngineModule("HoudiniEngine"),
 	mySceneManager(NULL),
-	myAssetCount(0)
+	myAssetCount(0),
+	myGeometryCompression(COMPRESS_NONE),
+	myIndexedGeometry(false),
+	myTriangulateGeometry(false),
+	myCurveTolerance(0.01f),
+	myConversionThreads(OpenThreads::GetNumberOfProcessors()),
+	myIncrementalUpdates(true),
+	myTopologyFastPath(true),
+	myTrustPartTopology(false),
+	myAsyncCooking(false),
+	myCookInterval(-1),
+	myLastCookFlush(0),
+	myCooksRequested(0),
+	myCooksPerformed(0),
+	myCookCacheHits(0),
+	myTexturesExtracted(0),
+	myTextureCacheHits(0),
+	myMaterialsRead(0),
+	myMaterialCacheHits(0),
+	myTextureFrameBudget(1 << 20)
 {
 	// defaults
 	myCookOptions.cookTemplatedGeos = true; //default false;
+	// packed primitives come as instancer parts, drawn as instances of
+	// the parts they pack instead of unpacked copies
+	myCookOptions.packedPrimInstancingMode = HAPI_PACKEDPRIM_INSTANCING_MODE_FLAT;
 }
 #else
 	EngineModule("HoudiniEngine")
@@ -280,19 +379,19 @@ HoudiniEngine::~HoudiniEngine()
 
 	if (SystemManager::instance()->isMaster())
 	{
-	    try
-	    {
-		    ENSURE_SUCCESS(session, HAPI_Cleanup(session));
-			olog(Verbose, "[~HoudiniEngine] cleanup HAPI");
-			if (session != NULL) {
-				delete session;
+		// a session that fails to clean up doesn't stop the others
+		foreach(HAPI_Session* s, mySessions) {
+			if (HAPI_TRACE(0, HAPI_Cleanup(s)) != HAPI_RESULT_SUCCESS) {
+				ofwarn("[~HoudiniEngine] Houdini Failure on cleanup %1%", %hapi::Failure::lastErrorMessage(s));
 			}
-	    }
-	    catch (hapi::Failure &failure)
-	    {
-			ofwarn("[~HoudiniEngine] Houdini Failure on cleanup %1%", %failure.lastErrorMessage(session));
-			throw;
-	    }
+			delete s;
+		}
+		olog(Verbose, "[~HoudiniEngine] cleanup HAPI");
+		mySessions.clear();
+		session = NULL;
+#ifdef DA_HAPI_STANDIN
+		hapi::StandIn::stop();
+#endif
 	}
 
 	mySceneManager = NULL;
@@ -323,7 +422,7 @@ boost::python::list HoudiniEngine::getAvailableAssets(int library_id) {
 	boost::python::list myAssetNames;
 
 	HAPI_StringHandle* asset_name_sh = new HAPI_StringHandle[assetCount];
-	ENSURE_SUCCESS(session,  HAPI_GetAvailableAssets( session, library_id, asset_name_sh, assetCount ) );
+	ENSURE_SUCCESS_BYTES(session, assetCount * sizeof(HAPI_StringHandle), HAPI_GetAvailableAssets( session, library_id, asset_name_sh, assetCount ) );
 
 	for (int i =0; i < assetCount; ++i) {
 		// std::string asset_name = get_string( session, asset_name_sh[i] );
@@ -344,11 +443,11 @@ int HoudiniEngine::loadAssetLibraryFromFile(const String& otlFile)
 		return -1;
 	}
 
-    HAPI_Result hr = HAPI_LoadAssetLibraryFromFile(
+    HAPI_Result hr = HAPI_TRACE(0, HAPI_LoadAssetLibraryFromFile(
 			session,
             otlFile.c_str(),
 			false, /* allow_overwrite */
-            &library_id);
+            &library_id));
     if (hr != HAPI_RESULT_SUCCESS)
     {
         ofwarn("[HoudiniEngine::loadAssetLibraryFromFile] Could not load %1%", %otlFile);
@@ -358,9 +457,16 @@ int HoudiniEngine::loadAssetLibraryFromFile(const String& otlFile)
 
     ENSURE_SUCCESS(session,  HAPI_GetAvailableAssetCount( session, library_id, &assetCount ) );
 
+	// any session of the pool can be picked for an asset, they all need it
+	for (int i = 1; i < mySessions.size(); ++i) {
+		HAPI_AssetLibraryId pool_library_id;
+		ENSURE_SUCCESS(mySessions[i], HAPI_LoadAssetLibraryFromFile(
+			mySessions[i], otlFile.c_str(), false, &pool_library_id));
+	}
+
 	hflog("[HoudiniEngine::loadAssetLibraryFromFile] %1% assets available", %assetCount);
     HAPI_StringHandle* asset_name_sh = new HAPI_StringHandle[assetCount];
-    ENSURE_SUCCESS(session,  HAPI_GetAvailableAssets( session, library_id, asset_name_sh, assetCount ) );
+    ENSURE_SUCCESS_BYTES(session, assetCount * sizeof(HAPI_StringHandle), HAPI_GetAvailableAssets( session, library_id, asset_name_sh, assetCount ) );
 
 	for (int i =0; i < assetCount; ++i) {
 	    std::string asset_name = get_string( session, asset_name_sh[i] );
@@ -389,15 +495,16 @@ int HoudiniEngine::instantiateAsset(const String& asset_name)
 	}
 
 	int asset_id = -1;
+	HAPI_Session* assetSession = pick_session();
 
 	try {
 
-    ENSURE_SUCCESS(session, HAPI_CreateNode(
-			session,
+    ENSURE_SUCCESS(assetSession, HAPI_CreateNode(
+			assetSession,
 			/*parent_node_id=*/-1,
             asset_name.c_str(),
 			/*node_label (optional)=*/NULL,
-            /* cook_on_creation */ true,
+            /* cook_on_creation */ myCookCacheDir.empty(),
             &asset_id ));
 
 	if (asset_id < 0) {
@@ -405,23 +512,28 @@ int HoudiniEngine::instantiateAsset(const String& asset_name)
 		return -1;
 	}
 
- 	hflog("[HoudiniEngine::instantiateAsset] name: %1%, id: %2%", %asset_name %asset_id);
+	wait_for_cook(assetSession);
 
-	wait_for_cook();
+	Ref <RefAsset> myAsset = new RefAsset(asset_id, assetSession);
+	asset_id = pool_asset_id(*myAsset);
+	// a node id can be handed out again, don't trust an old index
+	myParmIndex.erase(asset_id);
+
+ 	hflog("[HoudiniEngine::instantiateAsset] name: %1%, id: %2%, session: %3%",
+		%asset_name %asset_id %session_index(assetSession));
 
 	assetNameToIds[asset_name] = asset_id;
 
-	Ref <RefAsset> myAsset = new RefAsset(asset_id, session);
 	// TODO: this isn't the right way to do this.. remove
 	instancedHEAssets[asset_id] = myAsset;
-    process_asset(*myAsset.get());
+	process_instance(myAsset.get());
 
 	createMenu(asset_id);
 	updateGeos = true;
 
 	} catch (hapi::Failure &failure)
 	{
-		ofwarn("[HoudiniEngine::instantiateAsset] %1%", %failure.lastErrorMessage(session));
+		ofwarn("[HoudiniEngine::instantiateAsset] %1%", %failure.lastErrorMessage(assetSession));
 		throw;
 	}
 
@@ -441,18 +553,20 @@ int HoudiniEngine::instantiateAssetById(int asset_id)
 
 	hflog("[HoudiniEngine::instantiateAssetById] %1% assets available", %assetCount);
     HAPI_StringHandle* asset_name_sh = new HAPI_StringHandle[assetCount];
-    ENSURE_SUCCESS(session,  HAPI_GetAvailableAssets( session, library_id, asset_name_sh, assetCount ) );
+    ENSURE_SUCCESS_BYTES(session, assetCount * sizeof(HAPI_StringHandle), HAPI_GetAvailableAssets( session, library_id, asset_name_sh, assetCount ) );
 
 	std::string asset_name;
 
 	asset_name = get_string( session, asset_name_sh[asset_id]);
 
-    ENSURE_SUCCESS(session, HAPI_CreateNode(
-			session,
+	HAPI_Session* assetSession = pick_session();
+
+    ENSURE_SUCCESS(assetSession, HAPI_CreateNode(
+			assetSession,
 			/*parent_node_id=*/-1,
             asset_name.c_str(),
 			/*node_label (optional)=*/NULL,
-            /* cook_on_creation */ true,
+            /* cook_on_creation */ myCookCacheDir.empty(),
             &asset_id ));
 
 	if (asset_id < 0) {
@@ -462,17 +576,22 @@ int HoudiniEngine::instantiateAssetById(int asset_id)
 		return -1;
 	}
 
- 	hflog("[HoudiniEngine::instantiateAssetById] name %1%, id: %2%", %asset_name %asset_id);
+	wait_for_cook(assetSession);
 
-	wait_for_cook();
+	Ref <RefAsset> myAsset = new RefAsset(asset_id, assetSession);
+	asset_id = pool_asset_id(*myAsset);
+	// drop any parm index left from a node that had this id
+	myParmIndex.erase(asset_id);
+
+ 	hflog("[HoudiniEngine::instantiateAssetById] name %1%, id: %2%, session: %3%",
+		%asset_name %asset_id %session_index(assetSession));
 
-	Ref <RefAsset> myAsset = new RefAsset(asset_id, session);
 	// TODO: this isn't the right way to do this
 	instancedHEAssets[asset_id] = myAsset;
 
 	assetNameToIds[asset_name] = asset_id;
 
-    process_asset(*myAsset.get());
+	process_instance(myAsset.get());
 
 	createMenu(asset_id);
 	updateGeos = true;
@@ -481,6 +600,29 @@ int HoudiniEngine::instantiateAssetById(int asset_id)
 	return asset_id;
 }
 
+// process a newly created asset node. With the cook cache on the node was
+// created without cooking, and is only cooked if its default parameter
+// values aren't in the cache
+void HoudiniEngine::process_instance(hapi::Asset* asset)
+{
+	String cachePath = cook_cache_path(*asset);
+	if (!cachePath.empty() && load_cooked(asset->name(), cachePath)) {
+		return;
+	}
+
+	if (!cachePath.empty()) {
+		myCooksPerformed++;
+		asset->cook(&myCookOptions);
+		wait_for_cook(asset->session);
+	}
+
+	process_asset(*asset);
+
+	if (!cachePath.empty()) {
+		store_cooked(asset->name(), cachePath);
+	}
+}
+
 // Geometry is instantiated like this:
 //    asset node+ (HoudiniAsset)
 //     |
@@ -604,6 +746,41 @@ HoudiniAsset* HoudiniEngine::instantiateGeometry(const String& asset)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// a session to the engine server at host:port, starting a local server
+// when no host is given
+HAPI_Session* HoudiniEngine::create_session(const char* host, const int port)
+{
+	HAPI_Session* s = new HAPI_Session();
+
+	if (!host) {
+		HAPI_ThriftServerOptions thrift_server_options;
+		thrift_server_options.autoClose = true;
+		thrift_server_options.timeoutMs = 5000;
+
+		HAPI_StartThriftSocketServer( &thrift_server_options, port, /*&process_id*/ NULL );
+		host = "localhost";
+		oflog(Debug, "[HoudiniEngine::create_session] Created Thrift Socket Server on %1%:%2%", %host %port);
+	}
+
+	HAPI_CreateThriftSocketSession(s, host, port);
+	oflog(Debug, "[HoudiniEngine::create_session] Created Thrift Socket Session to %1%:%2%", %host %port);
+
+	ENSURE_SUCCESS(s, HAPI_Initialize(
+		s,
+		&myCookOptions,
+		/*use_cooking_thread=*/true,
+		/*cooking_thread_stack_size=*/-1,
+		/*houdini_environment_files=*/NULL,
+		/*otl search path*/ getenv("$HOME"),
+		/*dso_search_path=*/ NULL,
+		/*image_dso_search_path=*/ NULL,
+		/*audio_dso_search_path=*/ NULL
+	));
+
+	return s;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void HoudiniEngine::initialize()
 {
@@ -613,44 +790,21 @@ void HoudiniEngine::initialize()
 	if (SystemManager::instance()->isMaster()) {
 	    try
 	    {
-			// create sessions
-			session = new HAPI_Session();
-
+			// create sessions, one unless a pool is asked for
 			const char* env_host = std::getenv("DA_HOUDINI_ENGINE_HOST");
 			const char* env_port = std::getenv("DA_HOUDINI_ENGINE_PORT");
+			const char* env_sessions = std::getenv("DA_HOUDINI_ENGINE_SESSIONS");
 
-			if (session != NULL) {
-
-				HAPI_ThriftServerOptions thrift_server_options;
-				thrift_server_options.autoClose = true;
-				thrift_server_options.timeoutMs = 5000;
-
-				int port = env_port ? atoi(env_port) : 7788;
+			int port = env_port ? atoi(env_port) : 7788;
+			int sessionCount = env_sessions ? std::max(1, atoi(env_sessions)) : 1;
 
-				if (!env_host) {
-					HAPI_StartThriftSocketServer( &thrift_server_options, port, /*&process_id*/ NULL );
-					env_host = "localhost";
-					oflog(Debug, "[HoudiniEngine::initialize] Created Thrift Socket Server on %1%:%2%", %env_host %port);
-				}
-
-				HAPI_CreateThriftSocketSession(session, env_host, port);
-				oflog(Debug, "[HoudiniEngine::initialize] Created Thrift Socket Session to %1%:%2%", %env_host %port);
-			} else {
-				owarn("[HoudiniEngine::initialize] No session defined..");
+			for (int i = 0; i < sessionCount; ++i) {
+				mySessions.push_back(create_session(env_host, port + i));
 			}
+			session = mySessions[0];
+			myRunningCooks.resize(mySessions.size());
 
-
-			ENSURE_SUCCESS(session, HAPI_Initialize(
-				session,
-				&myCookOptions,
-				/*use_cooking_thread=*/true,
-				/*cooking_thread_stack_size=*/-1,
-				/*houdini_environment_files=*/NULL,
-				/*otl search path*/ getenv("$HOME"),
-				/*dso_search_path=*/ NULL,
-				/*image_dso_search_path=*/ NULL,
-				/*audio_dso_search_path=*/ NULL
-			));
+			ofmsg("[HoudiniEngine] %1% Houdini Engine session(s)", %mySessions.size());
 			omsg("[HoudiniEngine] Houdini Engine Initialized.");
 	    }
 	    catch (hapi::Failure &failure)
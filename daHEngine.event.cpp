@@ -72,6 +72,10 @@ void HoudiniEngine::removeConts(Container* cont) {
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 void HoudiniEngine::update(const UpdateContext& context)
 {
+	if (SystemManager::instance()->isMaster()) {
+		flush_cooks(context.time);
+		update_cooks();
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -52,7 +52,7 @@ using namespace houdiniEngine;
 void HoudiniEngine::createMenu(const int asset_id)
 {
     // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+	hapi::Asset* myAsset = new hapi::Asset(pool_asset(asset_id));
 	std::string asset_name = myAsset->name();
 
 	if (myAsset == NULL) {
@@ -96,7 +96,7 @@ void HoudiniEngine::createParms(const int asset_id, Container* assetCont)
 	const char* daFolderName = "daFolder_0";
 
     // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+	hapi::Asset* myAsset = new hapi::Asset(pool_asset(asset_id));
 	std::map<std::string, hapi::Parm> parmMap = myAsset->parmMap();
 	std::vector<hapi::Parm> parms = myAsset->parms();
 
@@ -193,7 +193,7 @@ boost::python::dict HoudiniEngine::getParameters(const String& asset_name)
 	int asset_id = assetNameToIds[asset_name];
 
 
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+	hapi::Asset* myAsset = new hapi::Asset(pool_asset(asset_id));
 
     if (myAsset == NULL) {
         ofwarn("[HoudiniEngine::getParameters] No asset of name %1%", %asset_name);
@@ -264,6 +264,238 @@ boost::python::dict HoudiniEngine::getParameters(const String& asset_name)
     return d;
 }
 
+// HAPI's int and float value setters under one name, for write_parm_values
+static void set_parm_values(HAPI_Session* s, int node_id, int* values, int start, int length)
+{
+	hapi::throwOnFailure(HAPI_TRACE(length * sizeof(int), HAPI_SetParmIntValues(
+		s, node_id, values, start, length)));
+}
+
+static void set_parm_values(HAPI_Session* s, int node_id, float* values, int start, int length)
+{
+	hapi::throwOnFailure(HAPI_TRACE(length * sizeof(float), HAPI_SetParmFloatValues(
+		s, node_id, values, start, length)));
+}
+
+// one call per run of consecutive indices, so a vector parm or parms that sit
+// next to each other in the value array go in a single call
+template <typename T>
+static void write_parm_values(HAPI_Session* s, int node_id, const std::map<int, T>& values)
+{
+	typedef typename std::map<int, T>::const_iterator ValueIt;
+
+	std::vector<T> run;
+	int start = 0;
+	for (ValueIt it = values.begin(); it != values.end(); ++it) {
+		if (!run.empty() && it->first != start + int(run.size())) {
+			set_parm_values(s, node_id, &run[0], start, int(run.size()));
+			run.clear();
+		}
+		if (run.empty()) {
+			start = it->first;
+		}
+		run.push_back(it->second);
+	}
+	if (!run.empty()) {
+		set_parm_values(s, node_id, &run[0], start, int(run.size()));
+	}
+}
+
+static bool check_parm_size(const boost::python::list& values, const int size)
+{
+	if (boost::python::len(values) != size) {
+		ofwarn("[HoudiniEngine::setParameterValue] incorrect number of args, got %1%, expected %2%",
+			%boost::python::len(values)
+			%size
+		);
+		return false;
+	}
+	return true;
+}
+
+// the asset's parms, built on first use with all names and choice labels
+// resolved in one string batch
+HoudiniEngine::ParmIndex& HoudiniEngine::parm_index(const int asset_id)
+{
+	Dictionary<int, ParmIndex>::iterator found = myParmIndex.find(asset_id);
+	if (found != myParmIndex.end()) {
+		return found->second;
+	}
+
+	hapi::Asset asset = pool_asset(asset_id);
+
+	ParmIndex index;
+	index.parms = asset.parms();
+
+	std::vector<int> handles;
+	for (size_t i = 0; i < index.parms.size(); ++i) {
+		const hapi::Parm& parm = index.parms[i];
+		handles.push_back(parm.info().nameSH);
+		for (size_t j = 0; j < parm.choices.size(); ++j) {
+			handles.push_back(parm.choices[j].info().labelSH);
+		}
+	}
+	std::vector<std::string> strings = hapi::getStrings(asset.session, handles);
+
+	size_t s = 0;
+	index.choices.resize(index.parms.size());
+	for (size_t i = 0; i < index.parms.size(); ++i) {
+		// the first of a name wins, as the old linear search did
+		if (index.byName.count(strings[s]) == 0) {
+			index.byName[strings[s]] = int(i);
+		}
+		++s;
+		for (size_t j = 0; j < index.parms[i].choices.size(); ++j) {
+			index.choices[i].push_back(strings[s++]);
+		}
+	}
+
+	hflog("[HoudiniEngine::parm_index] %1% parms for asset %2%", %index.parms.size() %asset_id);
+
+	myParmIndex[asset_id] = index;
+	return myParmIndex[asset_id];
+}
+
+// position of the named parm in the asset's parm index, -1 if there's none
+int HoudiniEngine::find_parm(const int asset_id, const String& parm_name)
+{
+	ParmIndex& index = parm_index(asset_id);
+	Dictionary<String, int>::const_iterator found = index.byName.find(parm_name);
+	return found == index.byName.end() ? -1 : found->second;
+}
+
+// stages an int or float value in writes, string values are set straight
+// away as HAPI has no call for several of them. Returns false if nothing was set
+bool HoudiniEngine::set_parm(const int asset_id, const String& parm_name, boost::python::object value, ParmWrites& writes)
+{
+	int p = find_parm(asset_id, parm_name);
+	if (p < 0) {
+		hflog("[HoudiniEngine::setParameterValue] No parm %1%", %parm_name);
+		return false;
+	}
+
+	ParmIndex& index = parm_index(asset_id);
+	hapi::Parm& parm = index.parms[p];
+	const HAPI_ParmInfo& info = parm.info();
+	const Vector<String>& choices = index.choices[p];
+
+	switch (info.type) {
+	case HAPI_PARMTYPE_INT:
+		if (info.choiceCount != 0) {
+			boost::python::extract<const char*> stringVal(value);
+			if (stringVal.check()) {
+				for (int i = 0; i < choices.size(); ++i) {
+					if (choices[i] == stringVal()) {
+						writes.ints[info.intValuesIndex] = i;
+						return true;
+					}
+				}
+			} // otherwise, fall through and try the int way of doing it
+		}
+		// continue through, it's ok!
+	case HAPI_PARMTYPE_MULTIPARMLIST:
+	case HAPI_PARMTYPE_TOGGLE:
+	case HAPI_PARMTYPE_BUTTON:
+		if (info.size > 1) {
+			boost::python::list myList = (boost::python::list) value;
+			if (!check_parm_size(myList, info.size)) {
+				return false;
+			}
+			for (int i = 0; i < info.size; ++i) {
+				boost::python::extract<int> myVal(myList[i]);
+				writes.ints[info.intValuesIndex + i] = myVal();
+			}
+		} else {
+			boost::python::extract<int> intVal(value);
+			if (!intVal.check()) {
+				ofwarn("[HoudiniEngine::setParameterValue] '%1%' not an integer value", %value);
+				return false;
+			}
+			writes.ints[info.intValuesIndex] = intVal();
+		}
+		// an instance count, the parms after it move
+		if (info.type == HAPI_PARMTYPE_MULTIPARMLIST) {
+			writes.multiparms = true;
+		}
+		return true;
+	case HAPI_PARMTYPE_FLOAT:
+	case HAPI_PARMTYPE_COLOR:
+		if (info.size > 1) {
+			boost::python::list myList = (boost::python::list) value;
+			if (!check_parm_size(myList, info.size)) {
+				return false;
+			}
+			for (int i = 0; i < info.size; ++i) {
+				boost::python::extract<float> myVal(myList[i]);
+				writes.floats[info.floatValuesIndex + i] = myVal();
+			}
+		} else {
+			boost::python::extract<float> floatVal(value);
+			if (!floatVal.check()) {
+				ofwarn("[HoudiniEngine::setParameterValue] '%1%' not a float value", %value);
+				return false;
+			}
+			writes.floats[info.floatValuesIndex] = floatVal();
+		}
+		return true;
+	case HAPI_PARMTYPE_STRING:
+		if (info.choiceCount != 0) {
+			boost::python::extract<const char*> stringVal(value);
+			if (stringVal.check()) {
+				for (int i = 0; i < choices.size(); ++i) {
+					if (choices[i] == stringVal()) {
+						parm.setStringValue(0, choices[i].c_str());
+						return true;
+					}
+				}
+			} // otherwise, fall through and try the int way of doing it
+		}
+		// continue through, it's ok!
+	case HAPI_PARMTYPE_PATH_FILE:
+	case HAPI_PARMTYPE_PATH_FILE_GEO:
+	case HAPI_PARMTYPE_PATH_FILE_IMAGE:
+	case HAPI_PARMTYPE_NODE:
+		if (info.size > 1) {
+			boost::python::list myList = (boost::python::list) value;
+			if (!check_parm_size(myList, info.size)) {
+				return false;
+			}
+			for (int i = 0; i < info.size; ++i) {
+				boost::python::extract<const char*> myVal(myList[i]);
+				parm.setStringValue(i, myVal());
+			}
+		} else {
+			boost::python::extract<const char*> stringVal(value);
+			if (!stringVal.check()) {
+				ofwarn("[HoudiniEngine::setParameterValue] '%1%' not a string value", %value);
+				return false;
+			}
+			parm.setStringValue(0, stringVal());
+		}
+		return true;
+	case HAPI_PARMTYPE_FOLDERLIST:
+	case HAPI_PARMTYPE_FOLDERLIST_RADIO:
+	case HAPI_PARMTYPE_FOLDER:
+	case HAPI_PARMTYPE_LABEL:
+	case HAPI_PARMTYPE_SEPARATOR:
+	default:
+		return false;
+	}
+}
+
+// sends the staged int and float values, then forgets them. A changed
+// multiparm count drops the asset's parm index
+void HoudiniEngine::write_parms(const hapi::Asset& asset, ParmWrites& writes)
+{
+	write_parm_values(asset.session, asset.nodeid, writes.ints);
+	write_parm_values(asset.session, asset.nodeid, writes.floats);
+
+	if (writes.multiparms) {
+		myParmIndex.erase(pool_asset_id(asset));
+	}
+	writes = ParmWrites();
+}
+
 boost::python::object HoudiniEngine::getParameterValue(const String& asset_name, const String& parm_name)
 {
     // only run on master
@@ -274,82 +506,72 @@ boost::python::object HoudiniEngine::getParameterValue(const String& asset_name,
 
     int asset_id = assetNameToIds[asset_name];
 
-    // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
-
-    if (myAsset == NULL) {
-        ofwarn("[HoudiniEngine::getParameterValue] No asset of name %1%", %asset_name);
+    int p = find_parm(asset_id, parm_name);
+    if (p < 0) {
         return boost::python::object();
-
     }
 
-    std::vector<hapi::Parm> parms = myAsset->parms();
-
-    for (vector<hapi::Parm>::iterator it = parms.begin(); it < parms.end(); ++it) {
-        if (it->name() == parm_name) {
-
-            switch (it->info().type) {
-            case HAPI_PARMTYPE_INT:
-                if (it->info().choiceCount != 0) {
-                    return boost::python::object(it->choices[it->getIntValue(0)].label());
-                    break;
-                }
-                // continue through, it's ok!
-            case HAPI_PARMTYPE_MULTIPARMLIST:
-            case HAPI_PARMTYPE_TOGGLE:
-            case HAPI_PARMTYPE_BUTTON:
-                if (it->info().size > 1) {
-                    boost::python::list list;
-                    for (int i =0; i < it->info().size; ++i) {
-                        list.append(it->getIntValue(i));
-                    }
-                    return boost::python::object(list);
-                } else {
-                    return boost::python::object(it->getIntValue(0));
-                }
-                break;
-            case HAPI_PARMTYPE_FLOAT:
-            case HAPI_PARMTYPE_COLOR:
-                if (it->info().size > 1) {
-                    boost::python::list list;
-                    for (int i =0; i < it->info().size; ++i) {
-                        list.append(it->getFloatValue(i));
-                    }
-                    return boost::python::object(list);
-                } else {
-                    return boost::python::object(it->getFloatValue(0));
-                }
-                break;
-            case HAPI_PARMTYPE_STRING:
-                if (it->info().choiceCount != 0) {
-                    return boost::python::object(it->choices[it->getIntValue(0)].label());
-                    break;
-                }
-                // continue through, it's ok!
-            case HAPI_PARMTYPE_PATH_FILE:
-            case HAPI_PARMTYPE_PATH_FILE_GEO:
-            case HAPI_PARMTYPE_PATH_FILE_IMAGE:
-            case HAPI_PARMTYPE_NODE:
-                if (it->info().size > 1) {
-                    boost::python::list list;
-                    for (int i =0; i < it->info().size; ++i) {
-                        list.append(it->getStringValue(i).c_str());
-                    }
-                    return boost::python::object(list);
-                } else {
-                    return boost::python::object(it->getStringValue(0).c_str());
-                }
+    ParmIndex& index = parm_index(asset_id);
+    const hapi::Parm* it = &index.parms[p];
 
-                break;
-            case HAPI_PARMTYPE_FOLDERLIST:
-            case HAPI_PARMTYPE_FOLDERLIST_RADIO:
-            case HAPI_PARMTYPE_FOLDER:
-            case HAPI_PARMTYPE_LABEL:
-            case HAPI_PARMTYPE_SEPARATOR:
-            default:
-                break;
+    switch (it->info().type) {
+    case HAPI_PARMTYPE_INT:
+        if (it->info().choiceCount != 0) {
+            return boost::python::object(index.choices[p][it->getIntValue(0)]);
+        }
+        // continue through, it's ok!
+    case HAPI_PARMTYPE_MULTIPARMLIST:
+    case HAPI_PARMTYPE_TOGGLE:
+    case HAPI_PARMTYPE_BUTTON:
+        if (it->info().size > 1) {
+            boost::python::list list;
+            for (int i =0; i < it->info().size; ++i) {
+                list.append(it->getIntValue(i));
+            }
+            return boost::python::object(list);
+        } else {
+            return boost::python::object(it->getIntValue(0));
+        }
+        break;
+    case HAPI_PARMTYPE_FLOAT:
+    case HAPI_PARMTYPE_COLOR:
+        if (it->info().size > 1) {
+            boost::python::list list;
+            for (int i =0; i < it->info().size; ++i) {
+                list.append(it->getFloatValue(i));
+            }
+            return boost::python::object(list);
+        } else {
+            return boost::python::object(it->getFloatValue(0));
+        }
+        break;
+    case HAPI_PARMTYPE_STRING:
+        if (it->info().choiceCount != 0) {
+            return boost::python::object(index.choices[p][it->getIntValue(0)]);
+        }
+        // continue through, it's ok!
+    case HAPI_PARMTYPE_PATH_FILE:
+    case HAPI_PARMTYPE_PATH_FILE_GEO:
+    case HAPI_PARMTYPE_PATH_FILE_IMAGE:
+    case HAPI_PARMTYPE_NODE:
+        if (it->info().size > 1) {
+            boost::python::list list;
+            for (int i =0; i < it->info().size; ++i) {
+                list.append(it->getStringValue(i).c_str());
             }
+            return boost::python::object(list);
+        } else {
+            return boost::python::object(it->getStringValue(0).c_str());
         }
+
+        break;
+    case HAPI_PARMTYPE_FOLDERLIST:
+    case HAPI_PARMTYPE_FOLDERLIST_RADIO:
+    case HAPI_PARMTYPE_FOLDER:
+    case HAPI_PARMTYPE_LABEL:
+    case HAPI_PARMTYPE_SEPARATOR:
+    default:
+        break;
     }
 
     return boost::python::object();
@@ -364,172 +586,17 @@ void HoudiniEngine::setParameterValue(const String& asset_name, const String& pa
 	}
 
     int asset_id = assetNameToIds[asset_name];
-    // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+    hapi::Asset asset = pool_asset(asset_id);
 
-    if (myAsset == NULL) {
-        ofwarn("[HoudiniEngine::setParameterValue] No asset of name %1%", %asset_name);
+    ParmWrites writes;
+    if (!set_parm(asset_id, parm_name, value, writes)) {
         return;
-
     }
+    write_parms(asset, writes);
 
-    std::vector<hapi::Parm> parms = myAsset->parms();
-
-    for (vector<hapi::Parm>::iterator it = parms.begin(); it < parms.end(); ++it) {
-        if (it->name() == parm_name) {
-
-            switch (it->info().type) {
-            case HAPI_PARMTYPE_INT:
-                if (it->info().choiceCount != 0) {
-                    boost::python::extract<const char*> stringVal(value);
-                    if (stringVal.check()) {
-                        boost::python::list myChoices = getParameterChoices(asset_name, parm_name);
-                        bool found = false;
-                        for (int i = 0; i < boost::python::len(myChoices); ++i) {
-                            boost::python::extract<const char *> myVal(myChoices[i]);
-                            if (strcmp(stringVal, myVal) == 0) {
-                                it->setIntValue(0, i);
-                                found = true;
-                                break;
-                            }
-                        }
-
-                        if (found) {
-                            break;
-                        }
-                    } // otherwise, fall through and try the int way of doing it
-                }
-                // continue through, it's ok!
-            case HAPI_PARMTYPE_MULTIPARMLIST:
-            case HAPI_PARMTYPE_TOGGLE:
-            case HAPI_PARMTYPE_BUTTON:
-            {
-                if (it->info().size > 1) {
-                    boost::python::list myList = (boost::python::list) value;
-                    if (boost::python::len(myList) != it->info().size) {
-                        ofwarn("[HoudiniEngine::setParameterValue] incorrect number of args, got %1%, expected %2%",
-                            %boost::python::len(myList)
-                            %it->info().size
-                        );
-                        return;
-                    }
-                    for (int i =0; i < it->info().size; ++i) {
-                        boost::python::extract<int> myVal(myList[i]);
-                        it->setIntValue(i, myVal);
-                    }
-                    break;
-                } else {
-                    boost::python::extract<int> intVal(value);
-                    if (intVal.check()) {
-                        it->setIntValue(0, intVal);
-                    } else {
-                        ofwarn("[HoudiniEngine::setParameterValue] '%1%' not an integer value", %value);
-                    }
-                    break;
-                }
-            }
-            case HAPI_PARMTYPE_FLOAT:
-            case HAPI_PARMTYPE_COLOR:
-            {
-                if (it->info().size > 1) {
-                    boost::python::list myList = (boost::python::list) value;
-                    if (boost::python::len(myList) != it->info().size) {
-                        ofwarn("[HoudiniEngine::setParameterValue] incorrect number of args, got %1%, expected %2%",
-                            %boost::python::len(myList)
-                            %it->info().size
-                        );
-                        return;
-                    }
-                    for (int i =0; i < it->info().size; ++i) {
-                        boost::python::extract<float> myVal(myList[i]);
-                        it->setFloatValue(i, myVal);
-                    }
-                    break;
-                } else {
-                    boost::python::extract<float> floatVal(value);
-                    if (floatVal.check()) {
-                        it->setFloatValue(0, floatVal);
-                    } else {
-                        ofwarn("[HoudiniEngine::setParameterValue] '%1%' not a float value", %value);
-                    }
-                    break;
-                }
-            }
-            case HAPI_PARMTYPE_STRING:
-                if (it->info().choiceCount != 0) {
-                    boost::python::extract<const char*> stringVal(value);
-                    if (stringVal.check()) {
-                        boost::python::list myChoices = getParameterChoices(asset_name, parm_name);
-                        bool found = false;
-                        for (int i = 0; i < boost::python::len(myChoices); ++i) {
-                            boost::python::extract<const char *> myVal(myChoices[i]);
-                            if (strcmp(stringVal, myVal) == 0) {
-                                it->setStringValue(0, myVal);
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (found) {
-                            break;
-                        }
-                    } // otherwise, fall through and try the int way of doing it
-                }
-                // continue through, it's ok!
-            case HAPI_PARMTYPE_PATH_FILE:
-            case HAPI_PARMTYPE_PATH_FILE_GEO:
-            case HAPI_PARMTYPE_PATH_FILE_IMAGE:
-            case HAPI_PARMTYPE_NODE:
-            {
-                if (it->info().size > 1) {
-                    boost::python::list myList = (boost::python::list) value;
-                    if (boost::python::len(myList) != it->info().size) {
-                        ofwarn("[HoudiniEngine::setParameterValue] incorrect number of args, got %1%, expected %2%",
-                            %boost::python::len(myList)
-                            %it->info().size
-                        );
-                        return;
-                    }
-                    for (int i =0; i < it->info().size; ++i) {
-                        boost::python::extract<const char*> myVal(myList[i]);
-                        it->setStringValue(i, myVal);
-                    }
-                    break;
-                } else {
-                    boost::python::extract<const char*> stringVal(value);
-                    if (stringVal.check()) {
-                        it->setStringValue(0, stringVal);
-                    } else {
-                        ofwarn("[HoudiniEngine::setParameterValue] '%1%' not a string value", %value);
-                    }
-                    break;
-                }
-            }
-            // {
-            //     boost::python::extract<const char* > stringVal(value);
-            //     if (stringVal.check()) {
-            //         it->setStringValue(0, stringVal);
-            //     } else {
-            //         ofwarn("'%1%' not an string value", %value);
-            //     }
-            //     break;
-            // }
-            case HAPI_PARMTYPE_FOLDERLIST:
-            case HAPI_PARMTYPE_FOLDERLIST_RADIO:
-            case HAPI_PARMTYPE_FOLDER:
-            case HAPI_PARMTYPE_LABEL:
-            case HAPI_PARMTYPE_SEPARATOR:
-            default:
-                return;
-            }
-
-            if (cookOnSet) {
-                cook_one(myAsset);
-            }
-
-            return;
-        }
+    if (cookOnSet) {
+        cook_one(&asset);
     }
-
 }
 
 void HoudiniEngine::setParameterValues(const String& asset_name, const boost::python::dict values, const bool cookOnSet)
@@ -541,33 +608,33 @@ void HoudiniEngine::setParameterValues(const String& asset_name, const boost::py
 	}
 
     int asset_id = assetNameToIds[asset_name];
-    // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
-
-    if (myAsset == NULL) {
-        ofwarn("[HoudiniEngine::setParameterValues] No asset of name %1%", %asset_name);
-        return;
-
-    }
-
-    std::vector<hapi::Parm> parms = myAsset->parms();
+    hapi::Asset asset = pool_asset(asset_id);
 
     boost::python::list keys = values.keys();
 
+    // all the values go out together, a call per type and run of parms
+    ParmWrites writes;
     for (int i =0; i < len(keys); ++i) {
         boost::python::extract<std::string> extracted_key(keys[i]);
 
         if(!extracted_key.check()) {
             oerror("[HoudiniEngine::setParameterValues] Bad Key in dict");
+            write_parms(asset, writes);
             return;
         }
         std::string key = extracted_key;
-        
-        setParameterValue(asset_name, key, values[key], false);
+
+        set_parm(asset_id, key, values[key], writes);
+
+        // the parms after a multiparm move, look the rest up again
+        if (writes.multiparms) {
+            write_parms(asset, writes);
+        }
     }
+    write_parms(asset, writes);
 
     if (cookOnSet) {
-        cook_one(myAsset);
+        cook_one(&asset);
     }
 
 }
@@ -581,23 +648,18 @@ void HoudiniEngine::insertMultiparmInstance(const String& asset_name, const Stri
 	}
 
     int asset_id = assetNameToIds[asset_name];
-    // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
 
-    if (myAsset == NULL) {
-        ofwarn("[HoudiniEngine::insertMultiparmInstance] No asset of name %1%", %asset_name);
+    int p = find_parm(asset_id, parm_name);
+    if (p < 0) {
+        ofwarn("[HoudiniEngine::insertMultiparmInstance] No parm %1% on %2%", %parm_name %asset_name);
         return;
-
     }
 
-    std::vector<hapi::Parm> parms = myAsset->parms();
-    for (vector<hapi::Parm>::iterator it = parms.begin(); it < parms.end(); ++it) {
-        if (it->name() == parm_name) {
-            it->insertMultiparmInstance(pos);
-            cook_one(myAsset);
-            return;
-        }
-    }
+    parm_index(asset_id).parms[p].insertMultiparmInstance(pos);
+    myParmIndex.erase(asset_id);
+
+    hapi::Asset asset = pool_asset(asset_id);
+    cook_one(&asset);
 }
 void HoudiniEngine::removeMultiparmInstance(const String& asset_name, const String& parm_name, int pos) {
 
@@ -608,24 +670,18 @@ void HoudiniEngine::removeMultiparmInstance(const String& asset_name, const Stri
 	}
 
     int asset_id = assetNameToIds[asset_name];
-    // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
 
-    if (myAsset == NULL) {
-        ofwarn("[HoudiniEngine::removeMultiparmInstance] No asset of name %1%", %asset_name);
+    int p = find_parm(asset_id, parm_name);
+    if (p < 0) {
+        ofwarn("[HoudiniEngine::removeMultiparmInstance] No parm %1% on %2%", %parm_name %asset_name);
         return;
-
     }
 
-    std::vector<hapi::Parm> parms = myAsset->parms();
-    for (vector<hapi::Parm>::iterator it = parms.begin(); it < parms.end(); ++it) {
-        if (it->name() == parm_name) {
-            it->removeMultiparmInstance(pos);
-            cook_one(myAsset);
-            return;
-        }
-    }
+    parm_index(asset_id).parms[p].removeMultiparmInstance(pos);
+    myParmIndex.erase(asset_id);
 
+    hapi::Asset asset = pool_asset(asset_id);
+    cook_one(&asset);
 }
 
 boost::python::list HoudiniEngine::getParameterChoices(const String& asset_name, const String& parm_name) {
@@ -638,23 +694,15 @@ boost::python::list HoudiniEngine::getParameterChoices(const String& asset_name,
 	}
 
     int asset_id = assetNameToIds[asset_name];
-    // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
 
-    if (myAsset == NULL) {
-        ofwarn("[HoudiniEngine::getParameterChoices] No asset of name %1%", %asset_name);
+    int p = find_parm(asset_id, parm_name);
+    if (p < 0) {
         return myList;
-
     }
 
-    std::vector<hapi::Parm> parms = myAsset->parms();
-    for (vector<hapi::Parm>::iterator it = parms.begin(); it < parms.end(); ++it) {
-        if (it->name() == parm_name) {
-            for (int i=0; i < it->choices.size(); ++i) {
-                myList.append(it->choices[i].label());
-            }
-            break;
-        }
+    const Vector<String>& choices = parm_index(asset_id).choices[p];
+    for (int i=0; i < choices.size(); ++i) {
+        myList.append(choices[i]);
     }
 
     return myList;
@@ -671,7 +719,7 @@ int HoudiniEngine::getIntegerParameterValue(const String& asset_name, int param_
 
 	int asset_id = assetNameToIds[asset_name];
     // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+	hapi::Asset* myAsset = new hapi::Asset(pool_asset(asset_id));
 
     if (myAsset == NULL) {
         ofwarn("[HoudiniEngine::getIntegerParameterValue] No asset of name %1%", %asset_name);
@@ -699,7 +747,7 @@ void HoudiniEngine::setIntegerParameterValue(const String& asset_name, int param
 
 	int asset_id = assetNameToIds[asset_name];
     // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+	hapi::Asset* myAsset = new hapi::Asset(pool_asset(asset_id));
 
     if (myAsset == NULL) {
         ofwarn("[HoudiniEngine::setIntegerParameterValue] No asset of name %1%", %asset_name);
@@ -711,6 +759,9 @@ void HoudiniEngine::setIntegerParameterValue(const String& asset_name, int param
 
             if (it->info().id == param_id) {
                 it->setIntValue(sub_index, value);
+                if (it->info().type == HAPI_PARMTYPE_MULTIPARMLIST) {
+                    myParmIndex.erase(asset_id);
+                }
                 break;
             }
         }
@@ -729,7 +780,7 @@ float HoudiniEngine::getFloatParameterValue(const String& asset_name, int param_
 
 	int asset_id = assetNameToIds[asset_name];
     // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+	hapi::Asset* myAsset = new hapi::Asset(pool_asset(asset_id));
 
     if (myAsset == NULL) {
         ofwarn("[HoudiniEngine::getFloatParameterValue] No asset of name %1%", %asset_name);
@@ -757,7 +808,7 @@ void HoudiniEngine::setFloatParameterValue(const String& asset_name, int param_i
 
 	int asset_id = assetNameToIds[asset_name];
     // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+	hapi::Asset* myAsset = new hapi::Asset(pool_asset(asset_id));
 
     if (myAsset == NULL) {
         ofwarn("[HoudiniEngine::setFloatParameterValue] No asset of name %1%", %asset_name);
@@ -787,7 +838,7 @@ String HoudiniEngine::getStringParameterValue(const String& asset_name, int para
 
 	int asset_id = assetNameToIds[asset_name];
     // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+	hapi::Asset* myAsset = new hapi::Asset(pool_asset(asset_id));
 
     if (myAsset == NULL) {
         ofwarn("[HoudiniEngine::getStringParameterValue] No asset of name %1%", %asset_name);
@@ -815,7 +866,7 @@ void HoudiniEngine::setStringParameterValue(const String& asset_name, int param_
 
 	int asset_id = assetNameToIds[asset_name];
     // shouldn't be cached, should fetch new each time
-	hapi::Asset* myAsset = new hapi::Asset(asset_id, session);
+	hapi::Asset* myAsset = new hapi::Asset(pool_asset(asset_id));
 
     if (myAsset == NULL) {
         ofwarn("[HoudiniEngine::setStringParameterValue] No asset of name %1%", %asset_name);
@@ -857,7 +908,7 @@ void HoudiniEngine::printParms(int asset_id) {
 		return;
 	}
 
-    hapi::Asset* asset = new hapi::Asset(asset_id, session);
+    hapi::Asset* asset = new hapi::Asset(pool_asset(asset_id));
     if (asset == NULL) {
         ofwarn("[HoudiniEngine::printParms] No asset with id %1%", %asset_id);
         return;
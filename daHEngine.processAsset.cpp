@@ -47,8 +47,579 @@ daHEngine
 #include <osgUtil/PrintVisitor>
 #include <ostream>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+#include <OpenThreads/Thread>
+
 using namespace houdiniEngine;
 
+// key for welding face corners in indexed mode: the point plus the attribute
+// values the corner ends up with. Plain floats, no padding, so memcmp orders it
+struct CornerKey
+{
+	int point;
+	float normal[3];
+	float color[4];
+	float uv[3];
+
+	bool operator<(const CornerKey& other) const {
+		return memcmp(this, &other, sizeof(CornerKey)) < 0;
+	}
+};
+
+// one part on its way through process_asset: process_part reads it from HAPI,
+// convert_part builds its osg arrays (maybe on a worker thread), apply_part
+// hands them to the HoudiniGeometry
+struct houdiniEngine::PartJob
+{
+	PartJob(const hapi::Part& p, const int obj, const int geo, const int index, const bool idx):
+		part(p), objIndex(obj), geoIndex(geo), partIndex(index), indexed(idx),
+		isMesh(p.info().type == HAPI_PARTTYPE_MESH), triangulate(false), pointArrays(false),
+		isCurve(false), curveTolerance(0),
+		inPlace(false), sourcePoints(NULL), sourceCorners(NULL),
+		has_point_normals(false), has_vertex_normals(false),
+		has_point_colors(false), has_point_alphas(false), has_primitive_colors(false),
+		has_point_uvs(false), has_vertex_uvs(false)
+	{}
+
+	hapi::Part part;
+	int objIndex;
+	int geoIndex;
+	int partIndex;
+	bool indexed;
+	bool isMesh;
+	// faces go into one triangle list instead of a set per face size
+	bool triangulate;
+	// point attributes went straight into arrays, the vectors are empty
+	bool pointArrays;
+	// connectivity is unchanged: arrays are the part's current ones and
+	// only get their values replaced, through the saved source lists
+	bool inPlace;
+	const vector<int>* sourcePoints;
+	const vector<int>* sourceCorners;
+
+	vector<Vector3f> points;
+	vector<Vector3f> normals;
+	vector<Vector3f> colors;
+	vector<float> alphas;
+	vector<Vector3f> uvs;
+	vector<int> face_counts;
+	vector<int> vertex_list;
+
+	// curves: cv count and order of each curve, the knots of all of them
+	// and the cv weights (Pw) of rational ones
+	bool isCurve;
+	HAPI_CurveInfo curveInfo;
+	vector<int> curve_counts;
+	vector<int> curve_orders;
+	vector<float> curve_knots;
+	vector<float> weights;
+	float curveTolerance;
+
+	bool has_point_normals;
+	bool has_vertex_normals;
+	bool has_point_colors;
+	bool has_point_alphas;
+	bool has_primitive_colors;
+	bool has_point_uvs;
+	bool has_vertex_uvs;
+
+	PartArrays arrays;
+};
+
+// takes parts off a shared list and converts them until none are left
+class PartWorker: public OpenThreads::Thread
+{
+public:
+	PartWorker(vector<PartJob>& jobs, int& next, OpenThreads::Mutex& mutex):
+		myJobs(jobs), myNext(next), myMutex(mutex)
+	{}
+
+	virtual void run()
+	{
+		while (true) {
+			int i;
+			{
+				OpenThreads::ScopedLock<OpenThreads::Mutex> lock(myMutex);
+				i = myNext++;
+			}
+			if (i >= int(myJobs.size())) {
+				return;
+			}
+			HoudiniEngine::convert_part(myJobs[i]);
+		}
+	}
+
+private:
+	vector<PartJob>& myJobs;
+	int& myNext;
+	OpenThreads::Mutex& myMutex;
+};
+
+static bool has_attrib(const vector<std::string>& names, const char* name)
+{
+	return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+// adds a face to the element sets of a part, creating them as needed. Faces
+// above 3 sides are fanned into the triangle list, except quads if asked for
+static void add_face(PartArrays& arrays, const unsigned int* face, const int count, const bool quads,
+	osg::DrawElementsUInt*& pointElements, osg::DrawElementsUInt*& lineElements,
+	osg::DrawElementsUInt*& triElements, osg::DrawElementsUInt*& quadElements)
+{
+	if (count == 1) {
+		if (pointElements == NULL) {
+			pointElements = arrays.addPrimitiveElements(osg::PrimitiveSet::POINTS);
+		}
+		pointElements->push_back(face[0]);
+	} else if (count == 2) {
+		if (lineElements == NULL) {
+			lineElements = arrays.addPrimitiveElements(osg::PrimitiveSet::LINES);
+		}
+		lineElements->push_back(face[0]);
+		lineElements->push_back(face[1]);
+	} else if (count == 4 && quads) {
+		if (quadElements == NULL) {
+			quadElements = arrays.addPrimitiveElements(osg::PrimitiveSet::QUADS);
+		}
+		for (int jj = 0; jj < 4; jj++) {
+			quadElements->push_back(face[jj]);
+		}
+	} else if (count > 2) {
+		if (triElements == NULL) {
+			triElements = arrays.addPrimitiveElements(osg::PrimitiveSet::TRIANGLES);
+		}
+		for (int jj = 1; jj < count - 1; jj++) {
+			triElements->push_back(face[0]);
+			triElements->push_back(face[jj]);
+			triElements->push_back(face[jj + 1]);
+		}
+	}
+}
+
+// post-transform cache simulated by optimize_vertex_cache
+static const int VERTEX_CACHE_SIZE = 32;
+
+// Forsyth's vertex score: vertices just used or with few triangles left to
+// draw score higher
+static float vertex_score(const int cachePos, const int trianglesLeft)
+{
+	if (trianglesLeft == 0) {
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cachePos >= 0) {
+		if (cachePos < 3) {
+			// the triangle just drawn, don't favour it over its neighbours
+			score = 0.75f;
+		} else {
+			float scale = 1.0f / (VERTEX_CACHE_SIZE - 3);
+			score = std::pow(1.0f - (cachePos - 3) * scale, 1.5f);
+		}
+	}
+	return score + 2.0f * std::pow(float(trianglesLeft), -0.5f);
+}
+
+// reorder a triangle list (Forsyth's linear speed optimisation) so vertices
+// are reused while still in the post-transform cache. Greedily draws the
+// best scoring triangle among those touching the simulated cache
+static void optimize_vertex_cache(unsigned int* indices, const int indexCount, const int vertexCount)
+{
+	const int triCount = indexCount / 3;
+	if (triCount < 2) {
+		return;
+	}
+
+	// triangles of each vertex, the live ones first
+	vector<int> trianglesLeft(vertexCount, 0);
+	for (int i = 0; i < triCount * 3; ++i) {
+		trianglesLeft[indices[i]]++;
+	}
+	vector<int> firstTriangle(vertexCount + 1, 0);
+	for (int v = 0; v < vertexCount; ++v) {
+		firstTriangle[v + 1] = firstTriangle[v] + trianglesLeft[v];
+	}
+	vector<int> vertexTriangles(triCount * 3);
+	vector<int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+	for (int i = 0; i < triCount * 3; ++i) {
+		vertexTriangles[fill[indices[i]]++] = i / 3;
+	}
+
+	vector<int> cachePos(vertexCount, -1);
+	vector<float> vertexScore(vertexCount);
+	for (int v = 0; v < vertexCount; ++v) {
+		vertexScore[v] = vertex_score(-1, trianglesLeft[v]);
+	}
+
+	vector<float> triangleScore(triCount);
+	vector<char> drawn(triCount, 0);
+	int best = 0;
+	for (int t = 0; t < triCount; ++t) {
+		const unsigned int* tri = indices + t * 3;
+		triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+		if (triangleScore[t] > triangleScore[best]) {
+			best = t;
+		}
+	}
+
+	vector<unsigned int> out;
+	out.reserve(triCount * 3);
+	vector<int> cache;
+	vector<int> newCache;
+	int nextUndrawn = 0;
+
+	while (int(out.size()) < triCount * 3) {
+		// nothing in the cache to carry on from, take the next undrawn one
+		if (best < 0) {
+			while (drawn[nextUndrawn]) {
+				++nextUndrawn;
+			}
+			best = nextUndrawn;
+		}
+
+		drawn[best] = 1;
+		const unsigned int* tri = indices + best * 3;
+
+		newCache.clear();
+		for (int k = 0; k < 3; ++k) {
+			int v = tri[k];
+			out.push_back(v);
+			newCache.push_back(v);
+
+			// move the triangle past the vertex's live ones
+			int* live = &vertexTriangles[firstTriangle[v]];
+			int last = trianglesLeft[v] - 1;
+			for (int i = 0; i <= last; ++i) {
+				if (live[i] == best) {
+					std::swap(live[i], live[last]);
+					break;
+				}
+			}
+			trianglesLeft[v]--;
+		}
+		for (int i = 0; i < int(cache.size()); ++i) {
+			if (cache[i] != int(tri[0]) && cache[i] != int(tri[1]) && cache[i] != int(tri[2])) {
+				newCache.push_back(cache[i]);
+			}
+		}
+
+		// rescore the vertices in (and just pushed out of) the cache, then
+		// their triangles, picking the best of those to draw next
+		for (int i = 0; i < int(newCache.size()); ++i) {
+			int v = newCache[i];
+			cachePos[v] = i < VERTEX_CACHE_SIZE ? i : -1;
+			vertexScore[v] = vertex_score(cachePos[v], trianglesLeft[v]);
+		}
+
+		best = -1;
+		float bestScore = -1.0f;
+		for (int i = 0; i < int(newCache.size()); ++i) {
+			int v = newCache[i];
+			for (int j = 0; j < trianglesLeft[v]; ++j) {
+				int t = vertexTriangles[firstTriangle[v] + j];
+				const unsigned int* other = indices + t * 3;
+				triangleScore[t] = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+
+		if (int(newCache.size()) > VERTEX_CACHE_SIZE) {
+			newCache.resize(VERTEX_CACHE_SIZE);
+		}
+		cache.swap(newCache);
+	}
+
+	std::copy(out.begin(), out.end(), indices);
+}
+
+// curve tessellation: segments per bezier segment or nurbs knot span, and
+// the highest order evaluated (Houdini allows up to 11)
+static const int CURVE_MAX_SEGMENTS = 64;
+static const int CURVE_MAX_ORDER = 11;
+
+// segments needed for the chords of a polynomial span to stay within
+// tolerance of it (Wang's formula on its control points). The cvs of a
+// nurbs span are only close to its bezier points, which is good enough here
+static int span_segments(const Vector3f* cvs, const int count, const float tolerance)
+{
+	const int degree = count - 1;
+	if (degree < 2) {
+		return 1;
+	}
+	if (tolerance <= 0) {
+		return CURVE_MAX_SEGMENTS;
+	}
+
+	float m = 0;
+	for (int i = 0; i + 2 < count; ++i) {
+		m = std::max(m, (cvs[i + 2] - 2 * cvs[i + 1] + cvs[i]).norm());
+	}
+
+	int n = int(std::ceil(std::sqrt(degree * (degree - 1) * m / (8 * tolerance))));
+	return std::min(std::max(n, 1), CURVE_MAX_SEGMENTS);
+}
+
+// the order nonzero b-spline basis functions at u in knot span i (the
+// NURBS Book, A2.2)
+static void bspline_basis(const float* knots, const int i, const float u, const int order, float* basis)
+{
+	float left[CURVE_MAX_ORDER];
+	float right[CURVE_MAX_ORDER];
+
+	basis[0] = 1;
+	for (int j = 1; j < order; ++j) {
+		left[j] = u - knots[i + 1 - j];
+		right[j] = knots[i + j] - u;
+		float saved = 0;
+		for (int r = 0; r < j; ++r) {
+			float denom = right[r + 1] + left[j - r];
+			float temp = denom != 0 ? basis[r] / denom : 0;
+			basis[r] = saved + right[r + 1] * temp;
+			saved = left[j - r] * temp;
+		}
+		basis[j] = saved;
+	}
+}
+
+// the degree + 1 Bernstein polynomials at t, from running powers of t and
+// 1 - t instead of two pow calls per term
+static void bernstein_basis(const int degree, const float t, float* basis)
+{
+	float tPow[CURVE_MAX_ORDER];
+	float sPow[CURVE_MAX_ORDER];
+
+	tPow[0] = 1;
+	sPow[0] = 1;
+	for (int j = 1; j <= degree; ++j) {
+		tPow[j] = tPow[j - 1] * t;
+		sPow[j] = sPow[j - 1] * (1 - t);
+	}
+
+	float binomial = 1;
+	for (int j = 0; j <= degree; ++j) {
+		basis[j] = binomial * tPow[j] * sPow[degree - j];
+		binomial = binomial * (degree - j) / (j + 1);
+	}
+}
+
+// adds the sample with the given weights of the cvs starting at first
+static int add_curve_sample(PartJob& job, const int first, const float* basis, const int count, const Color* curveColor)
+{
+	PartArrays& arrays = job.arrays;
+
+	Vector3f p = Vector3f::Zero();
+	Vector3f c = Vector3f::Zero();
+	float a = 0;
+	float w = 0;
+	for (int j = 0; j < count; ++j) {
+		float b = basis[j] * (job.weights.empty() ? 1.0f : job.weights[first + j]);
+		p += b * job.points[first + j];
+		if (job.has_point_colors) {
+			c += b * job.colors[first + j];
+		}
+		if (job.has_point_alphas) {
+			a += b * job.alphas[first + j];
+		}
+		w += b;
+	}
+	if (w != 0) {
+		p /= w;
+		c /= w;
+		a /= w;
+	}
+
+	int v = arrays.addVertex(p);
+	if (job.has_point_colors) {
+		arrays.addColor(Color(c[0], c[1], c[2], job.has_point_alphas ? a : 1.0f));
+	} else if (curveColor != NULL) {
+		arrays.addColor(*curveColor);
+	}
+	return v;
+}
+
+// tessellates all curves of a part into one vertex array and one element set
+// of lines, the segments of every curve in a row. Bezier segments and nurbs
+// spans get as many samples as their flatness asks for, see span_segments
+static void tessellate_curves(PartJob& job)
+{
+	PartArrays& arrays = job.arrays;
+	const HAPI_CurveInfo& info = job.curveInfo;
+	const int curveCount = int(job.curve_counts.size());
+
+	osg::DrawElementsUInt* lines = NULL;
+
+	float basis[CURVE_MAX_ORDER];
+	vector<float> defaultKnots;
+
+	// weights only count if every cv has one
+	if (job.weights.size() != job.points.size()) {
+		job.weights.clear();
+	}
+
+	int cvOffset = 0;
+	int knotOffset = 0;
+
+	for (int i = 0; i < curveCount; ++i) {
+		const int count = job.curve_counts[i];
+		const int order = std::min(std::max(job.curve_orders[i], 2), int(CURVE_MAX_ORDER));
+		const int first = cvOffset;
+
+		cvOffset += count;
+		const float* knots = NULL;
+		if (info.curveType == HAPI_CURVETYPE_NURBS && !job.curve_knots.empty()) {
+			knots = &job.curve_knots[knotOffset];
+			knotOffset += count + job.curve_orders[i];
+		}
+
+		// not enough cvs, or the points aren't there
+		if (count < order || first + count > int(job.points.size())) {
+			continue;
+		}
+
+		Color curveColor;
+		const Color* color = NULL;
+		if (job.has_primitive_colors && i < int(job.colors.size())) {
+			curveColor = Color(job.colors[i][0], job.colors[i][1], job.colors[i][2], 1.0f);
+			color = &curveColor;
+		}
+
+		if (lines == NULL) {
+			lines = arrays.addPrimitiveElements(osg::PrimitiveSet::LINES);
+		}
+
+		int prev = -1;
+
+		if (info.curveType == HAPI_CURVETYPE_LINEAR || order == 2) {
+			for (int j = 0; j < count; ++j) {
+				basis[0] = 1;
+				int v = add_curve_sample(job, first + j, basis, 1, color);
+				if (prev >= 0) {
+					lines->push_back(prev);
+					lines->push_back(v);
+				}
+				prev = v;
+			}
+			if (info.isPeriodic && count > 2) {
+				lines->push_back(prev);
+				lines->push_back(prev - count + 1);
+			}
+		} else if (info.curveType == HAPI_CURVETYPE_BEZIER) {
+			// segments of order cvs sharing their end cvs
+			const int degree = order - 1;
+			for (int seg = 0; seg + degree < count; seg += degree) {
+				const Vector3f* cvs = &job.points[first + seg];
+				const int samples = span_segments(cvs, order, job.curveTolerance);
+
+				for (int k = (prev < 0 ? 0 : 1); k <= samples; ++k) {
+					bernstein_basis(degree, float(k) / samples, basis);
+
+					int v = add_curve_sample(job, first + seg, basis, order, color);
+					if (prev >= 0) {
+						lines->push_back(prev);
+						lines->push_back(v);
+					}
+					prev = v;
+				}
+			}
+		} else {
+			// no knots from HAPI, make them uniform and clamped
+			if (knots == NULL) {
+				defaultKnots.resize(count + order);
+				for (int k = 0; k < count + order; ++k) {
+					defaultKnots[k] = float(std::min(std::max(k - order + 1, 0), count - order + 1));
+				}
+				knots = &defaultKnots[0];
+			}
+
+			// the spans between knots order - 1 and count
+			for (int span = order - 1; span < count; ++span) {
+				if (knots[span + 1] <= knots[span]) {
+					continue;
+				}
+
+				const int spanFirst = first + span - order + 1;
+				const int samples = span_segments(&job.points[spanFirst], order, job.curveTolerance);
+
+				for (int k = (prev < 0 ? 0 : 1); k <= samples; ++k) {
+					float u = knots[span] + (knots[span + 1] - knots[span]) * k / samples;
+					bspline_basis(knots, span, u, order, basis);
+
+					int v = add_curve_sample(job, spanFirst, basis, order, color);
+					if (prev >= 0) {
+						lines->push_back(prev);
+						lines->push_back(v);
+					}
+					prev = v;
+				}
+			}
+		}
+	}
+}
+
+// the face counts and vertex list of a mesh part
+static void read_faces(const hapi::Part& part, vector<int>& face_counts, vector<int>& vertex_list)
+{
+	face_counts.resize(part.info().faceCount);
+	if (!face_counts.empty()) {
+		ENSURE_SUCCESS_BYTES(part.session, face_counts.size() * sizeof(int), HAPI_GetFaceCounts(
+			part.session,
+			part.geo.info().nodeId,
+			part.id,
+			face_counts.data(),
+			0,
+			part.info().faceCount
+		) );
+	}
+
+	vertex_list.resize(part.info().vertexCount);
+	if (!vertex_list.empty()) {
+		ENSURE_SUCCESS_BYTES(part.session, vertex_list.size() * sizeof(int), HAPI_GetVertexList(
+			part.session,
+			part.geo.info().nodeId,
+			part.id,
+			vertex_list.data(),
+			0,
+			part.info().vertexCount ) );
+	}
+}
+
+// what the osg arrays of a part are laid out by: element counts, how the part
+// is built, which attributes it has and how its faces are wired. A recook can
+// rewire the faces and keep every count, so the face lists are hashed too,
+// unless the caller trusts the counts and passes them empty
+static HashValue part_topology(const hapi::Part& part, const bool indexed, const bool pointArrays, const bool triangulate,
+	const vector<int>& face_counts, const vector<int>& vertex_list,
+	const vector<std::string>& point_attribs, const vector<std::string>& vertex_attribs,
+	const vector<std::string>& primitive_attribs)
+{
+	const HAPI_PartInfo& info = part.info();
+	int layout[7] = { info.type, info.faceCount, info.vertexCount, info.pointCount, indexed, pointArrays, triangulate };
+
+	HashValue h = hashBytes(layout, sizeof(layout));
+	h = hashArray(&face_counts, h);
+	h = hashArray(&vertex_list, h);
+	const vector<std::string>* owners[3] = { &point_attribs, &vertex_attribs, &primitive_attribs };
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < int(owners[i]->size()); ++j) {
+			const std::string& name = (*owners[i])[j];
+			h = hashBytes(name.c_str(), name.size() + 1, h);
+		}
+		h = hashBytes(&i, sizeof(i), h);
+	}
+
+	// 0 means no fingerprint
+	return h == 0 ? 1 : h;
+}
+
 // Temporary debugging visitor (TODO: move this somewhere else to use more
 // often?)
 class MyPrintVisitor: public osgUtil::PrintVisitor
@@ -90,8 +661,14 @@ class MyPrintVisitor: public osgUtil::PrintVisitor
 
 		void apply(osg::Drawable& draw) {
 			output()<<"  "<< draw.className() << "(" << draw.getName() <<")" << std::endl;
-			output()<<"    Verts:"<< draw.asGeometry()->getVertexArray()->getNumElements() << std::endl;
-			output()<<"    PrimSets:"<< draw.asGeometry()->getNumPrimitiveSets() << std::endl;
+			osg::Geometry* geom = draw.asGeometry();
+			InstancedDrawable* instancer = dynamic_cast<InstancedDrawable*>(&draw);
+			if (instancer != NULL) {
+				output()<<"    Instances:"<< instancer->getInstances().size() << std::endl;
+				geom = instancer->getSource();
+			}
+			output()<<"    Verts:"<< geom->getVertexArray()->getNumElements() << std::endl;
+			output()<<"    PrimSets:"<< geom->getNumPrimitiveSets() << std::endl;
 		}
 
     protected:
@@ -146,6 +723,7 @@ void HoudiniEngine::printGraph(const String& asset_name) {
 // put houdini engine asset data into a houdiniGeometry
 void HoudiniEngine::process_asset(const hapi::Asset &asset)
 {
+	HAPI_TRACE_SCOPE("process_asset");
 
 	String s = ostr("%1%", %asset.name());
 
@@ -160,7 +738,8 @@ void HoudiniEngine::process_asset(const hapi::Asset &asset)
 		myHoudiniGeometrys[s] = hg;
 	}
 
-    vector<hapi::Object> objects = asset.objects();
+	// both come from one composed object list, cached until the next cook
+	vector<hapi::Object> objects = asset.objects();
 	vector<HAPI_Transform> objTransforms = asset.transforms();
 
 	// ofmsg("process_assets: clear %1% materials", %assetMaterialParms[s].size());
@@ -168,58 +747,92 @@ void HoudiniEngine::process_asset(const hapi::Asset &asset)
 
 	hflog("[HoudiniEngine::process_asset] %1%: %2% objects %3% transforms", %asset.name() %objects.size() %objTransforms.size());
 
-	hg->objectsChanged = asset.info().haveObjectsChanged;
+	// HAPI's change flags are relative to the last cook, only trust them if
+	// hg holds what that cook produced
+	const bool full = !myIncrementalUpdates || !hg->hapiSynced;
+
+	hg->objectsChanged = full || asset.info().haveObjectsChanged;
 	hflog("[HoudiniEngine::process_asset] %1%: %2% objects %3%", %asset.name() %objects.size() %(hg->objectsChanged == 1 ? "Changed" : ""));
-	// forcing true for testing
-	// hg->objectsChanged = true;
-	// ofmsg("process_assets: %1%: %2% objects Forced Changed", %asset.name() %objects.size() );
 
-	// set number of objects in HoudiniGeometry to match
+	// set number of objects in HoudiniGeometry to match, new ones are
+	// processed in full
+	const int knownObjects = hg->getObjectCount();
 	if (hg->getObjectCount() < objects.size()) {
 		hg->addObject(objects.size() - hg->getObjectCount());
+	}
+
+	// slots go by index, a switch can put another object in a slot without
+	// changing the count
+	for (int i=0; i < objects.size(); i++) {
+		hg->setObjectName(i, objects[i].name());
+	}
+
+	// objects that went away (eg. a switch) must not stay on screen
+	for (int obj = objects.size(); obj < hg->getObjectCount(); ++obj) {
+		hg->clearObj(obj);
+		for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
+			hg->setGeoChanged(true, g, obj);
+		}
+	}
+
+	// parts read from HAPI, waiting to be converted
+	vector<PartJob> jobs;
+
+	// still need to traverse the objects even if haveObjectsChanged is off,
+	// as an object may not change, but geos in it can change
+	hflog("[HoudiniEngine::process_asset] iterating through %1% objects", %objects.size());
+	for (int object_index=0; object_index < int(objects.size()); ++object_index)
+	{
+		// when the object list changed a slot may hold another object now,
+		// whose geos don't report a change against what the slot shows
+		process_object(objects[object_index], object_index, hg, jobs,
+			hg->objectsChanged || object_index >= knownObjects);
+
+		// transforms are cheap to set, and hasTransformChanged isn't reliable
+		// enough to skip them (see commitSharedData), so always set them
+		osg::PositionAttitudeTransform* pat = hg->getOsgNode()->asGroup()->getChild(object_index)->
+			asTransform()->asPositionAttitudeTransform();
+		pat->setPosition(osg::Vec3d(
+			objTransforms[object_index].position[0],
+			objTransforms[object_index].position[1],
+			objTransforms[object_index].position[2]
+		));
+		pat->setAttitude(osg::Quat(
+			objTransforms[object_index].rotationQuaternion[0],
+			objTransforms[object_index].rotationQuaternion[1],
+			objTransforms[object_index].rotationQuaternion[2],
+			objTransforms[object_index].rotationQuaternion[3]
+		));
+		pat->setScale(osg::Vec3d(
+			objTransforms[object_index].scale[0],
+			objTransforms[object_index].scale[1],
+			objTransforms[object_index].scale[2]
+		));
+	}
 
-        for (int i=0; i < objects.size(); i++) {
-            hg->setObjectName(i, objects[i].name());
-        }
-	}
-
-	// if (hg->objectsChanged) {
-	// still need to traverse this, as an object may not change, but geos in it can change
-	if (true) {
-		hflog("[HoudiniEngine::process_asset] iterating through %1% objects", %objects.size());
-		for (int object_index=0; object_index < int(objects.size()); ++object_index)
-	    {
-			process_object(objects[object_index], object_index, hg);
-			// if (hg->getTransformChanged(object_index)) {
-			if (true) {
-				hg->getOsgNode()->asGroup()->getChild(object_index)->asTransform()->
-					asPositionAttitudeTransform()->setPosition(osg::Vec3d(
-						objTransforms[object_index].position[0],
-						objTransforms[object_index].position[1],
-						objTransforms[object_index].position[2]
-					)
-				);
-
-				hg->getOsgNode()->asGroup()->getChild(object_index)->asTransform()->
-					asPositionAttitudeTransform()->setAttitude(osg::Quat(
-						objTransforms[object_index].rotationQuaternion[0],
-						objTransforms[object_index].rotationQuaternion[1],
-						objTransforms[object_index].rotationQuaternion[2],
-						objTransforms[object_index].rotationQuaternion[3]
-					)
-				);
-
-				hg->getOsgNode()->asGroup()->getChild(object_index)->asTransform()->
-					asPositionAttitudeTransform()->setScale(osg::Vec3d(
-						objTransforms[object_index].scale[0],
-						objTransforms[object_index].scale[1],
-						objTransforms[object_index].scale[2]
-					)
-				);
+	// HAPI is done with, build the osg arrays of all parts in parallel and
+	// put them into the scene graph here on the main thread
+	convert_parts(jobs);
+	for (int i = 0; i < int(jobs.size()); ++i) {
+		apply_part(jobs[i], hg);
+	}
+
+	// rehash the drawables of rebuilt or cleared geos, including ones cleared
+	// but not refilled, so commitSharedData only sends the parts that
+	// changed. Skipped geos kept their arrays, and so their hashes
+	for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
+		for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
+			if (!hg->getGeoChanged(g, obj)) {
+				continue;
+			}
+			for (int d = 0; d < hg->getDrawableCount(g, obj); ++d) {
+				hg->updateHash(d, g, obj);
 			}
-	    }
+		}
 	}
 
+	hg->hapiSynced = true;
+
 	if (mySceneManager->getModel(s) == NULL) {
 		hflog("[HoudiniEngine::process_asset] %1% not in sceneManager, adding..", %s);
 		mySceneManager->addModel(hg);
@@ -230,11 +843,13 @@ void HoudiniEngine::process_asset(const hapi::Asset &asset)
 	}
 }
 
-void HoudiniEngine::process_object(const hapi::Object &object, const int objIndex, HoudiniGeometry* hg)
+void HoudiniEngine::process_object(const hapi::Object &object, const int objIndex, HoudiniGeometry* hg, vector<PartJob>& jobs, const bool full)
 {
-	HAPI_ObjectInfo objInfo = object.info();
+	HAPI_TRACE_SCOPE("process_object");
+	const HAPI_ObjectInfo& objInfo = object.info();
 
-	// TODO check for instancing, then do things differently
+	// object instancers (Instance OBJs) aren't drawn as instances, only
+	// packed primitive instancers are, see process_geo
 	if (objInfo.isInstancer > 0) {
 		hflog("[HoudiniEngine::process_object]   INSTANCE:  instance path: %1%: %2%", %object.name() %object.objectInstancePath());
 	}
@@ -242,7 +857,8 @@ void HoudiniEngine::process_object(const hapi::Object &object, const int objInde
 	// unless we are exposing editable nodes (not yet)
 	vector<hapi::Geo> geos = object.geos();
 
-	// adjust geo count
+	// adjust geo count, new ones are processed in full
+	const int knownGeos = hg->getGeodeCount(objIndex);
 	if (hg->getGeodeCount(objIndex) < geos.size()) {
 		hg->addGeode(geos.size() - hg->getGeodeCount(objIndex), objIndex);
 
@@ -251,7 +867,13 @@ void HoudiniEngine::process_object(const hapi::Object &object, const int objInde
 		}
 	}
 
-	hg->setGeosChanged(objInfo.haveGeosChanged, objIndex);
+	// geos that went away
+	for (int g = geos.size(); g < hg->getGeodeCount(objIndex); ++g) {
+		hg->clearGeode(g, objIndex);
+		hg->setGeoChanged(true, g, objIndex);
+	}
+
+	hg->setGeosChanged(full || objInfo.haveGeosChanged, objIndex);
 	hflog("[HoudiniEngine::process_object]   %1%/%2%: %3% %4%",
 		%(objIndex + 1)
 		%geos.size()
@@ -259,13 +881,16 @@ void HoudiniEngine::process_object(const hapi::Object &object, const int objInde
 		%(hg->getGeosChanged(objIndex) == 1 ? "Changed" : "")
 	);
 
-	// if (hg->getGeosChanged(objIndex)) {
-	if (true) {
-		hflog("[HoudiniEngine::process_object]   iterating through %1% geos", %geos.size());
-
-		for (int geo_index=0; geo_index < int(geos.size()); ++geo_index)
-		{
-			process_geo(geos[geo_index], objIndex, geo_index, hg);
+	hflog("[HoudiniEngine::process_object]   iterating through %1% geos", %geos.size());
+	for (int geo_index=0; geo_index < int(geos.size()); ++geo_index)
+	{
+		const bool geoFull = full || geo_index >= knownGeos;
+		if (hg->getGeosChanged(objIndex) || geoFull) {
+			process_geo(geos[geo_index], objIndex, geo_index, hg, jobs, geoFull);
+		} else {
+			// nothing to rebuild, only material parms may have changed
+			hg->setGeoChanged(false, geo_index, objIndex);
+			refresh_materials(geos[geo_index], hg);
 		}
 	}
 
@@ -274,15 +899,24 @@ void HoudiniEngine::process_object(const hapi::Object &object, const int objInde
 }
 
 
-void HoudiniEngine::process_geo(const hapi::Geo &geo, const int objIndex, const int geoIndex, HoudiniGeometry* hg)
+void HoudiniEngine::process_geo(const hapi::Geo &geo, const int objIndex, const int geoIndex, HoudiniGeometry* hg, vector<PartJob>& jobs, const bool full)
 {
+	HAPI_TRACE_SCOPE("process_geo");
+	hg->setGeoChanged(full || geo.info().hasGeoChanged, geoIndex, objIndex);
+
+	// unchanged geos keep their arrays, only material parms may have changed
+	if (!hg->getGeoChanged(geoIndex, objIndex)) {
+		hflog("[HoudiniEngine::process_geo]     %1%:%2% unchanged", %(objIndex + 1) %(geoIndex + 1));
+		refresh_materials(geo, hg);
+		return;
+	}
+
 	vector<hapi::Part> parts = geo.parts();
 
 	if (hg->getDrawableCount(geoIndex, objIndex) < parts.size()) {
 		hg->addDrawable(parts.size() - hg->getDrawableCount(geoIndex, objIndex), geoIndex, objIndex);
 	}
 
-	hg->setGeoChanged(geo.info().hasGeoChanged, geoIndex, objIndex);
 	hflog("[HoudiniEngine::process_geo]     %1%:%2%/%3% %4% %5% %6%",
 		%(objIndex + 1)
 		%(geoIndex + 1)
@@ -292,61 +926,170 @@ void HoudiniEngine::process_geo(const hapi::Geo &geo, const int objIndex, const
 		%(geo.info().isTemplated == 1 ? "Template" : "-")
 	);
 
-	hg->clearGeode(geoIndex, objIndex);
-	// if (hg->getGeoChanged(geoIndex, objIndex)) {
-	if (true) {
-		hflog("[HoudiniEngine::process_geo] iterating through %1% parts", %parts.size());
-		for (int part_index=0; part_index < int(parts.size()); ++part_index)
-		{
-			if (geo.info().isDisplayGeo) {
-				hflog("[HoudiniEngine::process_geo]     processing %1%", %parts[part_index].name());
+	// the parts keep their arrays until process_part has looked at them, as
+	// they may only need new values. Parts that went away and templated
+	// geos end up empty
+	if (!geo.info().isDisplayGeo) {
+		hg->clearGeode(geoIndex, objIndex);
+	}
+	for (int d = int(parts.size()); d < hg->getDrawableCount(geoIndex, objIndex); ++d) {
+		hg->clearDrawable(d, geoIndex, objIndex);
+	}
+
+	if (geo.info().isDisplayGeo) {
+		process_instancers(geo, parts, objIndex, geoIndex, hg);
+	}
+
+	hflog("[HoudiniEngine::process_geo] iterating through %1% parts", %parts.size());
+	for (int part_index=0; part_index < int(parts.size()); ++part_index)
+	{
+		if (geo.info().isDisplayGeo) {
+			hflog("[HoudiniEngine::process_geo]     processing %1%", %parts[part_index].name());
+
+			// read each part, process_asset converts them once all are in
+			process_part(parts[part_index], objIndex, geoIndex, part_index, hg, jobs);
+		}
+	}
+}
+
+// packed primitive instancers (HAPI_PACKEDPRIM_INSTANCING_MODE_FLAT) list
+// the parts of their geo they instance, and the transforms of the instances.
+// The instanced parts are built like any other, then drawn once per
+// transform. The instancer parts themselves have nothing to draw
+void HoudiniEngine::process_instancers(const hapi::Geo &geo, const vector<hapi::Part>& parts, const int objIndex, const int geoIndex, HoudiniGeometry* hg)
+{
+	vector< vector<osg::Matrixf> > instances(parts.size());
+	vector<bool> instanced(parts.size(), false);
+
+	for (int part_index=0; part_index < int(parts.size()); ++part_index)
+	{
+		const HAPI_PartInfo& info = parts[part_index].info();
 
-				// update the geometry and materials in each part
-				process_part(parts[part_index], objIndex, geoIndex, part_index, hg);
+		// instanced parts without an instancer stay hidden
+		if (info.isInstanced) {
+			instanced[part_index] = true;
+		}
+
+		if (info.type != HAPI_PARTTYPE_INSTANCER || info.instancedPartCount <= 0 || info.instanceCount <= 0) {
+			continue;
+		}
+
+		vector<HAPI_PartId> partIds(info.instancedPartCount);
+		ENSURE_SUCCESS_BYTES(geo.session, partIds.size() * sizeof(HAPI_PartId), HAPI_GetInstancedPartIds(
+			geo.session,
+			geo.info().nodeId,
+			parts[part_index].id,
+			&partIds[0],
+			0,
+			info.instancedPartCount
+		) );
+
+		vector<HAPI_Transform> transforms(info.instanceCount);
+		ENSURE_SUCCESS_BYTES(geo.session, transforms.size() * sizeof(HAPI_Transform), HAPI_GetInstancerPartTransforms(
+			geo.session,
+			geo.info().nodeId,
+			parts[part_index].id,
+			HAPI_SRT,
+			&transforms[0],
+			0,
+			info.instanceCount
+		) );
+
+		hflog("[HoudiniEngine::process_instancers]     %1%: %2% parts, %3% instances",
+			%parts[part_index].name() %info.instancedPartCount %info.instanceCount);
+
+		vector<osg::Matrixf> matrices(transforms.size());
+		for (int i = 0; i < int(transforms.size()); ++i) {
+			const HAPI_Transform& t = transforms[i];
+			matrices[i] = osg::Matrixf::scale(t.scale[0], t.scale[1], t.scale[2]) *
+				osg::Matrixf::rotate(osg::Quat(
+					t.rotationQuaternion[0],
+					t.rotationQuaternion[1],
+					t.rotationQuaternion[2],
+					t.rotationQuaternion[3])) *
+				osg::Matrixf::translate(t.position[0], t.position[1], t.position[2]);
+		}
+
+		for (int i = 0; i < int(partIds.size()); ++i) {
+			int id = partIds[i];
+			if (id < 0 || id >= int(parts.size())) {
+				continue;
 			}
+			instanced[id] = true;
+			instances[id].insert(instances[id].end(), matrices.begin(), matrices.end());
+		}
+	}
+
+	for (int part_index=0; part_index < int(parts.size()); ++part_index)
+	{
+		if (instanced[part_index]) {
+			hg->setInstances(instances[part_index], part_index, geoIndex, objIndex);
+		} else {
+			hg->clearInstances(part_index, geoIndex, objIndex);
 		}
 	}
 }
 
-// TODO: expand on this.. (to do with curve rendering)
-Vector3f bez(float t, Vector3f a, Vector3f b) {
-	return Vector3f(
-		a[0] + t *(b[0] - a[0]),
-		a[1] + t *(b[1] - a[1]),
-		a[2] + t *(b[2] - a[2])
-	);
+// material parms can change without the geometry changing, so parts that are
+// skipped still have their materials looked at
+void HoudiniEngine::refresh_materials(const hapi::Geo &geo, HoudiniGeometry* hg)
+{
+	if (!geo.info().isDisplayGeo) {
+		return;
+	}
+
+	vector<hapi::Part> parts = geo.parts();
+	for (int part_index=0; part_index < int(parts.size()); ++part_index)
+	{
+		// same test as apply_part, only meshes with faces have materials
+		const HAPI_PartInfo& info = parts[part_index].info();
+		if (info.type == HAPI_PARTTYPE_MESH && info.faceCount > 0) {
+			process_materials(parts[part_index], hg);
+		}
+	}
 }
 
 // TODO: incrementally update the geometry?
 // send a new version, and still have the old version?
 //     write it out to a file based on a hash of parameters
-void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, const int geoIndex, const int partIndex, HoudiniGeometry* hg)
+void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, const int geoIndex, const int partIndex, HoudiniGeometry* hg, vector<PartJob>& jobs)
 {
+	HAPI_TRACE_SCOPE("process_part");
 	hflog("[HoudiniEngine::process_part] processing %1%", %part.name());
+
+	// all the HAPI reads for this part happen here, on the main thread. The
+	// osg arrays are built from them later by convert_part
+	jobs.push_back(PartJob(part, objIndex, geoIndex, partIndex, myIndexedGeometry));
+	PartJob& job = jobs.back();
+	job.triangulate = myTriangulateGeometry;
+
 	// TODO: is there a better way to convert from Vector3f to osg::Vec3?
 	// Vector3f is from the Eigen lib
 	// Vec3Array is from osg
-	vector<Vector3f> points;
-	vector<Vector3f> normals;
-	vector<Vector3f> colors;
-	vector<float> alphas;
+	vector<Vector3f>& points = job.points;
+	vector<Vector3f>& normals = job.normals;
+	vector<Vector3f>& colors = job.colors;
+	vector<float>& alphas = job.alphas;
 
 	vector<float> ppx;
 	vector<float> ppy;
 	vector<float> ppz;
 	vector<int> object_ids;
 	// texture coordinates
-	vector<Vector3f> uvs;
+	vector<Vector3f>& uvs = job.uvs;
 
-	bool has_point_normals = false;
-	bool has_vertex_normals = false;
-	bool has_point_colors = false;
-	bool has_point_alphas = false;
+	vector<int>& face_counts = job.face_counts;
+	vector<int>& vertex_list = job.vertex_list;
+
+	bool& has_point_normals = job.has_point_normals;
+	bool& has_vertex_normals = job.has_vertex_normals;
+	bool& has_point_colors = job.has_point_colors;
+	bool& has_point_alphas = job.has_point_alphas;
 	bool has_vertex_colors = false;
-	bool has_primitive_colors = false;
+	bool& has_primitive_colors = job.has_primitive_colors;
 
-	bool has_point_uvs = false;
-	bool has_vertex_uvs = false;
+	bool& has_point_uvs = job.has_point_uvs;
+	bool& has_vertex_uvs = job.has_vertex_uvs;
 
 	bool has_pivotpoint_x = false;
 	bool has_pivotpoint_y = false;
@@ -390,8 +1133,81 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 	// HAPI_ATTRIBUTE_TYPE_TEXTURE 	
 	// HAPI_ATTRIBUTE_TYPE_MAX
 
-    vector<std::string> point_attrib_names = part.attribNames(
-	HAPI_ATTROWNER_POINT);
+	// one string batch for all the names
+	vector<std::string> attrib_names[HAPI_ATTROWNER_MAX];
+	part.allAttribNames(attrib_names);
+	const vector<std::string>& point_attrib_names = attrib_names[HAPI_ATTROWNER_POINT];
+	const vector<std::string>& vertex_attrib_names = attrib_names[HAPI_ATTROWNER_VERTEX];
+	const vector<std::string>& primitive_attrib_names = attrib_names[HAPI_ATTROWNER_PRIM];
+	const vector<std::string>& detail_attrib_names = attrib_names[HAPI_ATTROWNER_DETAIL];
+
+	// vertex normals, vertex uvs and primitive colours can differ between
+	// the corners of a point
+	bool splitCorners = has_attrib(vertex_attrib_names, "N") ||
+		has_attrib(vertex_attrib_names, "uv") ||
+		has_attrib(primitive_attrib_names, "Cd");
+
+	// when every osg vertex is a point (point clouds, indexed meshes that
+	// don't split corners) the point attributes are read by HAPI straight
+	// into the part arrays, without the Vector3f copies
+	bool pointArrays = part.info().type == HAPI_PARTTYPE_MESH &&
+		(part.info().faceCount == 0 || (myIndexedGeometry && !splitCorners));
+	job.pointArrays = pointArrays;
+
+	// parts built per point, or per corner without primitive colours, can be
+	// updated in place when their layout is the same as last time: the new
+	// values go into the part's own arrays and the primitive sets stay
+	if (job.isMesh && (pointArrays || (!job.indexed && !has_attrib(primitive_attrib_names, "Cd")))) {
+		// read here rather than below, the mesh branch keeps them. Trusted,
+		// the counts and attribute names stand in for the wiring and the
+		// face lists are only read for a rebuild
+		if (!myTrustPartTopology) {
+			read_faces(part, face_counts, vertex_list);
+		}
+		job.arrays.topology = part_topology(part, job.indexed, pointArrays, job.triangulate,
+			face_counts, vertex_list, point_attrib_names, vertex_attrib_names, primitive_attrib_names);
+	}
+	job.inPlace = myTopologyFastPath && job.arrays.topology != 0 &&
+		hg->getTopology(partIndex, geoIndex, objIndex) == job.arrays.topology;
+
+	if (job.inPlace) {
+		hflog("[HoudiniEngine::process_part]     topology unchanged, updating %1% in place", %part.name());
+		job.arrays.vertices = hg->getVertexArray(partIndex, geoIndex, objIndex);
+		job.arrays.normals = hg->getNormalArray(partIndex, geoIndex, objIndex);
+		job.arrays.colors = hg->getColorArray(partIndex, geoIndex, objIndex);
+		job.arrays.uvs = hg->getUVArray(partIndex, geoIndex, objIndex);
+		job.sourcePoints = &hg->getSourcePoints(partIndex, geoIndex, objIndex);
+		job.sourceCorners = &hg->getSourceCorners(partIndex, geoIndex, objIndex);
+	}
+
+	if (pointArrays && part.info().pointCount > 0) {
+		int pointCount = part.info().pointCount;
+
+		osg::Vec3Array* v = job.arrays.vertices;
+		v->resize(pointCount);
+		if (has_attrib(point_attrib_names, "P")) {
+			process_float_attrib(part, HAPI_ATTROWNER_POINT, "P", v->front().ptr(), 3);
+		}
+		if (has_attrib(point_attrib_names, "N")) {
+			osg::Vec3Array* n = job.arrays.getOrCreateNormals();
+			n->resize(pointCount);
+			process_float_attrib(part, HAPI_ATTROWNER_POINT, "N", n->front().ptr(), 3);
+		}
+		if (has_attrib(point_attrib_names, "Cd")) {
+			// Cd fills rgb, Alpha (if any) lands in the fourth component
+			osg::Vec4Array* c = job.arrays.getOrCreateColors();
+			c->resize(pointCount, osg::Vec4(0, 0, 0, 1));
+			process_float_attrib(part, HAPI_ATTROWNER_POINT, "Cd", c->front().ptr(), 4);
+			if (has_attrib(point_attrib_names, "Alpha")) {
+				process_float_attrib(part, HAPI_ATTROWNER_POINT, "Alpha", c->front().ptr() + 3, 4);
+			}
+		}
+		if (has_attrib(point_attrib_names, "uv")) {
+			osg::Vec3Array* uv = job.arrays.getOrCreateUVs();
+			uv->resize(pointCount);
+			process_float_attrib(part, HAPI_ATTROWNER_POINT, "uv", uv->front().ptr(), 3);
+		}
+	}
 
 	hlog("[HoudiniEngine::process_part]     Attributes");
 	ologaddnewline(false);
@@ -403,24 +1219,33 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 
 		hflog("%1% ", %point_attrib_names[attrib_index]);
 
-		if (point_attrib_names[attrib_index] == "P") {
+		// already in the part arrays if pointArrays
+		if (point_attrib_names[attrib_index] == "P" && !pointArrays) {
 		    process_float_attrib(part, HAPI_ATTROWNER_POINT, "P", points);
 		}
 		if (point_attrib_names[attrib_index] == "N") {
 			has_point_normals = true;
-		    process_float_attrib(part, HAPI_ATTROWNER_POINT, "N", normals);
+			if (!pointArrays) {
+			    process_float_attrib(part, HAPI_ATTROWNER_POINT, "N", normals);
+			}
 		}
 		if (point_attrib_names[attrib_index] == "Cd") {
 			has_point_colors = true;
-		    process_float_attrib(part, HAPI_ATTROWNER_POINT, "Cd", colors);
+			if (!pointArrays) {
+			    process_float_attrib(part, HAPI_ATTROWNER_POINT, "Cd", colors);
+			}
 		}
 		if (point_attrib_names[attrib_index] == "Alpha") {
 			has_point_alphas = true;
-		    process_attrib(part, HAPI_ATTROWNER_POINT, "Alpha", alphas);
+			if (!pointArrays) {
+			    process_attrib(part, HAPI_ATTROWNER_POINT, "Alpha", alphas);
+			}
 		}
 		if (point_attrib_names[attrib_index] == "uv") {
 			has_point_uvs = true;
-		    process_float_attrib(part, HAPI_ATTROWNER_POINT, "uv", uvs);
+			if (!pointArrays) {
+			    process_float_attrib(part, HAPI_ATTROWNER_POINT, "uv", uvs);
+			}
 		}
 
 		// TODO: add support for automatic camera-facing of elements
@@ -455,9 +1280,6 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 
 	hlog("\n");
 
-    vector<std::string> vertex_attrib_names = part.attribNames(
-	HAPI_ATTROWNER_VERTEX);
-
 	hlog("[HoudiniEngine::process_part]     Vert:   ");
 
 	for (int attrib_index=0; attrib_index < int(vertex_attrib_names.size());
@@ -477,9 +1299,6 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 
  	hlog("\n");
 
-   vector<std::string> primitive_attrib_names = part.attribNames(
-	HAPI_ATTROWNER_PRIM);
-
 	hlog("[HoudiniEngine::process_part]     Prim:   ");
 
 	for (int attrib_index=0; attrib_index < int(primitive_attrib_names.size());
@@ -495,9 +1314,6 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 
 	hlog("\n");
 
-    vector<std::string> detail_attrib_names = part.attribNames(
-	HAPI_ATTROWNER_DETAIL);
-
 	hlog("[HoudiniEngine::process_part]     Detail: ");
 
 	for (int attrib_index=0; attrib_index < int(detail_attrib_names.size());
@@ -520,151 +1336,78 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 	// HAPI_PARTTYPE_SPHERE
 	// HAPI_PARTTYPE_MAX
 
+	// its instances are set up by process_instancers
 	if (part.info().type == HAPI_PARTTYPE_INSTANCER) {
-		hlog("[HoudiniEngine::process_part]     Instancer (TODO)");
+		hflog("[HoudiniEngine::process_part]     Instancer (%1% instances)", %part.info().instanceCount);
 	}
 
-	// TODO: render curves
+	// the cvs are in points, convert_part tessellates the curves
 	if (part.info().type == HAPI_PARTTYPE_CURVE) {
- 		hlog("[HoudiniEngine::process_part]     Curve: (TODO)");
-#if 0
- 		ofmsg ("process_asset:     Curve: %1% %2%", %part.name() %part.id);
-
-		HAPI_CurveInfo curve_info;
-		ENSURE_SUCCESS(session, HAPI_GetCurveInfo(
-			session,
+		HAPI_CurveInfo& curve_info = job.curveInfo;
+		ENSURE_SUCCESS(part.session, HAPI_GetCurveInfo(
+			part.session,
 			part.geo.info().nodeId,
-	        part.id,
+			part.id,
 			&curve_info
 		) );
 
-		if ( curve_info.curveType == HAPI_CURVETYPE_LINEAR )
-			omsg("curve mesh type = Linear");
-		else if ( curve_info.curveType == HAPI_CURVETYPE_BEZIER )
-			omsg("curve mesh type = Bezier");
-		else if ( curve_info.curveType == HAPI_CURVETYPE_NURBS )
-			omsg("curve mesh type = Nurbs");
-		else
-			omsg("curve mesh type = Unknown");
-
-		ofmsg("curve count: %1%", %curve_info.curveCount);
-		int vertex_offset = 0;
-		int knot_offset = 0;
-		int segments = 20;
-
-		for ( int i = 0; i < curve_info.curveCount; i++ ) {
-			ofmsg("curve %1% of %2%", %(i + 1) %curve_info.curveCount);
-			// Number of CVs
-			int num_vertices;
-			HAPI_GetCurveCounts(
-				session,
-				part.geo.info().nodeId,
-		        part.id,
-				&num_vertices,
-				i,
-				1
-			);
-			ofmsg("num vertices: %1%", %num_vertices);
-			// Order of this particular curve
-			int order;
-			if ( curve_info.order != HAPI_CURVE_ORDER_VARYING
-				&& curve_info.order != HAPI_CURVE_ORDER_INVALID )
-				order = curve_info.order;
-			else
-				HAPI_GetCurveOrders(
-					session,
-					part.geo.info().nodeId,
-			        part.id,
-					&order,
-					i,
-					1
-				);
-			ofmsg("curve order: %1%", %order);
-			// If there's not enough vertices, then don't try to
-			// create the curve.
-			if ( num_vertices < order )
-			{
-				ofmsg("not enought vertices on curve %1% of %2%: skipping",
-					%i
-					%curve_info.curveCount);
-				// The curve at i will have numVertices vertices, and may have
-				// some knots. The knot count will be numVertices + order for
-				// nurbs curves.
-				vertex_offset += num_vertices * 4;
-				knot_offset += num_vertices + order;
-				continue;
-			}
-
-			ofmsg("points size: %1%", %points.size());
-			ofmsg("vert size: %1%", %num_vertices);
-
-			// draw the curve
-			// TODO: add bezier function, segmentalise curves
-			hg->addPrimitiveOsg(
-				osg::PrimitiveSet::LINE_STRIP,
-				vertex_offset * segments,
-				(vertex_offset + num_vertices) * segments - 1,
-				partIndex,
-				geoIndex,
-				objIndex
-			);
+		hflog("[HoudiniEngine::process_part]     Curve: %1% %2% curves, %3% cvs, %4% knots",
+			%(curve_info.curveType == HAPI_CURVETYPE_LINEAR ? "Linear" :
+				curve_info.curveType == HAPI_CURVETYPE_BEZIER ? "Bezier" :
+				curve_info.curveType == HAPI_CURVETYPE_NURBS ? "Nurbs" : "Unknown")
+			%curve_info.curveCount
+			%curve_info.vertexCount
+			%curve_info.knotCount
+		);
 
-			for (int j = 0; j < num_vertices - 1; ++j) {
-				for (int seg = 0; seg < segments; ++seg) {
-
-					Vector3f p = bez(
-						(float) seg / segments,
-						points[vertex_offset + j],
-					    points[vertex_offset + j + 1]
-					);
-
-					hg->addVertex(p, partIndex, geoIndex, objIndex);
-					ofmsg("%1%", %p);
-					if(has_point_colors) {
-						hg->addColor(Color(
-							colors[vertex_offset + j][0],
-							colors[vertex_offset + j][1],
-							colors[vertex_offset + j][2],
-							1.0
-						), partIndex, geoIndex, objIndex);
-					} else if (has_primitive_colors) {
-						hg->addColor(Color(
-							colors[i][0],
-							colors[i][1],
-							colors[i][2],
-							1.0
-						), partIndex, geoIndex, objIndex);
-					}
-				}
-			}
+		job.isCurve = true;
+		job.curveTolerance = myCurveTolerance;
 
-			vertex_offset += num_vertices;
+		const int curveCount = curve_info.curveCount;
+		if (curveCount <= 0) {
+			return;
+		}
 
-			omsg("done this curve");
+		// counts, orders and knots of all curves at once
+		job.curve_counts.resize(curveCount);
+		ENSURE_SUCCESS_BYTES(part.session, curveCount * sizeof(int), HAPI_GetCurveCounts(
+			part.session,
+			part.geo.info().nodeId,
+			part.id,
+			&job.curve_counts[0],
+			0,
+			curveCount
+		) );
 
-			// if (curve_info.hasKnots) {
-			// 	std::vector< float > knots;
-			// 	knots.resize( num_vertices + order );
-			// 	HAPI_GetCurveKnots(
-			// 		session,
-			// 		part.geo.info().nodeId,
-			// 		part.geo.object.id,
-			// 		part.geo.id,
-			//         part.id,
-			// 		&knots.front(),
-			// 		knot_offset,
-			// 		num_vertices + order
+		job.curve_orders.assign(curveCount, curve_info.order);
+		if (curve_info.order == HAPI_CURVE_ORDER_VARYING || curve_info.order == HAPI_CURVE_ORDER_INVALID) {
+			ENSURE_SUCCESS_BYTES(part.session, curveCount * sizeof(int), HAPI_GetCurveOrders(
+				part.session,
+				part.geo.info().nodeId,
+				part.id,
+				&job.curve_orders[0],
+				0,
+				curveCount
+			) );
+		}
 
-			// 	);
-			// 	for( int j = 0; j < num_vertices + order; j++ ) {
-			// 		cout << "knot " << j << ": " << knots[ j ] << endl;
-			// 	}
-			// }
+		if (curve_info.hasKnots && curve_info.knotCount > 0) {
+			job.curve_knots.resize(curve_info.knotCount);
+			ENSURE_SUCCESS_BYTES(part.session, curve_info.knotCount * sizeof(float), HAPI_GetCurveKnots(
+				part.session,
+				part.geo.info().nodeId,
+				part.id,
+				&job.curve_knots[0],
+				0,
+				curve_info.knotCount
+			) );
+		}
 
+		if (curve_info.isRational && has_attrib(point_attrib_names, "Pw")) {
+			process_attrib(part, HAPI_ATTROWNER_POINT, "Pw", job.weights);
 		}
-		hg->dirty();
+
 		return;
-#endif
 	}
 
 	if (part.info().type == HAPI_PARTTYPE_MESH) {
@@ -674,44 +1417,259 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 			%part.info().vertexCount
 		);
 
-		// no faces..
+		// no faces, the point arrays are all there is. convert_part draws
+		// them as points
 		if (part.info().faceCount == 0) {
-			// but has points, so draw them?
-			if (part.info().pointCount > 0) {
-				// TODO: is there a better way to do this?
-				foreach(Vector3f point, points) {
-					hg->addVertex(point, partIndex, geoIndex, objIndex);
+			return;
+		}
+
+		// convert_part goes through the saved source lists instead
+		if (job.inPlace) {
+			return;
+		}
+
+		// unless the topology check read them already
+		if (face_counts.empty()) {
+			read_faces(part, face_counts, vertex_list);
+		}
+	}
+
+	if (part.info().type == HAPI_PARTTYPE_VOLUME) {
+		hlog("[HoudiniEngine::process_part]     Volume (TODO)");
+	}
+
+	// todo: check out some geometry shaders for this..
+	if (part.info().type == HAPI_PARTTYPE_BOX) {
+		hlog("[HoudiniEngine::process_part]     Box (TODO)");
+	}
+	// todo: check out some geometry shaders for this..
+	if (part.info().type == HAPI_PARTTYPE_SPHERE) {
+		hlog("[HoudiniEngine::process_part]     Sphere (TODO)");
+	}
+
+}
+
+// build the osg arrays and primitive sets of a part from what process_part
+// read. Touches neither HAPI nor the scene graph, so parts can be converted
+// in parallel
+void HoudiniEngine::convert_part(PartJob& job)
+{
+	HAPI_TRACE_SCOPE("convert_part");
+	PartArrays& arrays = job.arrays;
+
+	const vector<Vector3f>& points = job.points;
+	const vector<Vector3f>& normals = job.normals;
+	const vector<Vector3f>& colors = job.colors;
+	const vector<float>& alphas = job.alphas;
+	const vector<Vector3f>& uvs = job.uvs;
+	const vector<int>& face_counts = job.face_counts;
+	const vector<int>& vertex_list = job.vertex_list;
+
+	bool has_point_normals = job.has_point_normals;
+	bool has_vertex_normals = job.has_vertex_normals;
+	bool has_point_colors = job.has_point_colors;
+	bool has_point_alphas = job.has_point_alphas;
+	bool has_primitive_colors = job.has_primitive_colors;
+	bool has_point_uvs = job.has_point_uvs;
+	bool has_vertex_uvs = job.has_vertex_uvs;
+	bool pointArrays = job.pointArrays;
+
+	if (job.isCurve) {
+		tessellate_curves(job);
+		return;
+	}
+
+	if (!job.isMesh) {
+		return;
+	}
+
+	if (job.inPlace) {
+		// per point arrays already hold the new values
+		if (pointArrays) {
+			return;
+		}
+
+		const vector<int>& sourcePoints = *job.sourcePoints;
+		const vector<int>& sourceCorners = *job.sourceCorners;
+		for (int i = 0; i < int(sourcePoints.size()); ++i) {
+			int point = sourcePoints[i];
+			int corner = sourceCorners[i];
+
+			const Vector3f& p = points[point];
+			(*arrays.vertices)[i].set(p[0], p[1], p[2]);
+			if (has_point_normals || has_vertex_normals) {
+				const Vector3f& n = normals[has_point_normals ? point : corner];
+				(*arrays.normals)[i].set(n[0], n[1], n[2]);
+			}
+			if (has_point_colors) {
+				const Vector3f& c = colors[point];
+				(*arrays.colors)[i].set(c[0], c[1], c[2], has_point_alphas ? alphas[point] : 1.0);
+			}
+			if (has_point_uvs || has_vertex_uvs) {
+				const Vector3f& uv = uvs[has_point_uvs ? point : corner];
+				(*arrays.uvs)[i].set(uv[0], uv[1], uv[2]);
+			}
+		}
+		return;
+	}
+
+	int faceCount = int(face_counts.size());
+
+	// no faces..
+	if (faceCount == 0) {
+		// but has points, so draw them
+		if (arrays.vertices->size() > 0) {
+			arrays.addPrimitiveOsg(osg::PrimitiveSet::POINTS, 0, arrays.vertices->size());
+
+			// TODO: add a point sprite shader?
+		}
+		return;
+	}
+
+	int curr_index = 0;
+
+	if (job.indexed) {
+		// one osg vertex per point, shared by all the corners using it
+		// (pointArrays). If corners can differ they are welded on their
+		// attribute values instead and only split where they really differ
+		bool hasNormals = has_point_normals || has_vertex_normals;
+		bool hasColors = has_point_colors || has_primitive_colors;
+		bool hasUVs = has_point_uvs || has_vertex_uvs;
+
+		std::map<CornerKey, int> cornerVertex;
+
+		// an element set per face size, polygons go in as triangle fans
+		osg::DrawElementsUInt* pointElements = NULL;
+		osg::DrawElementsUInt* lineElements = NULL;
+		osg::DrawElementsUInt* triElements = NULL;
+		osg::DrawElementsUInt* quadElements = NULL;
+
+		std::vector<unsigned int> face;
+
+		for (int ii = 0; ii < faceCount; ii++) {
+			face.resize(face_counts[ii]);
+
+			for (int jj = 0; jj < face_counts[ii]; jj++) {
+				// same winding as the de-indexed path
+				int myIndex = curr_index + (face_counts[ii] - jj) % face_counts[ii];
+				int point = vertex_list[myIndex];
+
+				if (pointArrays) {
+					face[jj] = point;
+					continue;
+				}
+
+				Vector3f n = Vector3f::Zero();
+				Vector3f uv = Vector3f::Zero();
+				Color c(0, 0, 0, 0);
+				if (hasNormals) {
+					n = normals[has_point_normals ? point : myIndex];
+				}
+				if (has_point_colors) {
+					c = Color(colors[point][0], colors[point][1], colors[point][2],
+						has_point_alphas ? alphas[point] : 1.0);
+				} else if (has_primitive_colors) {
+					c = Color(colors[ii][0], colors[ii][1], colors[ii][2],
+						has_point_alphas ? alphas[point] : 1.0);
+				}
+				if (hasUVs) {
+					uv = uvs[has_point_uvs ? point : myIndex];
+				}
+
+				int v = -1;
+				CornerKey key;
+				memset(&key, 0, sizeof(key));
+				key.point = point;
+				for (int k = 0; k < 3; ++k) {
+					key.normal[k] = n[k];
+					key.uv[k] = uv[k];
+				}
+				key.color[0] = c[0];
+				key.color[1] = c[1];
+				key.color[2] = c[2];
+				key.color[3] = c[3];
+
+				std::map<CornerKey, int>::iterator it = cornerVertex.find(key);
+				if (it != cornerVertex.end()) {
+					v = it->second;
 				}
-				osg::PrimitiveSet::Mode myType = osg::PrimitiveSet::POINTS;
-				hg->addPrimitiveOsg(myType, 0, part.info().pointCount - 1, partIndex, geoIndex, objIndex);
 
-				// TODO: add a point sprite shader?
+				if (v < 0) {
+					v = arrays.addVertex(points[point]);
+					if (hasNormals) {
+						arrays.addNormal(n);
+					}
+					if (hasColors) {
+						arrays.addColor(c);
+					}
+					if (hasUVs) {
+						arrays.addUV(uv);
+					}
+					cornerVertex[key] = v;
+				}
+
+				face[jj] = v;
 			}
-			
-			hg->dirty();
-			return;
+
+			add_face(arrays, &face[0], face_counts[ii], !job.triangulate,
+				pointElements, lineElements, triElements, quadElements);
+
+			curr_index += face_counts[ii];
 		}
 
-		std::vector< int > face_counts ( part.info().faceCount );
-		ENSURE_SUCCESS(session,  HAPI_GetFaceCounts(
-			session,
-			part.geo.info().nodeId,
-			part.id,
-			face_counts.data(),
-			0,
-			part.info().faceCount
-		) );
+		if (job.triangulate && triElements != NULL) {
+			optimize_vertex_cache(&(*triElements)[0], triElements->size(), arrays.vertices->size());
+		}
+	} else if (job.triangulate) {
+		// every corner its own vertex as below, but indexed by a single
+		// triangle list (plus points and lines) instead of a run per face size
+		osg::DrawElementsUInt* pointElements = NULL;
+		osg::DrawElementsUInt* lineElements = NULL;
+		osg::DrawElementsUInt* triElements = NULL;
+		osg::DrawElementsUInt* quadElements = NULL;
 
-		std::vector< int > vertex_list ( part.info().vertexCount );
-		ENSURE_SUCCESS(session,  HAPI_GetVertexList(
-			session,
-			part.geo.info().nodeId,
-			part.id,
-			vertex_list.data(), 
-			0, 
-			part.info().vertexCount ) );
-		int curr_index = 0;
+		std::vector<unsigned int> face;
+
+		for (int ii = 0; ii < faceCount; ii++) {
+			face.resize(face_counts[ii]);
+
+			for (int jj = 0; jj < face_counts[ii]; jj++) {
+				int myIndex = curr_index + (face_counts[ii] - jj) % face_counts[ii];
+				int point = vertex_list[myIndex];
+
+				face[jj] = arrays.addVertex(points[point]);
+				if (arrays.topology != 0) {
+					arrays.sourcePoints.push_back(point);
+					arrays.sourceCorners.push_back(myIndex);
+				}
+
+				if (has_point_normals) {
+					arrays.addNormal(normals[point]);
+				} else if (has_vertex_normals) {
+					arrays.addNormal(normals[myIndex]);
+				}
+				if (has_point_colors) {
+					arrays.addColor(Color(colors[point][0], colors[point][1], colors[point][2],
+						has_point_alphas ? alphas[point] : 1.0));
+				} else if (has_primitive_colors) {
+					arrays.addColor(Color(colors[ii][0], colors[ii][1], colors[ii][2],
+						has_point_alphas ? alphas[point] : 1.0));
+				}
+				if (has_point_uvs) {
+					arrays.addUV(uvs[point]);
+				} else if (has_vertex_uvs) {
+					arrays.addUV(uvs[myIndex]);
+				}
+			}
 
+			add_face(arrays, &face[0], face_counts[ii], false,
+				pointElements, lineElements, triElements, quadElements);
+
+			curr_index += face_counts[ii];
+		}
+		// no optimize_vertex_cache here: with a vertex per corner there is
+		// next to no reuse for it to order for
+	} else {
 		int prev_faceCount = face_counts[0];
 		int prev_faceCountIndex = 0;
 
@@ -728,7 +1686,7 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 		// objects with primitives of different side count > 4 don't get rendered well. get around this
 		// by triangulating meshes on houdini engine side.
 
-		for( int ii=0; ii < part.info().faceCount; ii++ )
+		for( int ii=0; ii < faceCount; ii++ )
 		{
 
 			// add primitive group if face count is different from previous
@@ -746,7 +1704,7 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 				// 	prev_faceCountIndex << " plus " <<
 				// 	curr_index - prev_faceCountIndex << endl;
 
-				hg->addPrimitiveOsg(myType, prev_faceCountIndex, curr_index - prev_faceCountIndex, partIndex, geoIndex, objIndex);
+				arrays.addPrimitiveOsg(myType, prev_faceCountIndex, curr_index - prev_faceCountIndex);
 
 				prev_faceCountIndex = curr_index;
 				prev_faceCount = face_counts[ii];
@@ -754,9 +1712,9 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 				// cout << "making primitive set for " << prev_faceCount << ", plus " <<
 				// 	prev_faceCountIndex << " to " <<
 				// 	curr_index - prev_faceCountIndex << endl;
-				hg->addPrimitiveOsg(osg::PrimitiveSet::TRIANGLE_FAN,
+				arrays.addPrimitiveOsg(osg::PrimitiveSet::TRIANGLE_FAN,
 					prev_faceCountIndex,
-					curr_index - prev_faceCountIndex, partIndex, geoIndex, objIndex);
+					curr_index - prev_faceCountIndex);
 
 				prev_faceCountIndex = curr_index;
 				prev_faceCount = face_counts[ii];
@@ -769,35 +1727,41 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 				int myIndex = curr_index + (face_counts[ii] - jj) % face_counts[ii];
 				// cout << "i: " << vertex_list[myIndex] << " ";
 
-				int lastIndex = hg->addVertex(points[vertex_list[ myIndex ]], partIndex, geoIndex, objIndex);
+				int lastIndex = arrays.addVertex(points[vertex_list[ myIndex ]]);
+
+				// kept for updating the values in place later
+				if (arrays.topology != 0) {
+					arrays.sourcePoints.push_back(vertex_list[ myIndex ]);
+					arrays.sourceCorners.push_back(myIndex);
+				}
 
 				if (has_point_normals) {
-					hg->addNormal(normals[vertex_list[ myIndex ]], partIndex, geoIndex, objIndex);
+					arrays.addNormal(normals[vertex_list[ myIndex ]]);
 				} else if (has_vertex_normals) {
-					hg->addNormal(normals[myIndex], partIndex, geoIndex, objIndex);
+					arrays.addNormal(normals[myIndex]);
 				}
 				if(has_point_colors) {
 					// ofmsg("alpha for %1%: %2% ", %myIndex %(has_point_alphas ? alphas[ myIndex ]: 1.0));
-					hg->addColor(Color(
+					arrays.addColor(Color(
 						colors[vertex_list[ myIndex ]][0],
 						colors[vertex_list[ myIndex ]][1],
 						colors[vertex_list[ myIndex ]][2],
 						has_point_alphas ? alphas[vertex_list[ myIndex ]]: 1.0
-					), partIndex, geoIndex, objIndex);
+					));
 				} else if (has_primitive_colors) {
-					hg->addColor(Color(
+					arrays.addColor(Color(
 						colors[ii][0],
 						colors[ii][1],
 						colors[ii][2],
 						has_point_alphas ? alphas[ myIndex ]: 1.0
-					), partIndex, geoIndex, objIndex);
+					));
 				}
 				if (has_point_uvs) {
-					hg->addUV(uvs[vertex_list[ myIndex ]], partIndex, geoIndex, objIndex);
+					arrays.addUV(uvs[vertex_list[ myIndex ]]);
 					// cout << "(p)uvs: " << uvs[vertex_list[ myIndex ]][0] << ", " << uvs[vertex_list[ myIndex ]][1] << endl;
 				} else if (has_vertex_uvs) {
-					// hg->addUV(uvs[vertex_list[ myIndex ]], partIndex, geoIndex, objIndex);
-					hg->addUV(uvs[myIndex], partIndex, geoIndex, objIndex);
+					// arrays.addUV(uvs[vertex_list[ myIndex ]]);
+					arrays.addUV(uvs[myIndex]);
 					// cout << "(v)uvs: " << uvs[myIndex][0] << ", " << uvs[myIndex][1] << endl;
 				}
 
@@ -818,60 +1782,96 @@ void HoudiniEngine::process_part(const hapi::Part &part, const int objIndex, con
 			myType = osg::PrimitiveSet::TRIANGLE_FAN;
 		}
 
-		hflog("[HoudiniEngine::process_part]    make primitive set face size %1%, from %2% plus %3%",
-			%prev_faceCount
-			%prev_faceCountIndex
-			%(curr_index - prev_faceCountIndex)
-		);
-
-		hg->addPrimitiveOsg(myType, prev_faceCountIndex, curr_index - prev_faceCountIndex, partIndex, geoIndex, objIndex);
+		arrays.addPrimitiveOsg(myType, prev_faceCountIndex, curr_index - prev_faceCountIndex);
+	}
 
-		// transparency override
-		osg::StateSet* ss =  hg->getOsgNode(geoIndex, objIndex)->getDrawable(partIndex)->getOrCreateStateSet();
-		hg->setTransparent(has_point_alphas, partIndex, geoIndex, objIndex);
+}
 
-		// Material handling
-		process_materials(part, hg);
+// convert all parts, on up to myConversionThreads threads including this one
+void HoudiniEngine::convert_parts(vector<PartJob>& jobs)
+{
+	HAPI_TRACE_SCOPE("convert_parts");
+	int threads = std::min(myConversionThreads, int(jobs.size()));
 
-		// set transparency state set on this part if there are any alphas
-		if (has_point_alphas) {
-			hflog("[HoudiniEngine::process_part]    setting part %1% as transparent", %partIndex);
-			ss->setRenderingHint(osg::StateSet::TRANSPARENT_BIN);
-			ss->setMode(GL_BLEND, osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | 
-			osg::StateAttribute::OVERRIDE);
-		} else {
-			hflog("[HoudiniEngine::process_part]    setting part %1% as opaque", %partIndex);
-			ss->setRenderingHint(osg::StateSet::OPAQUE_BIN);
-			ss->setMode(GL_BLEND, osg::StateAttribute::OFF | osg::StateAttribute::PROTECTED | 
-			osg::StateAttribute::OVERRIDE);
+	if (threads <= 1) {
+		for (int i = 0; i < int(jobs.size()); ++i) {
+			convert_part(jobs[i]);
 		}
+		return;
+	}
+
+	hflog("[HoudiniEngine::convert_parts] converting %1% parts on %2% threads", %jobs.size() %threads);
 
-		hg->dirty();
+	int next = 0;
+	OpenThreads::Mutex mutex;
 
+	vector<PartWorker*> workers;
+	for (int i = 0; i < threads - 1; ++i) {
+		workers.push_back(new PartWorker(jobs, next, mutex));
+		workers.back()->start();
 	}
 
-	if (part.info().type == HAPI_PARTTYPE_VOLUME) {
-		hlog("[HoudiniEngine::process_part]     Volume (TODO)");
+	// the main thread takes its share too
+	PartWorker(jobs, next, mutex).run();
+
+	for (int i = 0; i < int(workers.size()); ++i) {
+		workers[i]->join();
+		delete workers[i];
 	}
+}
 
-	// todo: check out some geometry shaders for this..
-	if (part.info().type == HAPI_PARTTYPE_BOX) {
-		hlog("[HoudiniEngine::process_part]     Box (TODO)");
+// put a converted part into the scene graph, then transparency and materials
+void HoudiniEngine::apply_part(PartJob& job, HoudiniGeometry* hg)
+{
+	HAPI_TRACE_SCOPE("apply_part");
+	const hapi::Part& part = job.part;
+	const int objIndex = job.objIndex;
+	const int geoIndex = job.geoIndex;
+	const int partIndex = job.partIndex;
+	bool has_point_alphas = job.has_point_alphas;
+
+	if (job.inPlace) {
+		// same arrays and primitive sets, they only need uploading again
+		hg->dirtyDrawable(partIndex, geoIndex, objIndex);
+
+		hflog("[HoudiniEngine::apply_part] %1%: %2% vertices updated in place",
+			%part.name()
+			%job.arrays.vertices->size()
+		);
+	} else {
+		hg->setPartArrays(job.arrays, partIndex, geoIndex, objIndex);
+
+		hflog("[HoudiniEngine::apply_part] %1%: %2% corners into %3% vertices, %4% primitive sets",
+			%part.name()
+			%job.vertex_list.size()
+			%job.arrays.vertices->size()
+			%job.arrays.primitives.size()
+		);
 	}
-	// todo: check out some geometry shaders for this..
-	if (part.info().type == HAPI_PARTTYPE_SPHERE) {
-		hlog("[HoudiniEngine::process_part]     Sphere (TODO)");
+
+	// only meshes with faces have materials
+	if (!job.isMesh || part.info().faceCount == 0) {
+		return;
 	}
 
+	// transparency override
+	hg->setTransparent(has_point_alphas, partIndex, geoIndex, objIndex);
+
+	// Material handling
+	process_materials(part, hg);
+
+	// shared state set for the part's material, transparent if there are
+	// any alphas
+	hflog("[HoudiniEngine::apply_part]    setting part %1% as %2%", %partIndex
+		%(has_point_alphas ? "transparent" : "opaque"));
+	apply_material_state(hg, partIndex, geoIndex, objIndex);
 }
 
-// get the part id from the Part, 
-// use it to make a stateset for the relevant Geode in the HG
-// set the various parms according to their names:
-//     eg: diff -> Material.setDiffuseColour()
-//     or if a uniform, add uniform to the stateset
-//     shader should end up propogating changes
+// get the part's materials, record their parms in assetMaterialParms and
+// the part's material id in the HG, and load their maps. apply_part then
+// gives the drawable the state set of the material
 void HoudiniEngine::process_materials(const hapi::Part &part, HoudiniGeometry* hg) {
+	HAPI_TRACE_SCOPE("process_materials");
 	bool all_same = false;
 
 	int faceCount = part.info().faceCount;
@@ -905,8 +1905,8 @@ void HoudiniEngine::process_materials(const hapi::Part &part, HoudiniGeometry* h
 
 		HAPI_MaterialInfo mat_info;
 
-		ENSURE_SUCCESS(session,  HAPI_GetMaterialInfo (
-			session,
+		ENSURE_SUCCESS(part.session,  HAPI_GetMaterialInfo (
+			part.session,
 			mat_ids[i],
 			&mat_info));
 
@@ -917,25 +1917,22 @@ void HoudiniEngine::process_materials(const hapi::Part &part, HoudiniGeometry* h
 				%hg->getName() %mat_info.nodeId %mat_info.hasChanged
 			);
 
-			hapi::Node matNode(mat_info.nodeId, session);
-
-			MatStruct* ms = NULL;
-
-			for (int j = 0; j < assetMaterialParms[hg->getName()].size(); ++j) {
-				if (assetMaterialParms[hg->getName()][j].matId == mat_info.nodeId) {
-					ms = &assetMaterialParms[hg->getName()][j];
-					break;
-				}
-			}
+			// the parms, read again only if the material changed
+			const MaterialEntry& material = read_material(part.session, mat_info);
 
+			MatStruct* ms = find_material(hg->getName(), mat_info.nodeId);
 			if (ms == NULL) {
-				ms = new MatStruct();
+				Vector<MatStruct>& materials = assetMaterialParms[hg->getName()];
+				materials.push_back(MatStruct());
+				ms = &materials.back();
+				ms->matId = mat_info.nodeId;
+				myAssetMaterialIndex[hg->getName()][mat_info.nodeId] = int(materials.size()) - 1;
 			}
 
-			ms->matId = mat_info.nodeId;
 			ms->partId = part.id;
 			ms->geoId = part.geo.id;
 			ms->objId = part.geo.object.id;
+			ms->parms = material.parms;
 
 			hflog("[HoudiniEngine::process_materials]   set matId of %1% on part %2%, geo %3% object %4% of asset %5%",
 				%mat_info.nodeId
@@ -946,557 +1943,254 @@ void HoudiniEngine::process_materials(const hapi::Part &part, HoudiniGeometry* h
 			);
 			hg->setMatId(mat_info.nodeId, part.id, part.geo.id, part.geo.object.id);
 
-			std::map<std::string, hapi::Parm> parmMap = matNode.parmMap();
+			if (material.mapIds[DIFFUSE_MAP] >= 0) {
+				const String& diffuseMapName = material.mapNames[DIFFUSE_MAP];
 
-			int diffuseMapParmId = -1;
-			int normalMapParmId = -1;
+				hlog("[HoudiniEngine::process_materials]   diffuse map found..");
+				load_material_texture(part, mat_info, material.mapIds[DIFFUSE_MAP],
+					material.mapValues[DIFFUSE_MAP], diffuseMapName, DIFFUSE_MAP);
 
-			string diffuseMapName;
-			string normalMapName;
-			hlog("[HoudiniEngine::process_materials]   looking for diffuse map");
-			if (parmMap.count("ogl_tex1")) {
-				// only assign if not empty
-				if (parmMap["ogl_tex1"].getStringValue(0) != "") {
-					diffuseMapParmId = parmMap["ogl_tex1"].info().id;
-					diffuseMapName = parmMap["ogl_tex1"].name();
-					hflog("[HoudiniEngine::process_materials]   map found, value is %1%", %parmMap["ogl_tex1"].getStringValue(0));
-				}
-			} else if (parmMap.count("baseColorMap")) {
-				// only assign if not empty
-				if (parmMap["baseColorMap"].getStringValue(0) != "") {
-					diffuseMapParmId = parmMap["baseColorMap"].info().id;
-					diffuseMapName = parmMap["baseColorMap"].name();
-					hflog("[HoudiniEngine::process_materials]   map found, value is %1%", %parmMap["baseColorMap"].getStringValue(0));
-				}
-			} else if (parmMap.count("map")) {
-				// only assign if not empty
-				if (parmMap["map"].getStringValue(0) != "") {
-					diffuseMapParmId = parmMap["map"].info().id;
-					diffuseMapName = parmMap["map"].name();
-					hflog("[HoudiniEngine::process_materials]   map found, value is %1%", %parmMap["map"].getStringValue(0));
+				// Update materials on each instance of this asset
+				if (assetInstances.count(hg->getName()) > 0) {
+					// update diffuse map texture
+					hflog("[HoudiniEngine::process_materials]   updating %1%'s texture %2%", %hg->getName() %diffuseMapName);
+					assetInstances[hg->getName()]->getMaterial()->setDiffuseTexture(diffuseMapName);
 				}
 			}
 
-			hlog("[HoudiniEngine::process_materials]   looking for normal map");
-			if (parmMap.count("ogl_normalmap")) {
-				// only assign if not empty
-				if (parmMap["ogl_normalmap"].getStringValue(0) != "") {
-					normalMapParmId = parmMap["ogl_normalmap"].info().id;
-					normalMapName = parmMap["ogl_normalmap"].name();
-					hflog("[HoudiniEngine::process_materials]   map found, value is %1%", %parmMap["ogl_normalmap"].getStringValue(0));
-				}
-			}
+			if (material.mapIds[NORMAL_MAP] >= 0) {
+				const String& normalMapName = material.mapNames[NORMAL_MAP];
 
-			// hlog("[HoudiniEngine::process_materials]   looking for ambient colour");
-			// if (parmMap.count("ogl_amb")) {
-			// 	hflog("[HoudiniEngine::process_materials]   has ambient, value is %1%,%2%,%3%", 
-			// 		%parmMap["ogl_amb"].getFloatValue(0)
-			// 		%parmMap["ogl_amb"].getFloatValue(1)
-			// 		%parmMap["ogl_amb"].getFloatValue(2)
-			// 	);
-			// 	ParmStruct ps;
-			// 	ps.type = parmMap["ogl_amb"].info().type;
-			// 	ps.floatValues.push_back(parmMap["ogl_amb"].getFloatValue(0));
-			// 	ps.floatValues.push_back(parmMap["ogl_amb"].getFloatValue(1));
-			// 	ps.floatValues.push_back(parmMap["ogl_amb"].getFloatValue(2));
-			// 	ms->parms["ogl_amb"] = ps;
-
-			// 	// update the state set for this attribute
-			// 	if (assetInstances.count(hg->getName()) > 0) {
-			// 		osg::StateSet* ss =  hg->getOsgNode(part.geo.id, part.geo.object.id)->getDrawable(part.id)->getOrCreateStateSet();
-			// 		Ref<osg::Material> mat = static_cast<osg::Material*>(ss->getAttribute(osg::StateAttribute::MATERIAL));
-			// 		if (mat == NULL) {
-			// 			mat = new osg::Material();
-			// 		}
-			// 		mat->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(
-			// 			ps.floatValues[0],
-			// 			ps.floatValues[1],
-			// 			ps.floatValues[2],
-			// 			1.0
-			// 		));
-			// 		ss->setAttributeAndModes(mat, 
-			// 			osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | 
-			// 			osg::StateAttribute::OVERRIDE);
-			// 	}
-			// }
-
-			hlog("[HoudiniEngine::process_materials]   looking for emission colour");
-			if (parmMap.count("ogl_emit")) {
-				hflog("[HoudiniEngine::process_materials]   has emission, value is %1%,%2%,%3%", 
-					%parmMap["ogl_emit"].getFloatValue(0)
-					%parmMap["ogl_emit"].getFloatValue(1)
-					%parmMap["ogl_emit"].getFloatValue(2)
-				);
-				ParmStruct ps;
-				ps.type = parmMap["ogl_emit"].info().type;
-				ps.floatValues.push_back(parmMap["ogl_emit"].getFloatValue(0));
-				ps.floatValues.push_back(parmMap["ogl_emit"].getFloatValue(1));
-				ps.floatValues.push_back(parmMap["ogl_emit"].getFloatValue(2));
-				ms->parms["ogl_emit"] = ps;
+				hlog("[HoudiniEngine::process_materials]   normal map found..");
+				load_material_texture(part, mat_info, material.mapIds[NORMAL_MAP],
+					material.mapValues[NORMAL_MAP], normalMapName, NORMAL_MAP);
 
-				// update the state set for this attribute
+				// Update materials on each instance of this asset
 				if (assetInstances.count(hg->getName()) > 0) {
-					osg::StateSet* ss =  hg->getOsgNode(part.geo.id, part.geo.object.id)->getDrawable(part.id)->getOrCreateStateSet();
-					Ref<osg::Material> mat = static_cast<osg::Material*>(ss->getAttribute(osg::StateAttribute::MATERIAL));
-					if (mat == NULL) {
-						mat = new osg::Material();
-					}
-					mat->setEmission(osg::Material::FRONT_AND_BACK, osg::Vec4(
-						ps.floatValues[0],
-						ps.floatValues[1],
-						ps.floatValues[2],
-						1.0
-					));
-					ss->setAttributeAndModes(mat, 
-						osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | 
-						osg::StateAttribute::OVERRIDE);
+					// update normal map texture
+					hflog("[HoudiniEngine::process_materials]   updating %1%'s normal map to %2%", %hg->getName() %normalMapName);
+					assetInstances[hg->getName()]->getMaterial()->setNormalTexture(normalMapName);
 				}
 			}
 
-			hlog("[HoudiniEngine::process_materials]   looking for diffuse colour");
-			if (parmMap.count("ogl_diff")) {
-				hflog("[HoudiniEngine::process_materials]   has diffuse, value is %1%,%2%,%3%", 
-					%parmMap["ogl_diff"].getFloatValue(0)
-					%parmMap["ogl_diff"].getFloatValue(1)
-					%parmMap["ogl_diff"].getFloatValue(2)
-				);
-				ParmStruct ps;
-				ps.type = parmMap["ogl_diff"].info().type;
-				ps.floatValues.push_back(parmMap["ogl_diff"].getFloatValue(0));
-				ps.floatValues.push_back(parmMap["ogl_diff"].getFloatValue(1));
-				ps.floatValues.push_back(parmMap["ogl_diff"].getFloatValue(2));
-				ms->parms["ogl_diff"] = ps;
+		} else {
+			hflog("[HoudiniEngine::process_materials]   Could not get material %1% for %2%", %i %hg->getName());
+		}
+	}
 
-				// update the state set for this attribute
-				if (assetInstances.count(hg->getName()) > 0) {
-					osg::StateSet* ss =  hg->getOsgNode(part.geo.id, part.geo.object.id)->getDrawable(part.id)->getOrCreateStateSet();
-					Ref<osg::Material> mat = static_cast<osg::Material*>(ss->getAttribute(osg::StateAttribute::MATERIAL));
-					if (mat == NULL) {
-						mat = new osg::Material();
-					}
-					mat->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(
-						ps.floatValues[0],
-						ps.floatValues[1],
-						ps.floatValues[2],
-						1.0
-					));
-					ss->setAttributeAndModes(mat, 
-						osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | 
-						osg::StateAttribute::OVERRIDE);
-				}
-			}
+}
 
-			// hlog("[HoudiniEngine::process_materials]   looking for specular colour");
-			// if (parmMap.count("ogl_spec")) {
-			// 	ofmsg("has specular, value is %1%,%2%,%3%", 
-			// 		%parmMap["ogl_spec"].getFloatValue(0)
-			// 		%parmMap["ogl_spec"].getFloatValue(1)
-			// 		%parmMap["ogl_spec"].getFloatValue(2)
-			// 	);
-			// 	ParmStruct ps;
-			// 	ps.type = parmMap["ogl_spec"].info().type;
-			// 	ps.floatValues.push_back(parmMap["ogl_spec"].getFloatValue(0));
-			// 	ps.floatValues.push_back(parmMap["ogl_spec"].getFloatValue(1));
-			// 	ps.floatValues.push_back(parmMap["ogl_spec"].getFloatValue(2));
-			// 	ms->parms["ogl_spec"] = ps;
-
-			// 	// update the state set for this attribute
-			// 	if (assetInstances.count(hg->getName()) > 0) {
-			// 		osg::StateSet* ss =  hg->getOsgNode(part.geo.id, part.geo.object.id)->getDrawable(part.id)->getOrCreateStateSet();
-			// 		Ref<osg::Material> mat = static_cast<osg::Material*>(ss->getAttribute(osg::StateAttribute::MATERIAL));
-			// 		if (mat == NULL) {
-			// 			mat = new osg::Material();
-			// 		}
-			// 		mat->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(
-			// 			ps.floatValues[0],
-			// 			ps.floatValues[1],
-			// 			ps.floatValues[2],
-			// 			1.0
-			// 		));
-			// 		ss->setAttributeAndModes(mat, 
-			// 			osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | 
-			// 			osg::StateAttribute::OVERRIDE);
-			// 	}
-			// }
-
-			hlog("[HoudiniEngine::process_materials]   looking for alpha material colour");
-			if (parmMap.count("ogl_alpha")) {
-				hflog("[HoudiniEngine::process_materials]   has alpha, value is %1%", %parmMap["ogl_alpha"].getFloatValue(0));
-				ParmStruct ps;
-				ps.type = parmMap["ogl_alpha"].info().type;
-				ps.floatValues.push_back(parmMap["ogl_alpha"].getFloatValue(0));
-				ms->parms["ogl_apha"] = ps;
+// the ogl_* parms of a material, each looked up by name so the node's whole
+// parm list never has to come across. Several parts sharing a material read
+// it once per cook, and not at all while HAPI says it hasn't changed.
+// Ambient and specular aren't read, they'd overwrite the effect's
+const HoudiniEngine::MaterialEntry& HoudiniEngine::read_material(HAPI_Session* s, const HAPI_MaterialInfo& mat_info)
+{
+	HAPI_TRACE_SCOPE("read_material");
+	const int key = session_index(s) * SESSION_ID_STRIDE + mat_info.nodeId;
+	const int generation = hapi::StringCache::instance().generation();
+
+	const bool known = myMaterials.count(key) > 0;
+	MaterialEntry& material = myMaterials[key];
+	if (known && (!mat_info.hasChanged || material.generation == generation)) {
+		hflog("[HoudiniEngine::read_material]   material %1% unchanged, not read", %mat_info.nodeId);
+		myMaterialCacheHits++;
+		return material;
+	}
 
-				const string name = "unif_alpha";
-				// update the state set for this attribute
-				if (assetInstances.count(hg->getName()) > 0) {
-					osg::StateSet* ss =  hg->getOsgNode(part.geo.id, part.geo.object.id)->getDrawable(part.id)->getOrCreateStateSet();
-					osg::Uniform* u =  ss->getOrCreateUniform(name, osg::Uniform::FLOAT, 1);
-					u->set(ps.floatValues[0]);
-					ss->getUniformList()[name].second = osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | 
-						osg::StateAttribute::OVERRIDE;
-
-					// set as transparent
-					if (ps.floatValues[0] < 0.95) {
-						ss->setRenderingHint(osg::StateSet::TRANSPARENT_BIN);
-						ss->setMode(GL_BLEND, osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | 
-						osg::StateAttribute::OVERRIDE);
-					} else {
-						ss->setRenderingHint(osg::StateSet::OPAQUE_BIN);
-						ss->setMode(GL_BLEND, osg::StateAttribute::OFF | osg::StateAttribute::PROTECTED | 
-						osg::StateAttribute::OVERRIDE);
-					}
-				}
-			}
+	material = MaterialEntry();
+	material.generation = generation;
+	myMaterialsRead++;
 
-			hlog("[HoudiniEngine::process_materials]   looking for shininess");
-			if (parmMap.count("ogl_rough")) {
-				hflog("[HoudiniEngine::process_materials]   has shininess, value is %1%", %parmMap["ogl_rough"].getFloatValue(0));
-				ParmStruct ps;
-				ps.type = parmMap["ogl_rough"].info().type;
-				ps.floatValues.push_back(parmMap["ogl_rough"].getFloatValue(0));
-				ms->parms["ogl_rough"] = ps;
-			}
+	hapi::Node matNode(mat_info.nodeId, s);
+	HAPI_ParmInfo info;
 
-			if (diffuseMapParmId >= 0) {
+	// colours and such, all the values of each in one call
+	const char* valueNames[] = { "ogl_emit", "ogl_diff", "ogl_alpha", "ogl_rough" };
+	const int valueCount = sizeof(valueNames) / sizeof(valueNames[0]);
+	for (int i = 0; i < valueCount; ++i) {
+		if (!matNode.findParm(valueNames[i], info)) {
+			continue;
+		}
+		hapi::Parm parm(mat_info.nodeId, info, NULL, s);
+		std::vector<float> values = parm.getFloatValues();
+
+		ParmStruct ps;
+		ps.type = info.type;
+		ps.floatValues.assign(values.begin(), values.end());
+		material.parms[valueNames[i]] = ps;
+		hflog("[HoudiniEngine::read_material]   %1% has %2% values", %valueNames[i] %values.size());
+	}
 
-				hlog("[HoudiniEngine::process_materials]   diffuse map found..");
-				// NOTE this works if the image is a png
-				ENSURE_SUCCESS(session,  HAPI_RenderTextureToImage(
-					session,
-					mat_info.nodeId,
-					diffuseMapParmId));
-
-
-				HAPI_ImageInfo image_info;
-				ENSURE_SUCCESS(session,  HAPI_GetImageInfo(
-					session,
-					mat_info.nodeId,
-					&image_info));
-
-				String packing;
-				switch (image_info.packing) {
-					case HAPI_IMAGE_PACKING_UNKNOWN:
-					packing = "HAPI_IMAGE_PACKING_UNKNOWN";
-					break;
-					case HAPI_IMAGE_PACKING_SINGLE:
-					packing = "HAPI_IMAGE_PACKING_SINGLE";
-					break;
-					case HAPI_IMAGE_PACKING_DUAL:
-					packing = "HAPI_IMAGE_PACKING_DUAL";
-					break;
-					case HAPI_IMAGE_PACKING_RGB:
-					packing = "HAPI_IMAGE_PACKING_RGB";
-					break;
-					case HAPI_IMAGE_PACKING_BGR:
-					packing = "HAPI_IMAGE_PACKING_BGR";
-					break;
-					case HAPI_IMAGE_PACKING_RGBA:
-					packing = "HAPI_IMAGE_PACKING_RGBA";
-					break;
-					case HAPI_IMAGE_PACKING_ABGR:
-					packing = "HAPI_IMAGE_PACKING_ABGR";
-					break;
-					case HAPI_IMAGE_PACKING_MAX:
-					packing = "HAPI_IMAGE_PACKING_MAX";
-					break;
-					default:
-					break;
-				}
+	// maps: the first of these parms the material has, if it's not empty
+	const char* diffuseNames[] = { "ogl_tex1", "baseColorMap", "map" };
+	const char* normalNames[] = { "ogl_normalmap" };
+	const char** mapNames[MAP_SLOTS] = { diffuseNames, normalNames };
+	const int mapNameCounts[MAP_SLOTS] = { 3, 1 };
+	const char* mapParms[MAP_SLOTS] = { "diffuseMapName", "normalMapName" };
 
-				// set things
-				// As of HE3.1 for Houdini 16.5.405, setImageInfo does nothing, so lets ignore
-				// image_info.packing = HAPI_IMAGE_PACKING_RGBA;
-				// image_info.dataFormat = HAPI_IMAGE_DATA_INT8;
-				// image_info.interleaved = true; // RGBRGBRGB..
-
-
-				// ENSURE_SUCCESS(session,  HAPI_SetImageInfo(
-				// 	session,
-				// 	mat_info.nodeId,
-				// 	&image_info));
-
-
-				hflog("[HoudiniEngine::process_materials]   width %1% height: %2% format: %3% dataFormat: %4% packing %5% interleaved %6% gamma %7%",
-					%image_info.xRes
-					%image_info.yRes
-					%get_string(session, image_info.imageFileFormatNameSH)
-					%image_info.dataFormat
-					%packing
-					%image_info.interleaved
-					%image_info.gamma
-				);
-
-				// ---------
-
-				HAPI_StringHandle imageSH;
-
-				int planeCount = 0;
-
-				ENSURE_SUCCESS(session,  HAPI_GetImagePlaneCount(
-					session,
-					mat_info.nodeId,
-					&planeCount
-				));
-
-				hflog("[HoudiniEngine::process_materials]   image plane count: %1%", %planeCount);
-
-				ENSURE_SUCCESS(session,  HAPI_GetImagePlanes(
-					session,
-					mat_info.nodeId,
-					&imageSH,
-					planeCount
-				));
-
-				int imgBufSize = -1;
-
-				// get image planes into a buffer as RAW, so no mistakes
-				// Could eventually optimise this..
-				ENSURE_SUCCESS(session,  HAPI_ExtractImageToMemory(
-					session,
-					mat_info.nodeId,
-					HAPI_RAW_FORMAT_NAME,
-					"C A", /* image planes */
-					&imgBufSize
-				));
-
-				char *myBuffer = new char[imgBufSize];
-
-				// put into a buffer
-				ENSURE_SUCCESS(session,  HAPI_GetImageMemoryBuffer(
-					session,
-					mat_info.nodeId,
-					myBuffer,
-					imgBufSize
-				));
-
-				Ref<PixelData> pd = PixelData::create(image_info.xRes, image_info.yRes, PixelData::FormatRgba);
-
-				// manually set each pixel. Slow, but definitely correct
-				// would be better to dump all pixel data
-				pd->beginPixelAccess();
-				for (int ii = 0; ii < image_info.xRes; ++ii) {
-					for (int jj = 0; jj < image_info.yRes; ++jj) {
-						int offset = 4 * ((image_info.yRes * ii) + jj);
-						int r = static_cast<int>(static_cast<unsigned char>(myBuffer[offset + 0]));
-						int g = static_cast<int>(static_cast<unsigned char>(myBuffer[offset + 1]));
-						int b = static_cast<int>(static_cast<unsigned char>(myBuffer[offset + 2]));
-						int a = static_cast<int>(static_cast<unsigned char>(myBuffer[offset + 3]));
-
-						// y and x are swapped, account for it accordingly
-						pd->setPixel(jj, ii,
-							r,
-							g,
-							b,
-							a
-						);
-					}
-				}
-				pd->endPixelAccess();
-				pd->setDirty(true);
-
-				// testing whether it's read properly
-				// ImageUtils::saveImage("/tmp/spaceship1.jpg", pd, ImageUtils::FormatJpeg);
-
-				// load into a pixelData bufferObject
-				// this works!
-				// Ref<PixelData> refPd = ImageUtils::decode((void *) myBuffer, image_info.xRes * image_info.yRes * 4);
-				// pds.push_back(ImageUtils::decode((void *) myBuffer, image_info.xRes * image_info.yRes * 4));
-				// pds.push_back(myBuffer);
-				// pds.push_back(pd);
-
-				// TODO: general case for texture names (diffuse, spec, env, etc)
-				// osg::Texture2D* texture = mySceneManager->createTexture(diffuseMapName, pds[pds.size() - 1]);
-				osg::Texture2D* texture = mySceneManager->createTexture(diffuseMapName, pd);
+	for (int slot = 0; slot < MAP_SLOTS; ++slot) {
+		for (int i = 0; i < mapNameCounts[slot]; ++i) {
+			if (!matNode.findParm(mapNames[slot][i], info)) {
+				continue;
+			}
+			hapi::Parm parm(mat_info.nodeId, info, NULL, s);
+			String value = parm.getStringValue(0);
+			if (value != "") {
+				material.mapIds[slot] = info.id;
+				material.mapNames[slot] = mapNames[slot][i];
+				material.mapValues[slot] = value;
+
+				// the texture name, for instantiateGeometry and the slaves
 				ParmStruct ps;
-				ps.type = parmMap["diffuseMapName"].info().type;
-				ps.stringValues.push_back(parmMap["diffuseMapName"].getStringValue(0));
-				ms->parms["diffuseMapName"] = ps;
-
-
-				// need to set wrap modes too
-				osg::Texture::WrapMode textureWrapMode;
-				textureWrapMode = osg::Texture::REPEAT;
+				ps.type = info.type;
+				ps.stringValues.push_back(mapNames[slot][i]);
+				material.parms[mapParms[slot]] = ps;
+				hflog("[HoudiniEngine::read_material]   map found, value is %1%", %value);
+			}
+			break;
+		}
+	}
 
-				texture->setWrap(osg::Texture2D::WRAP_R, textureWrapMode);
-				texture->setWrap(osg::Texture2D::WRAP_S, textureWrapMode);
-				texture->setWrap(osg::Texture2D::WRAP_T, textureWrapMode);
+	return material;
+}
 
-				// Update materials on each instance of this asset
-				if (assetInstances.count(hg->getName()) > 0) {
-					// update diffuse map texture
-					hflog("[HoudiniEngine::process_materials]   updating %1%'s texture %2%", %hg->getName() %diffuseMapName);
-					assetInstances[hg->getName()]->getMaterial()->setDiffuseTexture(diffuseMapName);
-				}
-			}
+// maps of a material are only extracted again when HAPI says the material
+// changed, or the map parameter points somewhere else. Several parts sharing
+// a material extract it once per cook
+void HoudiniEngine::load_material_texture(const hapi::Part &part, const HAPI_MaterialInfo &mat_info,
+	const int parmId, const String& value, const String& textureName, const int slot)
+{
+	HAPI_TRACE_SCOPE("load_material_texture");
+	const String key = ostr("%1%:%2%:%3%", %session_index(part.session) %mat_info.nodeId %parmId);
+	const int generation = hapi::StringCache::instance().generation();
+
+	MaterialTexture& cached = myMaterialTextures[key];
+	bool fresh = cached.pixels == NULL || cached.value != value ||
+		(mat_info.hasChanged && cached.generation != generation);
+
+	if (fresh) {
+		Ref<PixelData> pd = extract_image(part.session, mat_info.nodeId, parmId);
+		if (pd == NULL) {
+			myMaterialTextures.erase(key);
+			return;
+		}
+		cached.value = value;
+		cached.pixels = pd;
+		myTexturesExtracted++;
+	} else {
+		hflog("[HoudiniEngine::load_material_texture]   %1% unchanged, not extracted", %value);
+		myTextureCacheHits++;
+	}
+	cached.generation = generation;
 
-			if (normalMapParmId >= 0) {
+	// the scene manager already has this very image under the name
+	if (!fresh && myInstalledTextures.count(textureName) > 0 && myInstalledTextures[textureName] == key) {
+		return;
+	}
+	myInstalledTextures[textureName] = key;
 
-				hlog("[HoudiniEngine::process_materials]   normal map found..");
-				// NOTE this works if the image is a png
-				ENSURE_SUCCESS(session,  HAPI_RenderTextureToImage(
-					session,
-					mat_info.nodeId,
-					normalMapParmId));
-
-
-				HAPI_ImageInfo image_info;
-				ENSURE_SUCCESS(session,  HAPI_GetImageInfo(
-					session,
-					mat_info.nodeId,
-					&image_info));
-
-				String packing;
-				switch (image_info.packing) {
-					case HAPI_IMAGE_PACKING_UNKNOWN:
-					packing = "HAPI_IMAGE_PACKING_UNKNOWN";
-					break;
-					case HAPI_IMAGE_PACKING_SINGLE:
-					packing = "HAPI_IMAGE_PACKING_SINGLE";
-					break;
-					case HAPI_IMAGE_PACKING_DUAL:
-					packing = "HAPI_IMAGE_PACKING_DUAL";
-					break;
-					case HAPI_IMAGE_PACKING_RGB:
-					packing = "HAPI_IMAGE_PACKING_RGB";
-					break;
-					case HAPI_IMAGE_PACKING_BGR:
-					packing = "HAPI_IMAGE_PACKING_BGR";
-					break;
-					case HAPI_IMAGE_PACKING_RGBA:
-					packing = "HAPI_IMAGE_PACKING_RGBA";
-					break;
-					case HAPI_IMAGE_PACKING_ABGR:
-					packing = "HAPI_IMAGE_PACKING_ABGR";
-					break;
-					case HAPI_IMAGE_PACKING_MAX:
-					packing = "HAPI_IMAGE_PACKING_MAX";
-					break;
-					default:
-					break;
-				}
+	install_texture(textureName, cached.pixels);
+	share_texture(part.geo.object.asset.name(), textureName, slot, cached.pixels);
+}
 
-				// set things
-				// As of HE3.1 for Houdini 16.5.405, setImageInfo does nothing, so lets ignore
-				// image_info.packing = HAPI_IMAGE_PACKING_RGBA;
-				// image_info.dataFormat = HAPI_IMAGE_DATA_INT8;
-				// image_info.interleaved = true; // RGBRGBRGB..
-
-
-				// ENSURE_SUCCESS(session,  HAPI_SetImageInfo(
-				// 	session,
-				// 	mat_info.nodeId,
-				// 	&image_info));
-
-
-				hflog("[HoudiniEngine::process_materials]   width %1% height: %2% format: %3% dataFormat: %4% packing %5% interleaved %6% gamma %7%",
-					%image_info.xRes
-					%image_info.yRes
-					%get_string(session, image_info.imageFileFormatNameSH)
-					%image_info.dataFormat
-					%packing
-					%image_info.interleaved
-					%image_info.gamma
-				);
-
-				// ---------
-
-				HAPI_StringHandle imageSH;
-
-				int planeCount = 0;
-
-				ENSURE_SUCCESS(session,  HAPI_GetImagePlaneCount(
-					session,
-					mat_info.nodeId,
-					&planeCount
-				));
-
-				hflog("[HoudiniEngine::process_materials]   image plane count: %1%", %planeCount);
-
-				ENSURE_SUCCESS(session,  HAPI_GetImagePlanes(
-					session,
-					mat_info.nodeId,
-					&imageSH,
-					planeCount
-				));
-
-				int imgBufSize = -1;
-
-				// get image planes into a buffer as RAW, so no mistakes
-				// Could eventually optimise this..
-				ENSURE_SUCCESS(session,  HAPI_ExtractImageToMemory(
-					session,
-					mat_info.nodeId,
-					HAPI_RAW_FORMAT_NAME,
-					"C A", /* image planes */
-					&imgBufSize
-				));
-
-				char *myBuffer = new char[imgBufSize];
-
-				// put into a buffer
-				ENSURE_SUCCESS(session,  HAPI_GetImageMemoryBuffer(
-					session,
-					mat_info.nodeId,
-					myBuffer,
-					imgBufSize
-				));
-
-				Ref<PixelData> pd = PixelData::create(image_info.xRes, image_info.yRes, PixelData::FormatRgba);
-
-				// manually set each pixel. Slow, but definitely correct
-				// would be better to dump all pixel data
-				pd->beginPixelAccess();
-				for (int ii = 0; ii < image_info.xRes; ++ii) {
-					for (int jj = 0; jj < image_info.yRes; ++jj) {
-						int offset = 4 * ((image_info.yRes * ii) + jj);
-						int r = static_cast<int>(static_cast<unsigned char>(myBuffer[offset + 0]));
-						int g = static_cast<int>(static_cast<unsigned char>(myBuffer[offset + 1]));
-						int b = static_cast<int>(static_cast<unsigned char>(myBuffer[offset + 2]));
-						int a = static_cast<int>(static_cast<unsigned char>(myBuffer[offset + 3]));
-
-						// y and x are swapped, account for it accordingly
-						pd->setPixel(jj, ii,
-							r,
-							g,
-							b,
-							a
-						);
-					}
-				}
-				pd->endPixelAccess();
-				pd->setDirty(true);
+// (re)creates a scene manager texture, on the master and on slaves
+void HoudiniEngine::install_texture(const String& name, PixelData* pixels)
+{
+	osg::Texture2D* texture = mySceneManager->createTexture(name, pixels);
 
-				osg::Texture2D* texture = mySceneManager->createTexture(normalMapName, pd);
-				ParmStruct ps;
-				ps.type = parmMap["normalMapName"].info().type;
-				ps.stringValues.push_back(parmMap["normalMapName"].getStringValue(0));
-				ms->parms["normalMapName"] = ps;
+	// need to set wrap modes too
+	osg::Texture::WrapMode textureWrapMode;
+	textureWrapMode = osg::Texture::REPEAT;
 
+	texture->setWrap(osg::Texture2D::WRAP_R, textureWrapMode);
+	texture->setWrap(osg::Texture2D::WRAP_S, textureWrapMode);
+	texture->setWrap(osg::Texture2D::WRAP_T, textureWrapMode);
+}
 
-				// need to set wrap modes too
-				osg::Texture::WrapMode textureWrapMode;
-				textureWrapMode = osg::Texture::REPEAT;
+PixelData* HoudiniEngine::extract_image(HAPI_Session* s, const HAPI_NodeId material, const int parmId)
+{
+	HAPI_TRACE_SCOPE("extract_image");
+
+	// NOTE this works if the image is a png
+	ENSURE_SUCCESS(s,  HAPI_RenderTextureToImage(
+		s,
+		material,
+		parmId));
+
+	HAPI_ImageInfo image_info;
+	ENSURE_SUCCESS(s,  HAPI_GetImageInfo(
+		s,
+		material,
+		&image_info));
+
+	// As of HE3.1 for Houdini 16.5.405, setImageInfo does nothing, so the
+	// image comes in whatever packing it has
+	hflog("[HoudiniEngine::extract_image]   width %1% height: %2% format: %3% dataFormat: %4% packing %5% interleaved %6% gamma %7%",
+		%image_info.xRes
+		%image_info.yRes
+		%get_string(s, image_info.imageFileFormatNameSH)
+		%image_info.dataFormat
+		%image_info.packing
+		%image_info.interleaved
+		%image_info.gamma
+	);
 
-				texture->setWrap(osg::Texture2D::WRAP_R, textureWrapMode);
-				texture->setWrap(osg::Texture2D::WRAP_S, textureWrapMode);
-				texture->setWrap(osg::Texture2D::WRAP_T, textureWrapMode);
+	int imgBufSize = -1;
+
+	// get image planes into a buffer as RAW, so no mistakes
+	ENSURE_SUCCESS(s,  HAPI_ExtractImageToMemory(
+		s,
+		material,
+		HAPI_RAW_FORMAT_NAME,
+		"C A", /* image planes */
+		&imgBufSize
+	));
+
+	vector<char> buffer(std::max(imgBufSize, 0));
+	if (!buffer.empty()) {
+		ENSURE_SUCCESS_BYTES(s, imgBufSize, HAPI_GetImageMemoryBuffer(
+			s,
+			material,
+			&buffer[0],
+			imgBufSize
+		));
+	}
 
-				// Update materials on each instance of this asset
-				if (assetInstances.count(hg->getName()) > 0) {
-					// update normal map texture
-					hflog("[HoudiniEngine::process_materials]   updating %1%'s normal map to %2%", %hg->getName() %normalMapName);
-					assetInstances[hg->getName()]->getMaterial()->setNormalTexture(normalMapName);
-				}
-			}
+	// 8 bit rows of xRes pixels, 4 or 3 channels in the image's packing
+	const int pixels = image_info.xRes * image_info.yRes;
+	const int channels = pixels > 0 ? int(buffer.size()) / pixels : 0;
+	if (image_info.dataFormat != HAPI_IMAGE_DATA_INT8 || (channels != 4 && channels != 3)) {
+		ofwarn("[HoudiniEngine::extract_image] can't convert %1%x%2% image of %3% bytes, data format %4%",
+			%image_info.xRes %image_info.yRes %buffer.size() %image_info.dataFormat);
+		return NULL;
+	}
 
-			assetMaterialParms[part.geo.object.asset.name()].push_back(*ms);
+	PixelData* pd = PixelData::create(image_info.xRes, image_info.yRes, PixelData::FormatRgba);
+	unsigned char* dst = reinterpret_cast<unsigned char*>(pd->map());
+	const unsigned char* src = reinterpret_cast<const unsigned char*>(&buffer[0]);
 
-		} else {
-			hflog("[HoudiniEngine::process_materials]   Could not get material %1% for %2%", %i %hg->getName());
+	if (channels == 4 && image_info.packing != HAPI_IMAGE_PACKING_ABGR) {
+		// already rgba, a straight copy
+		memcpy(dst, src, pixels * 4);
+	} else {
+		// one pass over the pixels, simple enough for the compiler to vectorise
+		const bool reversed = image_info.packing == HAPI_IMAGE_PACKING_ABGR ||
+			image_info.packing == HAPI_IMAGE_PACKING_BGR;
+		const int r = reversed ? channels - 1 : 0;
+		const int g = reversed ? channels - 2 : 1;
+		const int b = reversed ? channels - 3 : 2;
+		for (int i = 0; i < pixels; ++i, src += channels, dst += 4) {
+			dst[0] = src[r];
+			dst[1] = src[g];
+			dst[2] = src[b];
+			dst[3] = channels == 4 ? src[reversed ? 0 : 3] : 255;
 		}
 	}
 
+	pd->unmap();
+	pd->setDirty(true);
+	return pd;
 }
 
 void HoudiniEngine::process_float_attrib(
@@ -1507,23 +2201,42 @@ void HoudiniEngine::process_float_attrib(
 
     // Get the attribute values.
     HAPI_AttributeInfo attrib_info = part.attribInfo(attrib_owner, attrib_name);
-    float *attrib_data = part.getNewFloatAttribData(attrib_info, attrib_name);
 
 // 	cout << attrib_name << " (" << attrib_info.tupleSize << ")" << endl;
 
 	points.clear();
-	points.resize(attrib_info.count);
-    for (int elem_index=0; elem_index < attrib_info.count; ++elem_index)
-    {
+	points.resize(attrib_info.count, Vector3f::Zero());
+	if (attrib_info.count > 0) {
+		read_float_attrib(part, attrib_info, attrib_name, points[0].data(), 3);
+	}
+}
 
-		Vector3f v;
-		for (int tuple_index=0; tuple_index < attrib_info.tupleSize;
-			++tuple_index)
-		{
-			v[tuple_index] = attrib_data[elem_index * attrib_info.tupleSize + tuple_index ];
+int HoudiniEngine::process_float_attrib(
+    const hapi::Part &part, HAPI_AttributeOwner attrib_owner,
+    const char *attrib_name, float* data, const int stride)
+{
+    HAPI_AttributeInfo attrib_info = part.attribInfo(attrib_owner, attrib_name);
+	read_float_attrib(part, attrib_info, attrib_name, data, stride);
+	return attrib_info.count;
+}
+
+void HoudiniEngine::read_float_attrib(
+    const hapi::Part &part, HAPI_AttributeInfo &attrib_info,
+    const char *attrib_name, float* data, const int stride)
+{
+	if (attrib_info.tupleSize <= stride) {
+		// HAPI writes straight into the destination, one element per stride
+		part.getFloatAttribData(attrib_info, attrib_name, data, stride);
+		return;
+	}
+
+	// wider than the destination (eg. a 4 component N), keep the first ones
+	float *attrib_data = part.getNewFloatAttribData(attrib_info, attrib_name);
+    for (int elem_index=0; elem_index < attrib_info.count; ++elem_index) {
+		for (int tuple_index=0; tuple_index < stride; ++tuple_index) {
+			data[elem_index * stride + tuple_index] =
+				attrib_data[elem_index * attrib_info.tupleSize + tuple_index];
 		}
-		points[elem_index] = v;
-// 		cout << elem_index << ": " << v << endl;
     }
 
     delete [] attrib_data;
@@ -1573,8 +2286,9 @@ void HoudiniEngine::process_attrib(
 
 
 // TODO: make an async version of for omegalib
-void HoudiniEngine::wait_for_cook()
+void HoudiniEngine::wait_for_cook(HAPI_Session* cookSession)
 {
+	HAPI_TRACE_SCOPE("wait_for_cook");
     int status;
     do
     {
@@ -1582,8 +2296,8 @@ void HoudiniEngine::wait_for_cook()
 
 		if (myLogEnabled) {
 	        int statusBufSize = 0;
-	        ENSURE_SUCCESS(session,  HAPI_GetStatusStringBufLength(
-				session,
+	        ENSURE_SUCCESS(cookSession,  HAPI_GetStatusStringBufLength(
+				cookSession,
 /* 	            HAPI_STATUS_COOK_STATE, HAPI_STATUSVERBOSITY_MESSAGES, */
 	            HAPI_STATUS_COOK_STATE, HAPI_STATUSVERBOSITY_ERRORS,
 	            &statusBufSize ) );
@@ -1591,8 +2305,8 @@ void HoudiniEngine::wait_for_cook()
 	        if ( statusBufSize > 0 )
 	        {
 	            statusBuf = new char[statusBufSize];
-	            ENSURE_SUCCESS(session,  HAPI_GetStatusString(
-					session,
+	            ENSURE_SUCCESS(cookSession,  HAPI_GetStatusString(
+					cookSession,
 	                HAPI_STATUS_COOK_STATE, statusBuf, statusBufSize ) );
 	        }
 	        if ( statusBuf )
@@ -1602,9 +2316,11 @@ void HoudiniEngine::wait_for_cook()
 	            delete[] statusBuf;
 	        }
 		}
-		HAPI_GetStatus(session, HAPI_STATUS_COOK_STATE, &status);
+		HAPI_TRACE(sizeof(int), HAPI_GetStatus(cookSession, HAPI_STATUS_COOK_STATE, &status));
 	}
 	while ( status > HAPI_STATE_MAX_READY_STATE );
-	ENSURE_COOK_SUCCESS( session, status );
+	// anything read while the cook ran is stale now
+	hapi::newCookGeneration();
+	ENSURE_COOK_SUCCESS( cookSession, status );
 	hflog("[HoudiniEngine::wait_for_cook] cooked: %1%", %status);
 }
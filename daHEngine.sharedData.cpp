@@ -41,6 +41,9 @@ daHEngine
 
 #include <daHoudiniEngine/daHEngine.h>
 #include <daHoudiniEngine/houdiniGeometry.h>
+#include <daHoudiniEngine/sharedDataTools.h>
+#include <daHoudiniEngine/geometryCodec.h>
+#include <algorithm>
 
 using namespace houdiniEngine;
 
@@ -48,8 +51,13 @@ using namespace houdiniEngine;
 // only run on master
 // for each part of each geo of each object of each asset:
 // send all the verts, faces, normals, colours, etc
+// only parts whose content hash changed since they were last sent go out,
+// the rest is flagged unchanged and kept as is on the slaves
 void HoudiniEngine::commitSharedData(SharedOStream& out)
 {
+	// texture chunks go every frame, cooked or not
+	commit_textures(out);
+
 	out << updateGeos; // TODO: may not be necessary to send this..
 
 	// continue only if there is something to send
@@ -61,6 +69,10 @@ void HoudiniEngine::commitSharedData(SharedOStream& out)
 
  	hflog("[HoudiniEngine::MASTER] sending %1% assets", %myHoudiniGeometrys.size());
 
+	// compression of the geometry arrays, see setGeometryCompression
+	const int compression = myGeometryCompression;
+	out << compression;
+
 	out << int(myHoudiniGeometrys.size());
 
     foreach(HGDictionary::Item hg, myHoudiniGeometrys)
@@ -81,9 +93,9 @@ void HoudiniEngine::commitSharedData(SharedOStream& out)
 
 		// objects
 		for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
-			// bool hasTransformChanged = hg->getTransformChanged(obj);
-			// always do this..
-			bool hasTransformChanged = true;
+			// compare against what was last sent, HAPI's hasTransformChanged
+			// isn't reliable
+			bool hasTransformChanged = hg->isTransformDirty(obj);
 			hflog("[HoudiniEngine::MASTER] Object %1%: Transforms have changed:  %2%", %obj %hasTransformChanged);
 
 			out << hasTransformChanged;
@@ -99,9 +111,11 @@ void HoudiniEngine::commitSharedData(SharedOStream& out)
 				out << pos[0] << pos[1] << pos[2];
 				out << rot[0] << rot[1] << rot[2] << rot[3];
 				out << scale[0] << scale[1] << scale[2];
+
+				hg->setTransformSent(obj);
 			}
 
-			bool haveGeosChanged = hg->getGeosChanged(obj);
+			bool haveGeosChanged = hg->isObjDirty(obj);
 			hflog("[HoudiniEngine::MASTER] Object %1% Geos have changed:  %2%", %obj %haveGeosChanged);
 			out << haveGeosChanged;
 
@@ -114,7 +128,7 @@ void HoudiniEngine::commitSharedData(SharedOStream& out)
 
 			// geoms
 			for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
-				bool hasGeoChanged = hg->getGeoChanged(g, obj);
+				bool hasGeoChanged = hg->isGeodeDirty(g, obj);
 				hflog("[HoudiniEngine::MASTER] Object %1% Geo %2% has changed:  %3%", %obj %g %hasGeoChanged);
 				out << hasGeoChanged;
 
@@ -127,62 +141,103 @@ void HoudiniEngine::commitSharedData(SharedOStream& out)
 
 				// parts
 				for (int d = 0; d < hg->getDrawableCount(g, obj); ++d) {
-					hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Vertex count: %4%",
-						%obj %g %d
-						%hg->getVertexCount(d, g, obj));
-					out << hg->getVertexCount(d, g, obj);
-					for (int i = 0; i < hg->getVertexCount(d, g, obj); ++i) {
-						out << hg->getVertex(i, d, g, obj);
-					}
-					hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Normal count: %4%",
-						%obj %g %d
-						%hg->getNormalCount(d, g, obj));
-					out << hg->getNormalCount(d, g, obj);
-					for (int i = 0; i < hg->getNormalCount(d, g, obj); ++i) {
-						out << hg->getNormal(i, d, g, obj);
-					}
-					hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Color count: %4%",
-						%obj %g %d
-						%hg->getColorCount(d, g, obj));
-					out << hg->getColorCount(d, g, obj);
-					for (int i = 0; i < hg->getColorCount(d, g, obj); ++i) {
-						out << hg->getColor(i, d, g, obj);
+					bool hasDrawableChanged = hg->isDrawableDirty(d, g, obj);
+					hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% has changed: %4%",
+						%obj %g %d %hasDrawableChanged);
+					out << hasDrawableChanged;
+
+					if (!hasDrawableChanged) {
+						continue;
 					}
-					hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% UV count: %4%",
-						%obj %g %d
-						%hg->getUVCount(d, g, obj));
-					out << hg->getUVCount(d, g, obj);
-					for (int i = 0; i < hg->getUVCount(d, g, obj); ++i) {
-						out << hg->getUV(i, d, g, obj);
+
+					// only the instance transforms moved: the slave keeps the
+					// geometry it has and just gets the new transforms
+					bool hasContentChanged = hg->isContentDirty(d, g, obj);
+					out << hasContentChanged;
+
+					if (hasContentChanged) {
+						// each array goes as one length-prefixed blob, compressed
+						// if asked for
+						int vertCount = writePositionArray(out, hg->getVertexArray(d, g, obj), compression);
+						hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Vertex count: %4%",
+							%obj %g %d %vertCount);
+						int normalCount = writeNormalArray(out, hg->getNormalArray(d, g, obj), compression);
+						hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Normal count: %4%",
+							%obj %g %d %normalCount);
+						int colorCount = writeColorArray(out, hg->getColorArray(d, g, obj), compression);
+						hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Color count: %4%",
+							%obj %g %d %colorCount);
+						int uvCount = writeFloatArray(out, hg->getUVArray(d, g, obj), compression);
+						hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% UV count: %4%",
+							%obj %g %d %uvCount);
+
+						// faces are done in that primitive set way
+						// TODO: simplification: assume all faces are triangles?
+						osg::Geometry* geo = hg->getGeometry(d, g, obj);
+
+						// only DrawElementsUInt and DrawArrays sets can be sent
+						osg::Geometry::PrimitiveSetList psl;
+						for (int i = 0; i < geo->getNumPrimitiveSets(); ++i) {
+							osg::PrimitiveSet* ps = geo->getPrimitiveSet(i);
+							if (dynamic_cast<osg::DrawElementsUInt*>(ps) == NULL &&
+								dynamic_cast<osg::DrawArrays*>(ps) == NULL) {
+								ofwarn("[HoudiniEngine::commitSharedData] O%1%G%2% D%3%: skipping unsupported primitive set %4%",
+									%obj %g %d %ps->className());
+								continue;
+							}
+							psl.push_back(ps);
+						}
+
+						hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Primitive Set count: %4%",
+							%obj %g %d %psl.size());
+						out << int(psl.size());
+						for (int i = 0; i < psl.size(); ++i) {
+							osg::DrawElementsUInt* de = dynamic_cast<osg::DrawElementsUInt*>(psl[i].get());
+							if (de != NULL) {
+								// indexed set: mode, -1, then the indices as a blob
+								out << de->getMode() << int(-1);
+								int indexCount = writeFloatArray(out, de, compression);
+								hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% ps%4%: %5% indices %6%",
+									%obj %g %d %i
+									%de->getMode()
+									%indexCount
+								);
+								continue;
+							}
+
+							osg::DrawArrays* da = dynamic_cast<osg::DrawArrays*>(psl[i].get());
+
+							hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% ps%4%: %5% %6% %7%",
+								%obj %g %d %i
+								%da->getMode()
+								%da->getFirst()
+								%da->getCount()
+							);
+							out << da->getMode() << int(da->getFirst()) << int(da->getCount());
+						}
+						hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Mat Id: %4%",
+							%obj %g %d
+							%hg->getMatId(d, g, obj));
+						out << hg->getMatId(d, g, obj);
+
+						hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% %4%",
+							%obj %g %d
+							%(hg->isTransparent(d, g, obj) ? "Transparent" : "Opaque"));
+						out << hg->isTransparent(d, g, obj);
 					}
-					// faces are done in that primitive set way
-					// TODO: simplification: assume all faces are triangles?
-					osg::Geometry* geo = hg->getOsgNode()->asGroup()->getChild(obj)->asGroup()->getChild(g)->asGeode()->getDrawable(d)->asGeometry();
-					osg::Geometry::PrimitiveSetList psl = geo->getPrimitiveSetList();
-
-					hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Primitive Set count: %4%",
-						%obj %g %d %psl.size());
-					out << int(psl.size());
-					for (int i = 0; i < psl.size(); ++i) {
-						osg::DrawArrays* da = dynamic_cast<osg::DrawArrays*>(psl[i].get());
-
-						hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% ps%4%: %5% %6% %7%",
-							%obj %g %d %i
-							%da->getMode()
-							%da->getFirst()
-							%da->getCount()
-						);
-						out << da->getMode() << int(da->getFirst()) << int(da->getCount());
+
+					// instanced parts: the geometry above once, then a
+					// transform per instance. -1 for parts drawn once
+					int instanceCount = hg->isInstanced(d, g, obj) ? int(hg->getInstances(d, g, obj).size()) : -1;
+					hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Instances: %4%",
+						%obj %g %d %instanceCount);
+					out << instanceCount;
+					if (instanceCount > 0) {
+						writeBlob(out, &hg->getInstances(d, g, obj)[0],
+							instanceCount * sizeof(osg::Matrixf), sizeof(float), compression);
 					}
-					hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% Mat Id: %4%",
-						%obj %g %d
-						%hg->getMatId(d, g, obj));
-					out << hg->getMatId(d, g, obj);
-
-					hflog("[HoudiniEngine::MASTER] O%1%G%2% D%3% %4%",
-						%obj %g %d
-						%(hg->isTransparent(d, g, obj) ? "Transparent" : "Opaque"));
-					out << hg->isTransparent(d, g, obj);
+
+					hg->setDrawableSent(d, g, obj);
 				}
 			}
 		}
@@ -245,27 +300,6 @@ void HoudiniEngine::commitSharedData(SharedOStream& out)
 					out << mp.second.stringValues[i];
 				}
 
-
-				// textures are shared based on value 'diffuseMapName' and 'normalMapName'
-				// change this to something more sensible.
-				// maybe just send all the parm values directly?!
-				// ie foreach parm, send the type, string, int and float values.
-				// then, reassemble on other side, picking out only what i need?
-				// yeah, lets try that..
-
-				// share the textures properly in another loop
-				// fetch the texture from the sceneManager and send this across
-				/*
-				Ref<PixelData> pd = PixelData::create(32, 32, PixelData::FormatRgba);
-				pd->copyFrom(mySceneManager->getPixelData(mp.second));
-				hflog("[HoudiniEngine::MASTER] Sending pixel data info: w %1% h %2%", %pd->getWidth() %pd->getHeight());
-				out << pd->getWidth() << pd->getHeight();
-				hflog("[HoudiniEngine::MASTER] Sending pixel data size %1%", %pd->getSize());
-				out << pd->getSize();
-				hflog("[HoudiniEngine::MASTER] Sending pixel data for %1%", %mp.second);
-				out.write(pd->map(), pd->getSize());
-				pd->unmap();
-				*/
 			}
 		}
 	}
@@ -277,12 +311,17 @@ void HoudiniEngine::commitSharedData(SharedOStream& out)
 // only run on slaves!
 void HoudiniEngine::updateSharedData(SharedIStream& in)
 {
+	update_textures(in);
+
 	in >> updateGeos;
 
 	if (!updateGeos) {
 		return;
 	}
 
+	int compression = COMPRESS_NONE;
+	in >> compression;
+
 	// houdiniGeometry count
 	int numItems = 0;
 
@@ -399,93 +438,111 @@ void HoudiniEngine::updateSharedData(SharedIStream& in)
 					hg->addDrawable(drawableCount - hg->getDrawableCount(g, obj), g, obj);
 				}
 
-				hg->clearGeode(g, obj);
-
 				for (int d = 0; d < drawableCount; ++d) {
 
-					int vertCount = 0;
-					in >> vertCount;
+					// unchanged drawables keep their current geometry
+					bool hasDrawableChanged;
+					in >> hasDrawableChanged;
 
-					hflog("[HoudiniEngine::SLAVE] vertex count: '%1%'", %vertCount);
-					for (int j = 0; j < vertCount; ++j) {
-						Vector3f v;
-						in >> v;
-						hg->addVertex(v, d, g, obj);
+					if (!hasDrawableChanged) {
+						continue;
 					}
 
-					int normalCount = 0;
-					in >> normalCount;
+					bool hasContentChanged;
+					in >> hasContentChanged;
 
-					hflog("[HoudiniEngine::SLAVE] normal count: '%1%'", %normalCount);
-					for (int j = 0; j < normalCount; ++j) {
-						Vector3f n;
-						in >> n;
-						hg->addNormal(n, d, g, obj);
-					}
+					if (hasContentChanged) {
+						hg->clearDrawable(d, g, obj);
 
-					int colorCount = 0;
-					in >> colorCount;
+						// arrays arrive as length-prefixed blobs, read them straight
+						// into the part arrays
+						int vertCount = 0;
+						in >> vertCount;
+						hflog("[HoudiniEngine::SLAVE] vertex count: '%1%'", %vertCount);
+						bool arraysOk = readPositionArrayData(in, hg->getVertexArray(d, g, obj), vertCount, compression);
 
-					hflog("[HoudiniEngine::SLAVE] color count: '%1%'", %colorCount);
-					for (int j = 0; j < colorCount; ++j) {
-						Color c;
-						in >> c;
-						hg->addColor(c, d, g, obj);
-					}
+						int normalCount = 0;
+						in >> normalCount;
+						hflog("[HoudiniEngine::SLAVE] normal count: '%1%'", %normalCount);
+						if (normalCount > 0) {
+							arraysOk &= readNormalArrayData(in, hg->getOrCreateNormalArray(d, g, obj), normalCount, compression);
+						}
 
-					int uvCount = 0;
-					in >> uvCount;
+						int colorCount = 0;
+						in >> colorCount;
+						hflog("[HoudiniEngine::SLAVE] color count: '%1%'", %colorCount);
+						if (colorCount > 0) {
+							arraysOk &= readColorArrayData(in, hg->getOrCreateColorArray(d, g, obj), colorCount, compression);
+						}
 
-					hflog("[HoudiniEngine::SLAVE] uv count: '%1%'", %uvCount);
-					for (int j = 0; j < uvCount; ++j) {
-						Vector3f uv;
-						in >> uv;
-						hg->addUV(uv, d, g, obj);
-					}
+						int uvCount = 0;
+						in >> uvCount;
+						hflog("[HoudiniEngine::SLAVE] uv count: '%1%'", %uvCount);
+						if (uvCount > 0) {
+							arraysOk &= readFloatArrayData(in, hg->getOrCreateUVArray(d, g, obj), uvCount, compression);
+						}
+
+						// primitive set count
+						int psCount = 0;
+						in >> psCount;
+
+						hflog("[HoudiniEngine::SLAVE] primitive set count: '%1%'", %psCount);
+
+						for (int j = 0; j < psCount; ++j) {
+							osg::PrimitiveSet::Mode mode;
+							int startIndex, count;
+							in >> mode >> startIndex >> count;
+							if (startIndex < 0) {
+								// indexed set, count is the number of indices
+								hflog("[HoudiniEngine::SLAVE]   ps%1%: %2% indices %3%", %j %mode %count);
+								osg::DrawElementsUInt* de = hg->addPrimitiveElements(mode, d, g, obj);
+								arraysOk &= readFloatArrayData(in, de, count, compression);
+								continue;
+							}
+							hflog("[HoudiniEngine::SLAVE]   ps%1%: %2% %3% %4%", %j %mode %startIndex %count);
+							hg->addPrimitiveOsg(mode, startIndex, count, d, g, obj);
+						}
 
-					// primitive set count
-					int psCount = 0;
-					in >> psCount;
+						if (!arraysOk) {
+							ofwarn("[HoudiniEngine::SLAVE] corrupt compressed arrays for %1% O%2%G%3% D%4%",
+								%name %obj %g %d);
+						}
 
-					hflog("[HoudiniEngine::SLAVE] primitive set count: '%1%'", %psCount);
+						int matId = 0;
+						in >> matId;
+						hflog("[HoudiniEngine::SLAVE] setting matId to  %1% for D%2% G%3% O%4%", %matId %d %g %obj);
+						hg->setMatId(matId, d, g, obj);
 
-					for (int j = 0; j < psCount; ++j) {
-						osg::PrimitiveSet::Mode mode;
-						int startIndex, count;
-						in >> mode >> startIndex >> count;
-						hflog("[HoudiniEngine::SLAVE]   ps%1%: %2% %3% %4%", %j %mode %startIndex %count);
-						hg->addPrimitiveOsg(mode, startIndex, count, d, g, obj);
+						bool transparent = false;
+						in >> transparent;
+						hflog("[HoudiniEngine::SLAVE] setting part D%2% G%3% O%4% to %1%",
+							%(transparent ? "TRANSPARENT" : "OPAQUE") %d %g %obj);
+						hg->setTransparent(transparent, d, g, obj);
+
+						// shared state set for the material and transparency
+						apply_material_state(hg, d, g, obj);
 					}
 
-					int matId = 0;
-					in >> matId;
-					hflog("[HoudiniEngine::SLAVE] setting matId to  %1% for D%2% G%3% O%4%", %matId %d %g %obj);
-					hg->setMatId(matId, d, g, obj);
-
-					bool transparent = false;
-					in >> transparent;
-					hflog("[HoudiniEngine::SLAVE] setting part D%2% G%3% O%4% to %1%",
-						%(transparent ? "TRANSPARENT" : "OPAQUE") %d %g %obj);
-					hg->setTransparent(transparent, d, g, obj);
-
-					// set transparency rendering hint
-					osg::StateSet* ss = hg->getOsgNode(g, obj)->getDrawable(d)->getOrCreateStateSet();
-					if (transparent) {
-						ss->setRenderingHint(osg::StateSet::TRANSPARENT_BIN);
-						ss->setMode(GL_BLEND, osg::StateAttribute::ON | osg::StateAttribute::PROTECTED |
-						osg::StateAttribute::OVERRIDE);
+					int instanceCount = -1;
+					in >> instanceCount;
+					if (instanceCount >= 0) {
+						hflog("[HoudiniEngine::SLAVE] %1% instances of D%2% G%3% O%4%", %instanceCount %d %g %obj);
+						vector<osg::Matrixf> instances(instanceCount);
+						if (instanceCount > 0 &&
+							!readBlob(in, &instances[0], instanceCount * sizeof(osg::Matrixf), sizeof(float))) {
+							ofwarn("[HoudiniEngine::SLAVE] corrupt instances for %1% O%2%G%3% D%4%",
+								%name %obj %g %d);
+							instances.clear();
+						}
+						hg->setInstances(instances, d, g, obj);
 					} else {
-						ss->setRenderingHint(osg::StateSet::OPAQUE_BIN);
-						ss->setMode(GL_BLEND, osg::StateAttribute::OFF | osg::StateAttribute::PROTECTED |
-						osg::StateAttribute::OVERRIDE);
+						hg->clearInstances(d, g, obj);
 					}
 
-
+					hg->dirtyDrawable(d, g, obj);
 				}
 			}
 		}
-
-		hg->dirty();
     }
 
 	hlog("[HoudiniEngine::SLAVE] done reading geometry, about to read materials");
@@ -562,44 +619,6 @@ void HoudiniEngine::updateSharedData(SharedIStream& in)
 					ms.parms[parm].stringValues.push_back(val);
 					hflog("[HoudiniEngine::SLAVE] read string: %1%", %val);
 				}
-
-				/*
-				hflog("[HoudiniEngine::SLAVE] read in Pixel Data for %1%", %val);
-				int w, h;
-				size_t size;
-				in >> w >> h;
-				in >> size;
-				hflog("[HoudiniEngine::SLAVE] read in Pixel Data w %1% h %2% and size %3%", %w %h %size);
-				Ref<PixelData> pd = PixelData::create(w, h, PixelData::FormatRgba);
-				byte* imgptr = pd->map();
-				in.read(imgptr, size);
-				pd->unmap();
-				pd->setDirty(true);
-				osg::Texture2D* texture = mySceneManager->createTexture(val, pd);
-				osg::Texture::WrapMode textureWrapMode;
-				textureWrapMode = osg::Texture::REPEAT;
-
-				texture->setWrap(osg::Texture2D::WRAP_R, textureWrapMode);
-				texture->setWrap(osg::Texture2D::WRAP_S, textureWrapMode);
-				texture->setWrap(osg::Texture2D::WRAP_T, textureWrapMode);
-
-				hflog("[HoudiniEngine::SLAVE] (Hopefully) setting material parm %1% to %2% for asset %3%",
-					%parm
-					%val
-					%matName
-				);
-				// todo: move this somewhere more sensible
-				if (parm == "diffuseMapName") {
-					hlog("[HoudiniEngine::SLAVE] setting diffuse map");
-					assetInstances[matName]->setEffect("houdini -d white");
-					assetInstances[matName]->getMaterial()->setDiffuseTexture(val);
-				}
-				if (parm == "normalMapName") {
-					hlog("[HoudiniEngine::SLAVE] setting normal map");
-					assetInstances[matName]->setEffect("houdini -d white");
-					assetInstances[matName]->getMaterial()->setNormalTexture(val);
-				}
-				*/
 			}
 			hflog("[HoudiniEngine::SLAVE] about to add %1% to assetMaterialParms", %matName);
 			assetMaterialParms[matName].push_back(ms);
@@ -607,139 +626,354 @@ void HoudiniEngine::updateSharedData(SharedIStream& in)
 		}
 
 		hflog("[HoudiniEngine::SLAVE] about to apply material parms on %1%", %matName);
-		// TODO: this should be its own method..
-		if (assetInstances.count(matName)) {
-			hflog("[HoudiniEngine::SLAVE] applying parms to asset instance %1%", %matName);
-
-			// this should work as there is already an assetInstance
-			HoudiniGeometry* hg = myHoudiniGeometrys[matName];
-
-			// apply materials
-			for (int j = 0; j < assetMaterialParms[matName].size(); ++j) {
-				MatStruct* ms = &(assetMaterialParms[matName][j]);
-
-				// look through all drawables in the hg and match against matIds
-				for (int o = 0; o < hg->getObjectCount(); ++o) {
-					for (int g = 0; g < hg->getGeodeCount(o); ++g) {
-						for (int d = 0; d < hg->getDrawableCount(g, o); ++d) {
-							hflog("[HoudiniEngine::SLAVE] compare ms->matId %1% D%2% G%3% O%4% matId %5%",
-								%ms->matId %d %g %o %hg->getMatId(d, g, o));
-							if (hg->getMatId(d, g, o) == ms->matId) {
-								hflog("[HoudiniEngine::SLAVE] found partId D%1% G%2% O%3%",
-									%d %g %o
-								);
+		apply_material_parms(matName);
 
-								osg::StateSet* ss =  hg->getOsgNode(g, o)->getDrawable(d)->getOrCreateStateSet();
-								// NB: This overwrites shader info set elsewhere so ignoring it for now..
-								// if i have ambient..
-								// if (ms->parms.count("ogl_amb")) {
-								// 	Ref<osg::Material> mat = static_cast<osg::Material*>(ss->getAttribute(osg::StateAttribute::MATERIAL));
-								// 	if (mat == NULL) {
-								// 		mat = new osg::Material();
-								// 	}
-								// 	mat->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(
-								// 		ms->parms["ogl_amb"].floatValues[0],
-								// 		ms->parms["ogl_amb"].floatValues[1],
-								// 		ms->parms["ogl_amb"].floatValues[2],
-								// 		1.0
-								// 	));
-								// 	ss->setAttributeAndModes(mat,
-								// 		osg::StateAttribute::ON | osg::StateAttribute::PROTECTED |
-								// 		osg::StateAttribute::OVERRIDE);
-
-								// 	hflog("[HoudiniEngine::SLAVE] applied ogl_amb to %1%:part %2%", %matName %ms->partId);
-								// }
-								// if i have emit..
-								if (ms->parms.count("ogl_emit")) {
-									Ref<osg::Material> mat = static_cast<osg::Material*>(ss->getAttribute(osg::StateAttribute::MATERIAL));
-									if (mat == NULL) {
-										mat = new osg::Material();
-									}
-									mat->setEmission(osg::Material::FRONT_AND_BACK, osg::Vec4(
-										ms->parms["ogl_emit"].floatValues[0],
-										ms->parms["ogl_emit"].floatValues[1],
-										ms->parms["ogl_emit"].floatValues[2],
-										1.0
-									));
-									ss->setAttributeAndModes(mat,
-										osg::StateAttribute::ON | osg::StateAttribute::PROTECTED |
-										osg::StateAttribute::OVERRIDE);
-
-									hflog("[HoudiniEngine::SLAVE] applied ogl_emit to %1%:part %2%", %matName %ms->partId);
-								}
-								// if i have diffuse..
-								if (ms->parms.count("ogl_diff")) {
-									Ref<osg::Material> mat = static_cast<osg::Material*>(ss->getAttribute(osg::StateAttribute::MATERIAL));
-									if (mat == NULL) {
-										mat = new osg::Material();
-									}
-									mat->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(
-										ms->parms["ogl_diff"].floatValues[0],
-										ms->parms["ogl_diff"].floatValues[1],
-										ms->parms["ogl_diff"].floatValues[2],
-										1.0
-									));
-									ss->setAttributeAndModes(mat,
-										osg::StateAttribute::ON | osg::StateAttribute::PROTECTED |
-										osg::StateAttribute::OVERRIDE);
-
-									hflog("[HoudiniEngine::SLAVE] applied ogl_diff to %1%:part %2%", %matName %ms->partId);
-								}
-								// NB: This overwrites shader info set elsewhere so ignoring it for now..
-								// // if i have spec..
-								// if (ms->parms.count("ogl_spec")) {
-								// 	Ref<osg::Material> mat = static_cast<osg::Material*>(ss->getAttribute(osg::StateAttribute::MATERIAL));
-								// 	if (mat == NULL) {
-								// 		mat = new osg::Material();
-								// 	}
-								// 	mat->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(
-								// 		ms->parms["ogl_spec"].floatValues[0],
-								// 		ms->parms["ogl_spec"].floatValues[1],
-								// 		ms->parms["ogl_spec"].floatValues[2],
-								// 		1.0
-								// 	));
-								// 	ss->setAttributeAndModes(mat,
-								// 		osg::StateAttribute::ON | osg::StateAttribute::PROTECTED |
-								// 		osg::StateAttribute::OVERRIDE);
-
-								// 	hflog("[HoudiniEngine::SLAVE] applied ogl_spec to %1%:part %2%", %matName %ms->partId);
-								// }
-								// if i have diffuse..
-								if (ms->parms.count("ogl_alpha")) {
-									// update the state set for this attribute
-									if (assetInstances.count(hg->getName()) > 0) {
-										const string name = "unif_alpha";
-										osg::Uniform* u =  ss->getOrCreateUniform(name, osg::Uniform::FLOAT, 1);
-										u->set(ms->parms["ogl_apha"].floatValues[0]);
-
-										ss->getUniformList()[name].second = osg::StateAttribute::ON | osg::StateAttribute::PROTECTED |
-											osg::StateAttribute::OVERRIDE;
-
-										// set as transparent
-										if (ms->parms["ogl_apha"].floatValues[0] < 0.95) {
-											ss->setRenderingHint(osg::StateSet::TRANSPARENT_BIN);
-											ss->setMode(GL_BLEND, osg::StateAttribute::ON | osg::StateAttribute::PROTECTED |
-											osg::StateAttribute::OVERRIDE);
-										} else {
-											ss->setRenderingHint(osg::StateSet::OPAQUE_BIN);
-											ss->setMode(GL_BLEND, osg::StateAttribute::OFF | osg::StateAttribute::PROTECTED |
-											osg::StateAttribute::OVERRIDE);
-										}
-									}
-
-									hflog("[HoudiniEngine::SLAVE] applied ogl_alpha to %1%:part %2%", %matName %ms->partId);
-								}
-							}
-						}
-					}
+	}
+	hlog("[HoudiniEngine::SLAVE] end updateSharedData");
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// set the state sets of an asset's drawables from its assetMaterialParms,
+// on slaves and when the master loads a cook from the cook cache
+void HoudiniEngine::apply_material_parms(const String& asset_name)
+{
+	if (assetInstances.count(asset_name)) {
+		hflog("[HoudiniEngine::apply_material_parms] applying parms to asset instance %1%", %asset_name);
+
+		// this should work as there is already an assetInstance
+		HoudiniGeometry* hg = myHoudiniGeometrys[asset_name];
+
+		// each drawable takes the state set of its material
+		for (int o = 0; o < hg->getObjectCount(); ++o) {
+			for (int g = 0; g < hg->getGeodeCount(o); ++g) {
+				for (int d = 0; d < hg->getDrawableCount(g, o); ++d) {
+					apply_material_state(hg, d, g, o);
 				}
 			}
-			hflog("[HoudiniEngine::SLAVE] finished applying material parms on %1%", %matName);
-		} else {
-			hflog("[HoudiniEngine::SLAVE] no %1% asset instance", %matName);
 		}
+		hflog("[HoudiniEngine::apply_material_parms] finished applying material parms on %1%", %asset_name);
+	} else {
+		hflog("[HoudiniEngine::apply_material_parms] no %1% asset instance", %asset_name);
+	}
+}
 
+// the asset's MatStruct of a material id, NULL if it has none. The index
+// is rebuilt when it's out of step, ie. after assetMaterialParms was
+// replaced by the slaves' update or a cook cache load
+HoudiniEngine::MatStruct* HoudiniEngine::find_material(const String& asset_name, const int matId)
+{
+	if (matId < 0 || assetMaterialParms.count(asset_name) == 0) {
+		return NULL;
+	}
+
+	Vector<MatStruct>& materials = assetMaterialParms[asset_name];
+	Dictionary<int, int>& index = myAssetMaterialIndex[asset_name];
+	if (index.count(matId) > 0) {
+		const int i = index[matId];
+		if (i < materials.size() && materials[i].matId == matId) {
+			return &materials[i];
+		}
+	}
+
+	index.clear();
+	for (int i = int(materials.size()) - 1; i >= 0; --i) {
+		index[materials[i].matId] = i;
+	}
+	return index.count(matId) > 0 ? &materials[index[matId]] : NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// the state set for a material (NULL for none) and transparency. Drawables
+// with equal values get the same one, so osg sorts them together.
+// Ambient and specular would overwrite the effect's, so only emission,
+// diffuse and alpha go in
+osg::StateSet* HoudiniEngine::material_state(const MatStruct* ms, const bool transparent)
+{
+	const char* names[] = { "ogl_emit", "ogl_diff", "ogl_alpha" };
+	const int nameCount = sizeof(names) / sizeof(names[0]);
+
+	// the values, -1 for a parm the material doesn't have
+	const Vector<float>* values[nameCount];
+	HashValue key = hashBytes(&transparent, sizeof(transparent));
+	for (int i = 0; i < nameCount; ++i) {
+		values[i] = NULL;
+		if (ms != NULL) {
+			Dictionary<String, ParmStruct>::const_iterator it = ms->parms.find(names[i]);
+			if (it != ms->parms.end()) {
+				values[i] = &it->second.floatValues;
+			}
+		}
+		int count = values[i] == NULL ? -1 : int(values[i]->size());
+		key = hashBytes(&count, sizeof(count), key);
+		if (count > 0) {
+			key = hashBytes(&values[i]->front(), count * sizeof(float), key);
+		}
+	}
+
+	if (myMaterialStates.count(key) > 0) {
+		return myMaterialStates[key].get();
+	}
+
+	// drop the state sets nothing uses any more
+	typedef Dictionary<HashValue, Ref<osg::StateSet> > States;
+	Vector<HashValue> unused;
+	foreach(States::Item state, myMaterialStates) {
+		if (state.second->getNumParents() == 0) {
+			unused.push_back(state.first);
+		}
+	}
+	for (int i = 0; i < unused.size(); ++i) {
+		myMaterialStates.erase(unused[i]);
+	}
+
+	const osg::StateAttribute::GLModeValue on = osg::StateAttribute::ON | osg::StateAttribute::PROTECTED |
+		osg::StateAttribute::OVERRIDE;
+	const osg::StateAttribute::GLModeValue off = osg::StateAttribute::OFF | osg::StateAttribute::PROTECTED |
+		osg::StateAttribute::OVERRIDE;
+
+	osg::StateSet* ss = new osg::StateSet();
+
+	const Vector<float>* emit = values[0];
+	const Vector<float>* diff = values[1];
+	const Vector<float>* alpha = values[2];
+	if ((emit != NULL && emit->size() >= 3) || (diff != NULL && diff->size() >= 3)) {
+		osg::Material* mat = new osg::Material();
+		if (emit != NULL && emit->size() >= 3) {
+			mat->setEmission(osg::Material::FRONT_AND_BACK, osg::Vec4((*emit)[0], (*emit)[1], (*emit)[2], 1.0));
+		}
+		if (diff != NULL && diff->size() >= 3) {
+			mat->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4((*diff)[0], (*diff)[1], (*diff)[2], 1.0));
+		}
+		ss->setAttributeAndModes(mat, on);
+	}
+
+	if (alpha != NULL && alpha->size() >= 1) {
+		const string name = "unif_alpha";
+		osg::Uniform* u = ss->getOrCreateUniform(name, osg::Uniform::FLOAT, 1);
+		u->set((*alpha)[0]);
+		ss->getUniformList()[name].second = on;
+	}
+
+	if (transparent) {
+		ss->setRenderingHint(osg::StateSet::TRANSPARENT_BIN);
+		ss->setMode(GL_BLEND, on);
+	} else {
+		ss->setRenderingHint(osg::StateSet::OPAQUE_BIN);
+		ss->setMode(GL_BLEND, off);
+	}
+
+	hflog("[HoudiniEngine::material_state] new state set %1% for material %2% (%3%)",
+		%key %(ms == NULL ? -1 : ms->matId) %(transparent ? "transparent" : "opaque"));
+	myMaterialStates[key] = ss;
+	return ss;
+}
+
+// give a drawable the shared state set of its material and transparency
+void HoudiniEngine::apply_material_state(HoudiniGeometry* hg, const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	const MatStruct* ms = find_material(hg->getName(), hg->getMatId(drawableIndex, geodeIndex, objIndex));
+	osg::StateSet* ss = material_state(ms, hg->isTransparent(drawableIndex, geodeIndex, objIndex));
+	hg->getOsgNode(geodeIndex, objIndex)->getDrawable(drawableIndex)->setStateSet(ss);
+}
+
+int HoudiniEngine::getMaterialStateSets()
+{
+	typedef Dictionary<HashValue, Ref<osg::StateSet> > States;
+	int used = 0;
+	foreach(States::Item state, myMaterialStates) {
+		if (state.second->getNumParents() > 0) {
+			used++;
+		}
+	}
+	return used;
+}
+
+int HoudiniEngine::getMaterialStateDrawables()
+{
+	typedef Dictionary<HashValue, Ref<osg::StateSet> > States;
+	int drawables = 0;
+	foreach(States::Item state, myMaterialStates) {
+		drawables += state.second->getNumParents();
+	}
+	return drawables;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// master: queue a texture the master just installed for the slaves. The
+// binding always goes, the pixels only if no image with the same content
+// went out before
+void HoudiniEngine::share_texture(const String& asset_name, const String& name, const int slot, PixelData* pixels)
+{
+	if (!SystemManager::instance()->isMaster() || pixels == NULL) {
+		return;
+	}
+
+	TextureBinding binding;
+	binding.name = name;
+	binding.asset = asset_name;
+	binding.slot = slot;
+	binding.width = pixels->getWidth();
+	binding.height = pixels->getHeight();
+	binding.hash = hashBytes(&binding.width, sizeof(binding.width));
+	binding.hash = hashBytes(&binding.height, sizeof(binding.height), binding.hash);
+	binding.hash = hashBytes(pixels->map(), pixels->getSize(), binding.hash);
+	pixels->unmap();
+
+	myTextureBindings.push_back(binding);
+
+	if (mySharedTextures.count(binding.hash) > 0) {
+		hflog("[HoudiniEngine::share_texture] %1% already sent as %2%", %name %binding.hash);
+		return;
+	}
+	mySharedTextures[binding.hash] = true;
+
+	TextureSend send;
+	send.hash = binding.hash;
+	send.pixels = pixels;
+	send.offset = 0;
+	myTextureSends.push_back(send);
+
+	hflog("[HoudiniEngine::share_texture] queued %1% (%2%x%3%, %4% bytes) as %5%",
+		%name %binding.width %binding.height %pixels->getSize() %binding.hash);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// master: the pending bindings, then as many image chunks as the frame
+// budget allows, oldest image first
+void HoudiniEngine::commit_textures(SharedOStream& out)
+{
+	out << int(myTextureBindings.size());
+	for (int i = 0; i < myTextureBindings.size(); ++i) {
+		const TextureBinding& b = myTextureBindings[i];
+		out << b.name << b.asset << b.slot << b.hash << b.width << b.height;
+	}
+	myTextureBindings.clear();
+
+	// work out the chunks (image, byte count) first, their count goes
+	// ahead of them
+	vector<std::pair<TextureSend*, int> > chunks;
+	int budget = myTextureFrameBudget;
+	for (List<TextureSend>::iterator it = myTextureSends.begin(); it != myTextureSends.end(); ++it) {
+		if (myTextureFrameBudget > 0 && budget <= 0) {
+			break;
+		}
+		int size = int(it->pixels->getSize()) - it->offset;
+		if (myTextureFrameBudget > 0) {
+			size = std::min(size, budget);
+			budget -= size;
+		}
+		chunks.push_back(std::make_pair(&(*it), size));
+	}
+
+	out << int(chunks.size());
+	for (int i = 0; i < chunks.size(); ++i) {
+		TextureSend* send = chunks[i].first;
+		const int size = chunks[i].second;
+		const int total = int(send->pixels->getSize());
+
+		out << send->hash << send->pixels->getWidth() << send->pixels->getHeight();
+		out << total << send->offset << size;
+		out.write(send->pixels->map() + send->offset, size);
+		send->pixels->unmap();
+
+		hflog("[HoudiniEngine::MASTER] texture %1%: sent %2% bytes at %3% of %4%",
+			%send->hash %size %send->offset %total);
+		send->offset += size;
+	}
+
+	// drop the images that are all out
+	while (!myTextureSends.empty() &&
+		myTextureSends.front().offset >= int(myTextureSends.front().pixels->getSize())) {
+		myTextureSends.pop_front();
 	}
-	hlog("[HoudiniEngine::SLAVE] end updateSharedData");
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// slaves: copy the chunks into their images, and install every texture
+// whose image is complete
+void HoudiniEngine::update_textures(SharedIStream& in)
+{
+	int bindingCount = 0;
+	in >> bindingCount;
+	for (int i = 0; i < bindingCount; ++i) {
+		TextureBinding b;
+		in >> b.name >> b.asset >> b.slot >> b.hash >> b.width >> b.height;
+		hflog("[HoudiniEngine::SLAVE] texture %1% of %2% is %3%", %b.name %b.asset %b.hash);
+		myWaitingTextures.push_back(b);
+	}
+
+	int chunkCount = 0;
+	in >> chunkCount;
+	for (int i = 0; i < chunkCount; ++i) {
+		HashValue hash;
+		int width, height, total, offset, size;
+		in >> hash >> width >> height;
+		in >> total >> offset >> size;
+
+		TextureImage& image = myTextureImages[hash];
+		if (image.pixels == NULL) {
+			image.pixels = PixelData::create(width, height, PixelData::FormatRgba);
+		}
+
+		if (offset < 0 || size < 0 || offset + size > int(image.pixels->getSize())) {
+			ofwarn("[HoudiniEngine::SLAVE] bad chunk for texture %1%: %2% bytes at %3% of %4%",
+				%hash %size %offset %image.pixels->getSize());
+			vector<char> skip(std::max(size, 0));
+			if (!skip.empty()) {
+				in.read(&skip[0], size);
+			}
+			continue;
+		}
+
+		in.read(image.pixels->map() + offset, size);
+		image.pixels->unmap();
+		image.received += size;
+		hflog("[HoudiniEngine::SLAVE] texture %1%: %2% of %3% bytes", %hash %image.received %total);
+
+		if (image.received >= total) {
+			image.pixels->setDirty(true);
+		}
+	}
+
+	// install textures whose images are all here, in the order the master
+	// bound them
+	List<TextureBinding>::iterator it = myWaitingTextures.begin();
+	while (it != myWaitingTextures.end()) {
+		if (myTextureImages.count(it->hash) == 0) {
+			++it;
+			continue;
+		}
+		TextureImage& image = myTextureImages[it->hash];
+		if (image.pixels == NULL || image.received < int(image.pixels->getSize())) {
+			++it;
+			continue;
+		}
+
+		hflog("[HoudiniEngine::SLAVE] installing texture %1% (%2%x%3%)", %it->name %it->width %it->height);
+		install_texture(it->name, image.pixels);
+		if (assetInstances.count(it->asset) > 0) {
+			if (it->slot == NORMAL_MAP) {
+				assetInstances[it->asset]->getMaterial()->setNormalTexture(it->name);
+			} else {
+				assetInstances[it->asset]->getMaterial()->setDiffuseTexture(it->name);
+			}
+		}
+		it = myWaitingTextures.erase(it);
+	}
+}
+
+int HoudiniEngine::getTexturesPending()
+{
+	if (SystemManager::instance()->isMaster()) {
+		return int(myTextureSends.size());
+	}
+
+	typedef Dictionary<HashValue, TextureImage> Images;
+	int pending = 0;
+	foreach(Images::Item image, myTextureImages) {
+		if (image.second.received < int(image.second.pixels->getSize())) {
+			pending++;
+		}
+	}
+	return pending;
+}
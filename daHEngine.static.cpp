@@ -52,14 +52,19 @@ static std::string houdiniEngine::get_string(HAPI_Session* session, int string_h
     if (string_handle == 0)
 	return "";
 
+    // shares hapi::getString's cache, cleared when an asset cooks
+    std::string result;
+    if (hapi::StringCache::instance().find(session, string_handle, result))
+	return result;
+
     int buffer_length;
     ENSURE_SUCCESS(session, HAPI_GetStringBufLength(session, string_handle, &buffer_length));
 
-    char * buf = new char[ buffer_length ];
+    std::vector<char> buf(buffer_length + 1, '\0');
 
-    ENSURE_SUCCESS(session, HAPI_GetString(session, string_handle, buf, buffer_length));
+    ENSURE_SUCCESS_BYTES(session, buffer_length, HAPI_GetString(session, string_handle, &buf[0], buffer_length));
 
-    std::string result( buf );
-    delete[] buf;
+    result = &buf[0];
+    hapi::StringCache::instance().insert(session, string_handle, result);
     return result;
 }
@@ -44,6 +44,8 @@ daHEngine
 #include <daHoudiniEngine/houdiniParameter.h>
 #include <daHoudiniEngine/UI/houdiniUiParm.h>
 
+#include <algorithm>
+
 using namespace houdiniEngine;
 
 void HoudiniEngine::setLoggingEnabled(const bool toggle) {
@@ -54,7 +56,7 @@ float HoudiniEngine::getFps()
 {
 	if (SystemManager::instance()->isMaster()) {
 		HAPI_TimelineOptions to;
-		HAPI_GetTimelineOptions(session, &to);
+		HAPI_TRACE(sizeof(HAPI_TimelineOptions), HAPI_GetTimelineOptions(session, &to));
 
 		return to.fps;
 	}
@@ -68,7 +70,7 @@ float HoudiniEngine::getTime()
 	float myTime = -1.0;
 
 	if (SystemManager::instance()->isMaster()) {
-		HAPI_GetTime(session, &myTime);
+		HAPI_TRACE(sizeof(float), HAPI_GetTime(session, &myTime));
 	}
 
 	return myTime;
@@ -77,7 +79,9 @@ float HoudiniEngine::getTime()
 void HoudiniEngine::setTime(float time)
 {
 	if (SystemManager::instance()->isMaster()) {
-		HAPI_SetTime(session, time);
+		foreach(HAPI_Session* s, mySessions) {
+			HAPI_TRACE(0, HAPI_SetTime(s, time));
+		}
 	}
 }
 
@@ -88,6 +92,17 @@ void HoudiniEngine::cook()
 		return;
 	}
 
+	// with a session pool the sessions cook their assets side by side, each
+	// asset is processed as soon as its own cook is done
+	if (mySessions.size() > 1 && !myAsyncCooking && myCookInterval < 0) {
+		foreach(Mapping::Item asset, instancedHEAssets) {
+			myCooksRequested++;
+			queue_cook(asset.first);
+		}
+		drain_cooks();
+		return;
+	}
+
 	foreach(Mapping::Item asset, instancedHEAssets) {
         cook_one(asset.second);
 	}
@@ -95,12 +110,45 @@ void HoudiniEngine::cook()
 
 void HoudiniEngine::cook_one(hapi::Asset* asset) 
 {
+    if (asset == NULL) {
+        return;
+    }
+
+    myCooksRequested++;
+
+    if (myCookInterval >= 0) {
+        // merged with any other request for this asset until the next flush
+        if (!is_scheduled(pool_asset_id(*asset))) {
+            myScheduledCooks.push_back(pool_asset_id(*asset));
+        }
+        return;
+    }
+
+    cook_now(asset);
+}
+
+// cook with the parameter values set so far, queued for update() when cooking
+// asynchronously
+void HoudiniEngine::cook_now(hapi::Asset* asset)
+{
+    if (myAsyncCooking) {
+        queue_cook(pool_asset_id(*asset));
+        return;
+    }
+
     if (asset != NULL) {
 
-        hflog("[HoudiniEngine::cook_one] cooking %1%..", %asset->name());
+        // seen these parameter values before, skip Houdini altogether
+        String cachePath = cook_cache_path(*asset);
+        if (!cachePath.empty() && load_cooked(asset->name(), cachePath)) {
+            return;
+        }
+
+        hflog("[HoudiniEngine::cook_now] cooking %1%..", %asset->name());
 
+        myCooksPerformed++;
         asset->cook(&myCookOptions);
-        wait_for_cook();
+        wait_for_cook(asset->session);
 
 		// old way of refreshing parms
 		// foreach(Ref <ReferenceType> ref, uiParms[asset->id]) {
@@ -134,9 +182,270 @@ void HoudiniEngine::cook_one(hapi::Asset* asset)
 		omsg("Parms re-created");
 		*/
         updateGeos = true;
+
+        if (!cachePath.empty()) {
+            store_cooked(asset->name(), cachePath);
+        }
     }
 }
 
+bool HoudiniEngine::is_scheduled(const int asset_id)
+{
+	return std::find(myScheduledCooks.begin(), myScheduledCooks.end(), asset_id) != myScheduledCooks.end();
+}
+
+// cook each scheduled asset once, no sooner than myCookInterval after the
+// previous flush
+void HoudiniEngine::flush_cooks(const double time)
+{
+	if (myScheduledCooks.empty() || time - myLastCookFlush < myCookInterval) {
+		return;
+	}
+
+	myLastCookFlush = time;
+
+	List<int> scheduled;
+	scheduled.swap(myScheduledCooks);
+
+	// pooled sessions cook the lot side by side, see cook()
+	if (mySessions.size() > 1 && !myAsyncCooking) {
+		foreach(int asset_id, scheduled) {
+			queue_cook(asset_id);
+		}
+		drain_cooks();
+		return;
+	}
+
+	foreach(int asset_id, scheduled) {
+		hapi::Asset asset = pool_asset(asset_id);
+		cook_now(&asset);
+
+		// synchronous cooks are done by now, run their onCookDone commands
+		if (!myAsyncCooking && myCookDoneCommands.count(asset_id) > 0) {
+			Vector<String> commands;
+			commands.swap(myCookDoneCommands[asset_id]);
+			myCookDoneCommands.erase(asset_id);
+			run_commands(commands);
+		}
+	}
+}
+
+// async cooking: an asset already waiting for its cook picks up the new
+// parameter values anyway, so it is only queued once
+void HoudiniEngine::queue_cook(const int asset_id)
+{
+	if (std::find(myCookQueue.begin(), myCookQueue.end(), asset_id) != myCookQueue.end()) {
+		hflog("[HoudiniEngine::queue_cook] %1% already queued", %asset_id);
+		return;
+	}
+
+	hflog("[HoudiniEngine::queue_cook] queueing %1%", %asset_id);
+	myCookQueue.push_back(asset_id);
+}
+
+// called every frame on the master. Never blocks: checks the running cooks,
+// processes their assets when ready, then starts the queued cooks whose
+// session is idle
+void HoudiniEngine::update_cooks()
+{
+	if (myRunningCooks.empty()) {
+		// no sessions yet
+		return;
+	}
+
+	for (int i = 0; i < myRunningCooks.size(); ++i) {
+		RunningCook& running = myRunningCooks[i];
+		if (running.asset < 0) {
+			continue;
+		}
+
+		int status = HAPI_STATE_READY_WITH_FATAL_ERRORS;
+		if (HAPI_TRACE(sizeof(int), HAPI_GetStatus(mySessions[i], HAPI_STATUS_COOK_STATE, &status)) != HAPI_RESULT_SUCCESS) {
+			// can't tell how the cook went, count it as failed
+			ofwarn("[HoudiniEngine::update_cooks] no cook state for session %1%: %2%",
+				%i %hapi::Failure::lastErrorMessage(mySessions[i]));
+			status = HAPI_STATE_READY_WITH_FATAL_ERRORS;
+		}
+		if (status > HAPI_STATE_MAX_READY_STATE) {
+			// still cooking, look again next frame
+			continue;
+		}
+
+		int asset_id = running.asset;
+		running.asset = -1;
+		// anything read while the cook ran is stale now
+		hapi::newCookGeneration();
+
+		hapi::Asset asset = pool_asset(asset_id);
+		if (status == HAPI_STATE_READY) {
+			hflog("[HoudiniEngine::update_cooks] cooked %1%", %asset_id);
+			process_asset(asset);
+			updateGeos = true;
+
+			if (!running.cachePath.empty()) {
+				store_cooked(asset.name(), running.cachePath);
+			}
+		} else {
+			ofwarn("[HoudiniEngine::update_cooks] cook of %1% failed: %2%",
+				%asset_id %hapi::Failure::lastCookErrorMessage(asset.session));
+		}
+
+		Vector<String> commands;
+		commands.swap(running.commands);
+		run_commands(commands);
+	}
+
+	// oldest first, but an asset whose session is busy doesn't hold up the
+	// ones behind it on other sessions
+	List<int>::iterator it = myCookQueue.begin();
+	while (it != myCookQueue.end()) {
+		int asset_id = *it;
+		hapi::Asset asset = pool_asset(asset_id);
+		RunningCook& running = myRunningCooks[session_index(asset.session)];
+		if (running.asset >= 0) {
+			++it;
+			continue;
+		}
+		it = myCookQueue.erase(it);
+
+		Vector<String> commands;
+		if (myCookDoneCommands.count(asset_id) > 0) {
+			commands = myCookDoneCommands[asset_id];
+			myCookDoneCommands.erase(asset_id);
+		}
+
+		String cachePath = cook_cache_path(asset);
+		if (!cachePath.empty() && load_cooked(asset.name(), cachePath)) {
+			// nothing to wait for
+			run_commands(commands);
+			continue;
+		}
+
+		hflog("[HoudiniEngine::update_cooks] cooking %1% on session %2%..",
+			%asset_id %session_index(asset.session));
+		myCooksPerformed++;
+		asset.cook(&myCookOptions);
+		running.asset = asset_id;
+		running.commands = commands;
+		running.cachePath = cachePath;
+	}
+}
+
+// blocks until every queued cook is done and processed
+void HoudiniEngine::drain_cooks()
+{
+	update_cooks();
+	while (!myCookQueue.empty() || running_cook(-1) != NULL) {
+		osleep(10);
+		update_cooks();
+	}
+}
+
+// the running cook of an asset, with -1 any running cook. NULL if none
+HoudiniEngine::RunningCook* HoudiniEngine::running_cook(const int asset_id)
+{
+	for (int i = 0; i < myRunningCooks.size(); ++i) {
+		int running = myRunningCooks[i].asset;
+		if (running >= 0 && (asset_id < 0 || running == asset_id)) {
+			return &myRunningCooks[i];
+		}
+	}
+	return NULL;
+}
+
+void HoudiniEngine::run_commands(const Vector<String>& commands)
+{
+	PythonInterpreter* pi = SystemManager::instance()->getScriptInterpreter();
+	for (int i = 0; i < commands.size(); ++i) {
+		pi->queueCommand(commands[i]);
+	}
+}
+
+bool HoudiniEngine::isCooking(const String& asset_name)
+{
+	if (assetNameToIds.count(asset_name) == 0) {
+		return false;
+	}
+
+	int asset_id = assetNameToIds[asset_name];
+	return running_cook(asset_id) != NULL || is_scheduled(asset_id) ||
+		std::find(myCookQueue.begin(), myCookQueue.end(), asset_id) != myCookQueue.end();
+}
+
+void HoudiniEngine::onCookDone(const String& asset_name, const String& command)
+{
+	if (!SystemManager::instance()->isMaster()) {
+		return;
+	}
+
+	if (assetNameToIds.count(asset_name) == 0) {
+		ofwarn("[HoudiniEngine::onCookDone] No asset of name %1%", %asset_name);
+		return;
+	}
+
+	int asset_id = assetNameToIds[asset_name];
+	if (is_scheduled(asset_id) ||
+		std::find(myCookQueue.begin(), myCookQueue.end(), asset_id) != myCookQueue.end()) {
+		myCookDoneCommands[asset_id].push_back(command);
+	} else if (running_cook(asset_id) != NULL) {
+		running_cook(asset_id)->commands.push_back(command);
+	} else {
+		Vector<String> commands;
+		commands.push_back(command);
+		run_commands(commands);
+	}
+}
+
+int HoudiniEngine::getAssetSession(const String& asset_name)
+{
+	if (assetNameToIds.count(asset_name) == 0) {
+		return -1;
+	}
+	return assetNameToIds[asset_name] / SESSION_ID_STRIDE;
+}
+
+// the pool session with the fewest assets, the first on a tie
+HAPI_Session* HoudiniEngine::pick_session()
+{
+	Vector<int> assets(mySessions.size(), 0);
+	foreach(Mapping::Item item, instancedHEAssets) {
+		assets[session_index(item.second->session)]++;
+	}
+
+	int best = 0;
+	for (int i = 1; i < assets.size(); ++i) {
+		if (assets[i] < assets[best]) {
+			best = i;
+		}
+	}
+	return mySessions.empty() ? session : mySessions[best];
+}
+
+int HoudiniEngine::session_index(const HAPI_Session* s)
+{
+	for (int i = 0; i < mySessions.size(); ++i) {
+		if (mySessions[i] == s) {
+			return i;
+		}
+	}
+	return 0;
+}
+
+// the id the module knows an asset by, see SESSION_ID_STRIDE
+int HoudiniEngine::pool_asset_id(const hapi::Asset& asset)
+{
+	return asset.nodeid + session_index(asset.session) * SESSION_ID_STRIDE;
+}
+
+hapi::Asset HoudiniEngine::pool_asset(const int asset_id)
+{
+	int i = asset_id / SESSION_ID_STRIDE;
+	if (i < 0 || i >= mySessions.size()) {
+		return hapi::Asset(asset_id, session);
+	}
+	return hapi::Asset(asset_id % SESSION_ID_STRIDE, mySessions[i]);
+}
+
 void HoudiniEngine::showMappings() {
 
 // 	typedef Dictionary < int, int >::iterator myIt;
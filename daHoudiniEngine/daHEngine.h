@@ -67,6 +67,7 @@ either expressed or implied, of the Data Arena Project.
 #include <omegaToolkit.h>
 
 #include "daHoudiniEngine/houdiniAsset.h"
+#include "daHoudiniEngine/sharedDataTools.h"
 
 #define hlog(msg) if(HoudiniEngine::isLoggingEnabled()) olog(StringUtils::logLevel, msg)
 #define hflog(fmt, args) if(HoudiniEngine::isLoggingEnabled()) oflog(StringUtils::logLevel, fmt, args)
@@ -75,6 +76,7 @@ either expressed or implied, of the Data Arena Project.
 #include <iostream>
 #include <string>
 #include <vector>
+#include <map>
 
 namespace houdiniEngine {
 	using namespace std;
@@ -86,8 +88,12 @@ namespace houdiniEngine {
 	typedef vector<String> MyList;
 
 #if DA_ENABLE_HENGINE > 0
-	#define ENSURE_SUCCESS(session, result) \
-	    if ((result) != HAPI_RESULT_SUCCESS) \
+	// checks a HAPI call, tracing it when hapi::Trace is on. The _BYTES
+	// form also counts the bytes of array data the call moves
+	#define ENSURE_SUCCESS(session, result) ENSURE_SUCCESS_BYTES(session, 0, result)
+
+	#define ENSURE_SUCCESS_BYTES(session, bytes, result) \
+	    if (HAPI_TRACE(bytes, result) != HAPI_RESULT_SUCCESS) \
 	    { \
 		oferror("failure at %1%:%2%", %__FILE__ %__LINE__); \
 		oferror("%1% '%2%'", %hapi::Failure::lastErrorMessage(session) %result);\
@@ -104,6 +110,9 @@ namespace houdiniEngine {
 
 	static std::string get_string(HAPI_Session* session, int string_handle);
 
+	// a part between reading it from HAPI and putting it in the scene graph
+	struct PartJob;
+
 	class HE_API RefAsset: public hapi::Asset, public ReferenceType
 	{
 	public:
@@ -161,35 +170,91 @@ namespace houdiniEngine {
 		void process_asset(
 			const hapi::Asset &asset
 		);
+		//! full ignores HAPI's change flags and rebuilds everything
 		void process_object(
 			const hapi::Object &object,
 			const int objIndex,
-			HoudiniGeometry* hg
+			HoudiniGeometry* hg,
+			vector<PartJob>& jobs,
+			const bool full
 		);
 		void process_geo(
 			const hapi::Geo &geo,
 			const int objIndex,
 			const int geoIndex,
+			HoudiniGeometry* hg,
+			vector<PartJob>& jobs,
+			const bool full
+		);
+		//! Sets up the instances of the parts a geo's instancer parts use
+		void process_instancers(
+			const hapi::Geo &geo,
+			const vector<hapi::Part>& parts,
+			const int objIndex,
+			const int geoIndex,
+			HoudiniGeometry* hg
+		);
+		//! Material processing only, for geos whose geometry is unchanged
+		void refresh_materials(
+			const hapi::Geo &geo,
 			HoudiniGeometry* hg
 		);
+		//! Reads a part from HAPI and queues it on jobs
 		void process_part(
 			const hapi::Part &part,
 			const int objIndex,
 			const int geoIndex,
 			const int partIndex,
-			HoudiniGeometry* hg
+			HoudiniGeometry* hg,
+			vector<PartJob>& jobs
 		);
 
+		//! Builds the osg arrays of a part read by process_part. No HAPI
+		//! or scene graph access, so it can run on a worker thread
+		static void convert_part(PartJob& job);
+		void convert_parts(vector<PartJob>& jobs);
+		//! Hands a converted part to the geometry, main thread only
+		void apply_part(PartJob& job, HoudiniGeometry* hg);
+
 		void process_materials(
 			const hapi::Part &part,
 			HoudiniGeometry* hg
 		);
+		//! Creates the texture of a material's map parameter. The image is
+		//! only extracted from Houdini when the material or the map changed
+		void load_material_texture(
+			const hapi::Part &part,
+			const HAPI_MaterialInfo &mat_info,
+			const int parmId,
+			const String& value,
+			const String& textureName,
+			const int slot
+		);
+		//! Renders and extracts a material's map into rgba pixels, NULL if
+		//! the image can't be converted
+		PixelData* extract_image(
+			HAPI_Session* s,
+			const HAPI_NodeId material,
+			const int parmId
+		);
 
 		void process_float_attrib(
 		    const hapi::Part &part, HAPI_AttributeOwner attrib_owner,
 		    const char *attrib_name, vector<Vector3f>& points
 		);
 
+		//! Reads an attribute into presized storage, elements stride floats
+		//! apart (eg. straight into an osg::Vec4Array). Returns the count
+		int process_float_attrib(
+		    const hapi::Part &part, HAPI_AttributeOwner attrib_owner,
+		    const char *attrib_name, float* data, const int stride
+		);
+
+		void read_float_attrib(
+		    const hapi::Part &part, HAPI_AttributeInfo &attrib_info,
+		    const char *attrib_name, float* data, const int stride
+		);
+
 		void process_attrib(
 		    const hapi::Part &part, HAPI_AttributeOwner attrib_owner,
 		    const char *attrib_name, vector<float>& vals
@@ -451,11 +516,142 @@ namespace houdiniEngine {
 
 		void cook();
         void cook_one(hapi::Asset* asset);
-		void wait_for_cook();
+		void wait_for_cook(HAPI_Session* cookSession);
+
+		//! With async cooking, cook_one only queues the asset. update() starts
+		//! the cooks one at a time per session, polls HAPI each frame and
+		//! processes the asset once its cook is ready, so the render loop
+		//! never waits
+		void setAsyncCooking(const bool toggle) { myAsyncCooking = toggle; };
+		bool isAsyncCooking() { return myAsyncCooking; };
+
+		//! Cook scheduling: with an interval >= 0, cook requests only mark the
+		//! asset and update() cooks each marked asset once the interval has
+		//! passed since the last flush (0 = at most once a frame). Parameter
+		//! values are set on Houdini right away, so the cook picks up the
+		//! latest ones. Negative (the default) cooks on every request
+		void setCookInterval(const float seconds) { myCookInterval = seconds; };
+		float getCookInterval() { return myCookInterval; };
+		int getCooksRequested() { return myCooksRequested; };
+		int getCooksPerformed() { return myCooksPerformed; };
+		void resetCookCounters() { myCooksRequested = 0; myCooksPerformed = 0; myCookCacheHits = 0; myTexturesExtracted = 0; myTextureCacheHits = 0; myMaterialsRead = 0; myMaterialCacheHits = 0; };
+
+		//! Directory of the on-disk cook cache, empty (the default) turns it
+		//! off. Cook results are stored per asset and parameter values, and
+		//! cooking to values seen before loads the result instead of asking
+		//! Houdini. Clear the directory after changing an otl
+		void setCookCacheDir(const String& dir) { myCookCacheDir = dir; };
+		String getCookCacheDir() { return myCookCacheDir; };
+		int getCookCacheHits() { return myCookCacheHits; };
+
+		//! Material maps extracted from Houdini, and reused unchanged
+		int getTexturesExtracted() { return myTexturesExtracted; };
+		int getTextureCacheHits() { return myTextureCacheHits; };
+		//! Materials whose parameters were read from Houdini, and reused
+		//! because HAPI said they hadn't changed
+		int getMaterialsRead() { return myMaterialsRead; };
+		int getMaterialCacheHits() { return myMaterialCacheHits; };
+
+		//! Material maps go to the slaves in chunks of at most this many
+		//! bytes a frame, each image once however many textures show it.
+		//! 0 sends everything pending in the next frame
+		void setTextureFrameBudget(const int bytes) { myTextureFrameBudget = bytes; };
+		int getTextureFrameBudget() { return myTextureFrameBudget; };
+		//! Images still being sent (master) or put back together (slaves)
+		int getTexturesPending();
+
+		//! Drawables whose materials have the same values and transparency
+		//! share one state set. State sets in use, and drawables using them
+		int getMaterialStateSets();
+		int getMaterialStateDrawables();
+
+		//! Geometry cache files: the asset's whole geometry in a mappable
+		//! file that loads without Houdini Engine. Load on every node, the
+		//! master then skips sending the loaded parts to the slaves
+		bool saveGeometryCache(const String& asset_name, const String& path);
+		bool loadGeometryCache(const String& asset_name, const String& path);
+
+		//! True while a cook of the asset is scheduled, queued or running
+		bool isCooking(const String& asset_name);
+		//! Python command to run once the asset's pending cook has been
+		//! processed, right away if nothing is pending
+		void onCookDone(const String& asset_name, const String& command);
+
+		//! Session pool: DA_HOUDINI_ENGINE_SESSIONS=n (default 1) starts n
+		//! engine sessions on consecutive ports from DA_HOUDINI_ENGINE_PORT,
+		//! and each new asset is pinned to the session with the fewest
+		//! assets. Assets on different sessions cook side by side, each is
+		//! processed on the main thread as soon as its own cook is done
+		int getSessionCount() { return int(mySessions.size()); };
+		//! Index of the pool session the asset lives on, -1 if unknown
+		int getAssetSession(const String& asset_name);
 
 		void setCookOptions(HAPI_CookOptions co) { myCookOptions = co; };
 		HAPI_CookOptions getCookOptions() { return myCookOptions; };
 
+		//! Compression of the geometry sent to the slaves, a combination of
+		//! GeometryCompression flags. Trades master cpu for bandwidth
+		void setGeometryCompression(const int flags) { myGeometryCompression = flags; };
+		int getGeometryCompression() { return myGeometryCompression; };
+
+		//! Build parts as indexed geometry, with one vertex per point unless
+		//! vertex normals, uvs or primitive colours force corners apart.
+		//! Applies to parts processed after the change
+		void setIndexedGeometry(const bool toggle) { myIndexedGeometry = toggle; };
+		bool isIndexedGeometry() { return myIndexedGeometry; };
+
+		//! Build each part's faces as one triangle list (points and lines
+		//! aside), reordered for the post-transform vertex cache, instead of
+		//! a primitive set per run of face sizes. Applies to parts processed
+		//! after the change
+		void setTriangulateGeometry(const bool toggle) { myTriangulateGeometry = toggle; };
+		bool isTriangulateGeometry() { return myTriangulateGeometry; };
+
+		//! How far (in object units) tessellated bezier and nurbs curves may
+		//! stray from the real curve. Smaller means more segments, up to 64
+		//! per span. 0 always uses 64
+		void setCurveTolerance(const float tolerance) { myCurveTolerance = tolerance; };
+		float getCurveTolerance() { return myCurveTolerance; };
+
+		//! Number of threads (including the main one) that convert parts
+		//! to osg arrays after a cook. Defaults to the processor count
+		void setConversionThreads(const int count) { myConversionThreads = count; };
+		int getConversionThreads() { return myConversionThreads; };
+
+		//! Only rebuild the objects and geos HAPI flags as changed by the
+		//! last cook, keeping the arrays of the rest. On by default, turn
+		//! off to rebuild everything on every cook
+		void setIncrementalUpdates(const bool toggle) { myIncrementalUpdates = toggle; };
+		bool isIncrementalUpdates() { return myIncrementalUpdates; };
+
+		//! Parts whose counts, attributes and face wiring are the same as
+		//! last cook are updated in place: their attribute values are read
+		//! into the arrays they already have, keeping the arrays and
+		//! primitive sets. The face lists are still read every cook to
+		//! check the wiring, see setTrustPartTopology. On by default
+		void setTopologyFastPath(const bool toggle) { myTopologyFastPath = toggle; };
+		bool isTopologyFastPath() { return myTopologyFastPath; };
+
+		//! Take a part's wiring as unchanged while its counts and attribute
+		//! names are, so the fast path skips reading and hashing its face
+		//! lists. Only for assets that never rewire faces without changing
+		//! a count (eg. deforming a fixed mesh): anything else is drawn with
+		//! stale faces, without a warning. Off by default
+		void setTrustPartTopology(const bool toggle) { myTrustPartTopology = toggle; };
+		bool isTrustPartTopology() { return myTrustPartTopology; };
+
+		//! Record every HAPI call (and the process_* steps around them) with
+		//! its call site, duration and bytes moved. Off by default
+		void setHapiTracing(const bool toggle) { hapi::Trace::setEnabled(toggle); };
+		bool isHapiTracing() { return hapi::Trace::isEnabled(); };
+		void clearHapiTrace() { hapi::Trace::clear(); };
+		int getHapiTraceCallCount() { return hapi::Trace::getCallCount(); };
+		//! Recorded calls as Chrome trace json, for chrome://tracing or
+		//! ui.perfetto.dev
+		bool writeHapiTrace(const String& path) { return hapi::Trace::writeChromeTrace(path); };
+		//! Per call site totals, slowest first
+		String getHapiTraceSummary() { return hapi::Trace::summary(); };
+
 		void setLoggingEnabled(const bool toggle);
 		bool isLoggingEnabled() { return HoudiniEngine::myLogEnabled; };
 
@@ -579,12 +775,45 @@ namespace houdiniEngine {
         // eg: assetMaterialParms["cluster1"][4]["ogl_diff"]
         Dictionary < String, Vector< MatStruct > > assetMaterialParms;
 
+		// shared drawable state sets by material values and transparency
+		Dictionary<HashValue, Ref<osg::StateSet> > myMaterialStates;
+
+		// where each material id sits in assetMaterialParms, by asset name
+		Dictionary<String, Dictionary<int, int> > myAssetMaterialIndex;
+
+		// an asset's parms with their names and choice labels resolved, so
+		// parameter calls don't fetch and search the whole list each time.
+		// Dropped when the asset's multiparm instances change
+		struct ParmIndex {
+			std::vector<hapi::Parm> parms;
+			Dictionary<String, int> byName;
+			Vector< Vector<String> > choices;
+		};
+		// by asset id
+		Dictionary<int, ParmIndex> myParmIndex;
+
+		// int and float values to set, by index in the asset's value arrays
+		struct ParmWrites {
+			ParmWrites(): multiparms(false) {}
+
+			std::map<int, int> ints;
+			std::map<int, float> floats;
+			// a multiparm instance count is among them
+			bool multiparms;
+		};
+
 		// logging
 		static bool myLogEnabled;
 
-		// session
+		// session, the first of the pool
 		HAPI_Session* session;
 
+		// session pool, see getSessionCount. Asset ids are the asset's node
+		// id on its session plus SESSION_ID_STRIDE times the session's index,
+		// as every session numbers its nodes from the same start
+		static const int SESSION_ID_STRIDE = 1 << 24;
+		Vector<HAPI_Session*> mySessions;
+
 		int myAssetCount;
 
 		// build a list of widgets to remove
@@ -594,6 +823,164 @@ namespace houdiniEngine {
 
 		HAPI_CookOptions myCookOptions;
 
+		// GeometryCompression flags used by commitSharedData
+		int myGeometryCompression;
+
+		// process_part emits DrawElementsUInt instead of de-indexed DrawArrays
+		bool myIndexedGeometry;
+
+		// process_part fans all faces into a single cache-ordered triangle list
+		bool myTriangulateGeometry;
+
+		// chord error allowed when tessellating curves
+		float myCurveTolerance;
+
+		// threads used by convert_parts
+		int myConversionThreads;
+
+		// process_asset honours HAPI's change flags
+		bool myIncrementalUpdates;
+
+		// process_part updates parts with unchanged topology in place
+		bool myTopologyFastPath;
+		// ..judging the topology by counts and attribute names alone
+		bool myTrustPartTopology;
+
+		// a cook started by update_cooks
+		struct RunningCook {
+			RunningCook(): asset(-1) {}
+
+			// -1 while the session is idle
+			int asset;
+			// onCookDone commands
+			Vector<String> commands;
+			// cook cache file, empty if not cached
+			String cachePath;
+		};
+
+		// async cooking: assets waiting for a cook, oldest first, and the
+		// running cook of each pool session
+		bool myAsyncCooking;
+		List<int> myCookQueue;
+		Vector<RunningCook> myRunningCooks;
+		// onCookDone commands for queued assets
+		Dictionary<int, Vector<String> > myCookDoneCommands;
+
+		// cook scheduling: assets with a cook request not yet flushed
+		float myCookInterval;
+		double myLastCookFlush;
+		List<int> myScheduledCooks;
+		int myCooksRequested;
+		int myCooksPerformed;
+
+		// cook cache, see setCookCacheDir
+		String myCookCacheDir;
+		int myCookCacheHits;
+
+		// an extracted material map
+		struct MaterialTexture {
+			MaterialTexture(): generation(-1) {}
+
+			// map parameter value the pixels are of
+			String value;
+			// hapi::StringCache generation (ie. cook) they were extracted in
+			int generation;
+			Ref<PixelData> pixels;
+		};
+		// keyed by session index, material node id and map parm id
+		Dictionary<String, MaterialTexture> myMaterialTextures;
+		// the myMaterialTextures entry each scene manager texture shows
+		Dictionary<String, String> myInstalledTextures;
+		int myTexturesExtracted;
+		int myTextureCacheHits;
+
+		// the material slot a texture goes in
+		enum TextureSlot { DIFFUSE_MAP, NORMAL_MAP, MAP_SLOTS };
+
+		// the parameters of a material node we use, as last read
+		struct MaterialEntry {
+			MaterialEntry(): generation(-1) {
+				for (int i = 0; i < MAP_SLOTS; ++i) mapIds[i] = -1;
+			}
+
+			// hapi::StringCache generation (ie. cook) they were read in
+			int generation;
+			Dictionary<String, ParmStruct> parms;
+			// map parameter of each slot, id -1 if there's none
+			int mapIds[MAP_SLOTS];
+			String mapNames[MAP_SLOTS];
+			String mapValues[MAP_SLOTS];
+		};
+		// keyed by session index * SESSION_ID_STRIDE + material node id
+		Dictionary<int, MaterialEntry> myMaterials;
+		int myMaterialsRead;
+		int myMaterialCacheHits;
+
+		// a scene manager texture and the image (by content hash) it shows
+		struct TextureBinding {
+			String name;
+			String asset;
+			int slot;
+			HashValue hash;
+			int width;
+			int height;
+		};
+		// master: an image on its way to the slaves, offset bytes sent so far
+		struct TextureSend {
+			HashValue hash;
+			Ref<PixelData> pixels;
+			int offset;
+		};
+		// slave: an image being put back together from its chunks
+		struct TextureImage {
+			TextureImage(): received(0) {}
+
+			Ref<PixelData> pixels;
+			int received;
+		};
+		int myTextureFrameBudget;
+		// master: bindings not sent yet, images still going out, and every
+		// image queued so far
+		Vector<TextureBinding> myTextureBindings;
+		List<TextureSend> myTextureSends;
+		Dictionary<HashValue, bool> mySharedTextures;
+		// slave: images by hash, and bindings waiting for their image
+		Dictionary<HashValue, TextureImage> myTextureImages;
+		List<TextureBinding> myWaitingTextures;
+
+		void process_instance(hapi::Asset* asset);
+		String cook_cache_path(const hapi::Asset& asset);
+		bool load_cooked(const String& asset_name, const String& path);
+		void store_cooked(const String& asset_name, const String& path);
+		void apply_material_parms(const String& asset_name);
+		ParmIndex& parm_index(const int asset_id);
+		int find_parm(const int asset_id, const String& parm_name);
+		bool set_parm(const int asset_id, const String& parm_name, boost::python::object value, ParmWrites& writes);
+		void write_parms(const hapi::Asset& asset, ParmWrites& writes);
+		MatStruct* find_material(const String& asset_name, const int matId);
+		const MaterialEntry& read_material(HAPI_Session* s, const HAPI_MaterialInfo& mat_info);
+		osg::StateSet* material_state(const MatStruct* ms, const bool transparent);
+		void apply_material_state(HoudiniGeometry* hg, const int drawableIndex, const int geodeIndex, const int objIndex);
+		void install_texture(const String& name, PixelData* pixels);
+		void share_texture(const String& asset_name, const String& name, const int slot, PixelData* pixels);
+		void commit_textures(SharedOStream& out);
+		void update_textures(SharedIStream& in);
+
+		void cook_now(hapi::Asset* asset);
+		void flush_cooks(const double time);
+		bool is_scheduled(const int asset_id);
+		void queue_cook(const int asset_id);
+		void update_cooks();
+		void drain_cooks();
+		RunningCook* running_cook(const int asset_id);
+		void run_commands(const Vector<String>& commands);
+
+		HAPI_Session* create_session(const char* host, const int port);
+		HAPI_Session* pick_session();
+		int session_index(const HAPI_Session* s);
+		int pool_asset_id(const hapi::Asset& asset);
+		hapi::Asset pool_asset(const int asset_id);
+
 #endif
 	};
 };
@@ -0,0 +1,116 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	read-only geometry cache files of a whole HoudiniGeometry: a header, an
+	object table, a part table and a primitive table, followed by the raw
+	arrays at aligned offsets. Loading maps the file and copies each array
+	into its osg array with one memcpy, no Houdini Engine needed
+
+******************************************************************************/
+
+#ifndef __HE_GEOMETRY_CACHE__
+#define __HE_GEOMETRY_CACHE__
+
+#include <daHoudiniEngine/houdiniGeometry.h>
+
+namespace houdiniEngine {
+
+	static const char GEOMETRY_CACHE_MAGIC[8] = { 'H', 'E', 'G', 'E', 'O', 'M', 'C', 'A' };
+	static const unsigned int GEOMETRY_CACHE_VERSION = 2;
+	// every array starts at a multiple of this
+	static const unsigned int GEOMETRY_CACHE_ALIGN = 16;
+
+	// file layout, all offsets from the start of the file
+	struct GeometryCacheHeader {
+		char magic[8];
+		unsigned int version;
+		unsigned int objectCount;
+		unsigned int partCount;
+		unsigned int primitiveCount;
+		unsigned long long fileSize;
+	};
+
+	struct GeometryCacheObject {
+		double pos[3];
+		double rot[4];
+		double scale[3];
+		unsigned int geodeCount;
+		unsigned int pad;
+	};
+
+	// one per drawable, in object, geode, drawable order. Absent arrays
+	// (normals, colors, uvs) have count 0
+	struct GeometryCacheArray {
+		unsigned long long offset;
+		unsigned long long count;
+	};
+
+	struct GeometryCachePart {
+		int objIndex;
+		int geodeIndex;
+		int drawableIndex;
+		int matId;
+		int transparent;
+		unsigned int firstPrimitive; // into the primitive table
+		unsigned int primitiveCount;
+		int instanced; // drawn once per entry of instances
+		GeometryCacheArray vertices; // Vec3
+		GeometryCacheArray normals; // Vec3
+		GeometryCacheArray colors; // Vec4
+		GeometryCacheArray uvs; // Vec3
+		GeometryCacheArray instances; // Matrixf
+	};
+
+	// a DrawArrays (first, count), or a DrawElementsUInt when indices.count > 0
+	struct GeometryCachePrimitive {
+		unsigned int mode;
+		int first;
+		unsigned int count;
+		unsigned int pad;
+		GeometryCacheArray indices;
+	};
+
+	//! Writes all objects, geodes and drawables of hg to path
+	bool saveGeometryCache(HoudiniGeometry* hg, const String& path);
+
+	//! Replaces the content of hg with the file's, adding objects, geodes
+	//! and drawables as needed and clearing the ones the file doesn't have.
+	//! Leaves hg untouched if the file is missing or doesn't check out
+	bool loadGeometryCache(HoudiniGeometry* hg, const String& path);
+
+};
+
+#endif
@@ -0,0 +1,292 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	optional compression of the geometry arrays sent across the cluster:
+	quantised positions (16 bit, relative to the bounding box), octahedral
+	normals (2x16 bit), 8 bit colours, and a small LZ77 byte compressor run
+	over byte-shuffled data.
+
+	kept free of omega/osg includes so the stand-alone benchmarks can use it
+
+******************************************************************************/
+
+#ifndef __HE_GEOMETRY_CODEC__
+#define __HE_GEOMETRY_CODEC__
+
+#include <daHoudiniEngine/sharedDataTools.h>
+
+#include <vector>
+
+namespace houdiniEngine {
+
+	// compression flags, combine with |
+	enum GeometryCompression {
+		COMPRESS_NONE = 0,
+		COMPRESS_LZ = 1, // lz over byte-shuffled arrays
+		COMPRESS_POSITIONS = 2, // 16 bit positions relative to the part bbox
+		COMPRESS_NORMALS = 4, // octahedral normals, 2x16 bit
+		COMPRESS_COLORS = 8, // rgba, 8 bit per channel
+		COMPRESS_ALL = 15
+	};
+
+	// quantisation, count is in elements (3 floats for positions and normals,
+	// 4 for colours)
+	void encodePositions(const float* xyz, const int count, float bbox[6], std::vector<unsigned short>& q);
+	void decodePositions(const unsigned short* q, const int count, const float bbox[6], float* xyz);
+	void encodeNormals(const float* xyz, const int count, std::vector<short>& q);
+	void decodeNormals(const short* q, const int count, float* xyz);
+	void encodeColors(const float* rgba, const int count, std::vector<unsigned char>& q);
+	void decodeColors(const unsigned char* q, const int count, float* rgba);
+
+	// groups byte n of every stride-sized element together, so the slowly
+	// changing exponent bytes of floats end up next to each other
+	void shuffleBytes(const void* src, const size_t size, const size_t stride, char* dst);
+	void unshuffleBytes(const char* src, const size_t size, const size_t stride, void* dst);
+
+	// LZ77 in the style of LZ4 (64K window, 4 byte minimum match).
+	// lzCompress returns the compressed size, lzDecompress false on corrupt input
+	size_t lzCompress(const char* src, const size_t size, std::vector<char>& dst);
+	bool lzDecompress(const char* src, const size_t srcSize, char* dst, const size_t dstSize);
+
+	// smaller blobs aren't worth setting up the lz hash table for
+	static const size_t LZ_MIN_BLOB_SIZE = 256;
+
+	// writes size bytes of stride-sized elements, lz compressed if asked for
+	// and worth it. A negative length marks the data as stored
+	template<typename Stream>
+	inline void writeBlob(Stream& out, const void* data, const size_t size, const size_t stride, const int flags)
+	{
+		if ((flags & COMPRESS_LZ) && size >= LZ_MIN_BLOB_SIZE) {
+			std::vector<char> shuffled(size);
+			std::vector<char> packed;
+			shuffleBytes(data, size, stride, &shuffled[0]);
+			int packedSize = int(lzCompress(&shuffled[0], size, packed));
+			if (packedSize < int(size)) {
+				out << packedSize;
+				out.write(&packed[0], packedSize);
+				return;
+			}
+		}
+		out << int(-1);
+		out.write(data, size);
+	}
+
+	// reads what writeBlob wrote into data, which must hold size bytes
+	template<typename Stream>
+	inline bool readBlob(Stream& in, void* data, const size_t size, const size_t stride)
+	{
+		int packedSize = 0;
+		in >> packedSize;
+		if (packedSize < 0) {
+			in.read(data, size);
+			return true;
+		}
+
+		std::vector<char> packed(packedSize);
+		std::vector<char> shuffled(size);
+		in.read(&packed[0], packedSize);
+		if (!lzDecompress(&packed[0], packedSize, &shuffled[0], size)) {
+			return false;
+		}
+		unshuffleBytes(&shuffled[0], size, stride, data);
+		return true;
+	}
+
+	// the array writers/readers below fall back to writeArray/readArrayData
+	// when flags is COMPRESS_NONE, so the uncompressed stream is unchanged.
+	// Array is an osg::Vec3Array/Vec4Array or anything else of packed floats
+
+	///////////////////////////////////////////////////////////////////////////
+	template<typename Stream, typename Array>
+	inline int writePositionArray(Stream& out, const Array* arr, const int flags)
+	{
+		if (flags == COMPRESS_NONE) return writeArray(out, arr);
+
+		int count = (arr == NULL) ? 0 : int(arr->size());
+		out << count;
+		if (count == 0) return 0;
+
+		const float* xyz = reinterpret_cast<const float*>(&arr->front());
+		if (flags & COMPRESS_POSITIONS) {
+			float bbox[6];
+			std::vector<unsigned short> q;
+			encodePositions(xyz, count, bbox, q);
+			for (int i = 0; i < 6; ++i) out << bbox[i];
+			writeBlob(out, &q[0], q.size() * sizeof(unsigned short), sizeof(unsigned short), flags);
+		} else {
+			writeBlob(out, xyz, count * sizeof(typename Array::value_type), sizeof(float), flags);
+		}
+		return count;
+	}
+
+	template<typename Stream, typename Array>
+	inline bool readPositionArrayData(Stream& in, Array* arr, const int count, const int flags)
+	{
+		if (flags == COMPRESS_NONE) {
+			readArrayData(in, arr, count);
+			return true;
+		}
+
+		arr->resize(count);
+		if (count == 0) return true;
+
+		float* xyz = reinterpret_cast<float*>(&arr->front());
+		if (flags & COMPRESS_POSITIONS) {
+			float bbox[6];
+			for (int i = 0; i < 6; ++i) in >> bbox[i];
+			std::vector<unsigned short> q(count * 3);
+			if (!readBlob(in, &q[0], q.size() * sizeof(unsigned short), sizeof(unsigned short))) return false;
+			decodePositions(&q[0], count, bbox, xyz);
+			return true;
+		}
+		return readBlob(in, xyz, count * sizeof(typename Array::value_type), sizeof(float));
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	template<typename Stream, typename Array>
+	inline int writeNormalArray(Stream& out, const Array* arr, const int flags)
+	{
+		if (flags == COMPRESS_NONE) return writeArray(out, arr);
+
+		int count = (arr == NULL) ? 0 : int(arr->size());
+		out << count;
+		if (count == 0) return 0;
+
+		const float* xyz = reinterpret_cast<const float*>(&arr->front());
+		if (flags & COMPRESS_NORMALS) {
+			std::vector<short> q;
+			encodeNormals(xyz, count, q);
+			writeBlob(out, &q[0], q.size() * sizeof(short), sizeof(short), flags);
+		} else {
+			writeBlob(out, xyz, count * sizeof(typename Array::value_type), sizeof(float), flags);
+		}
+		return count;
+	}
+
+	template<typename Stream, typename Array>
+	inline bool readNormalArrayData(Stream& in, Array* arr, const int count, const int flags)
+	{
+		if (flags == COMPRESS_NONE) {
+			readArrayData(in, arr, count);
+			return true;
+		}
+
+		arr->resize(count);
+		if (count == 0) return true;
+
+		float* xyz = reinterpret_cast<float*>(&arr->front());
+		if (flags & COMPRESS_NORMALS) {
+			std::vector<short> q(count * 2);
+			if (!readBlob(in, &q[0], q.size() * sizeof(short), sizeof(short))) return false;
+			decodeNormals(&q[0], count, xyz);
+			return true;
+		}
+		return readBlob(in, xyz, count * sizeof(typename Array::value_type), sizeof(float));
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	template<typename Stream, typename Array>
+	inline int writeColorArray(Stream& out, const Array* arr, const int flags)
+	{
+		if (flags == COMPRESS_NONE) return writeArray(out, arr);
+
+		int count = (arr == NULL) ? 0 : int(arr->size());
+		out << count;
+		if (count == 0) return 0;
+
+		const float* rgba = reinterpret_cast<const float*>(&arr->front());
+		if (flags & COMPRESS_COLORS) {
+			std::vector<unsigned char> q;
+			encodeColors(rgba, count, q);
+			writeBlob(out, &q[0], q.size(), 4, flags);
+		} else {
+			writeBlob(out, rgba, count * sizeof(typename Array::value_type), sizeof(float), flags);
+		}
+		return count;
+	}
+
+	template<typename Stream, typename Array>
+	inline bool readColorArrayData(Stream& in, Array* arr, const int count, const int flags)
+	{
+		if (flags == COMPRESS_NONE) {
+			readArrayData(in, arr, count);
+			return true;
+		}
+
+		arr->resize(count);
+		if (count == 0) return true;
+
+		float* rgba = reinterpret_cast<float*>(&arr->front());
+		if (flags & COMPRESS_COLORS) {
+			std::vector<unsigned char> q(count * 4);
+			if (!readBlob(in, &q[0], q.size(), 4)) return false;
+			decodeColors(&q[0], count, rgba);
+			return true;
+		}
+		return readBlob(in, rgba, count * sizeof(typename Array::value_type), sizeof(float));
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+	// anything else with 4 byte components (uvs, element indices): only lz
+	template<typename Stream, typename Array>
+	inline int writeFloatArray(Stream& out, const Array* arr, const int flags)
+	{
+		if (flags == COMPRESS_NONE) return writeArray(out, arr);
+
+		int count = (arr == NULL) ? 0 : int(arr->size());
+		out << count;
+		if (count > 0) {
+			writeBlob(out, &arr->front(), count * sizeof(typename Array::value_type), sizeof(float), flags);
+		}
+		return count;
+	}
+
+	template<typename Stream, typename Array>
+	inline bool readFloatArrayData(Stream& in, Array* arr, const int count, const int flags)
+	{
+		if (flags == COMPRESS_NONE) {
+			readArrayData(in, arr, count);
+			return true;
+		}
+
+		arr->resize(count);
+		if (count == 0) return true;
+		return readBlob(in, &arr->front(), count * sizeof(typename Array::value_type), sizeof(float));
+	}
+
+};
+
+#endif
@@ -0,0 +1,254 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	record/replay stand-in for the HAPI functions the module calls. Built
+	with DA_HAPI_STANDIN, HAPI3_CPP.h renames those calls to the stand-ins
+	below, which
+
+	- pass straight through to HAPI (the default)
+	- also save every response to a file (DA_HAPI_RECORD=file)
+	- serve the responses from such a file without a Houdini Engine
+	  session or license (DA_HAPI_REPLAY=file)
+
+	responses are looked up by function and input arguments, repeated
+	calls with the same inputs get the recorded responses in order
+
+******************************************************************************/
+
+#ifndef __HE_HAPI_STANDIN__
+#define __HE_HAPI_STANDIN__
+
+#include <HAPI/HAPI.h>
+#include <daHoudiniEngine/hapiVersion.h>
+
+#include <string>
+
+namespace hapi {
+
+	class StandIn
+	{
+	public:
+		enum Mode { Live, Record, Replay };
+
+		//! Save the responses of all HAPI calls from now on to path
+		static bool startRecording(const std::string& path);
+		//! Serve HAPI calls from a recording instead of Houdini Engine
+		static bool startReplay(const std::string& path);
+		//! Back to live HAPI calls, closing any recording
+		static void stop();
+
+		//! Sets the mode from DA_HAPI_RECORD / DA_HAPI_REPLAY, if set
+		static void startFromEnvironment();
+
+		static Mode getMode();
+		//! Replayed calls that had no recorded response and failed
+		static int getMisses();
+	};
+};
+
+HAPI_Result HAPI_StandIn_StartThriftSocketServer(const HAPI_ThriftServerOptions* options, int port, HAPI_ProcessId* process_id);
+HAPI_Result HAPI_StandIn_CreateThriftSocketSession(HAPI_Session* session, const char* host_name, int port);
+HAPI_Result HAPI_StandIn_Initialize(const HAPI_Session* session, const HAPI_CookOptions* cook_options,
+	HAPI_Bool use_cooking_thread, int cooking_thread_stack_size, const char* houdini_environment_files,
+	const char* otl_search_path, const char* dso_search_path, const char* image_dso_search_path,
+	const char* audio_dso_search_path);
+HAPI_Result HAPI_StandIn_Cleanup(const HAPI_Session* session);
+HAPI_Result HAPI_StandIn_GetEnvInt(HAPI_EnvIntType int_type, int* value);
+
+HAPI_Result HAPI_StandIn_GetStatus(const HAPI_Session* session, HAPI_StatusType status_type, int* status);
+HAPI_Result HAPI_StandIn_GetStatusStringBufLength(const HAPI_Session* session, HAPI_StatusType status_type,
+	HAPI_StatusVerbosity verbosity, int* buffer_length);
+HAPI_Result HAPI_StandIn_GetStatusString(const HAPI_Session* session, HAPI_StatusType status_type,
+	char* string_value, int length);
+HAPI_Result HAPI_StandIn_GetStringBufLength(const HAPI_Session* session, HAPI_StringHandle string_handle, int* buffer_length);
+HAPI_Result HAPI_StandIn_GetString(const HAPI_Session* session, HAPI_StringHandle string_handle, char* string_value, int length);
+#if HAPI_HAS_STRING_BATCH
+HAPI_Result HAPI_StandIn_GetStringBatchSize(const HAPI_Session* session, const int* string_handle_array,
+	int string_handle_count, int* string_buffer_size);
+HAPI_Result HAPI_StandIn_GetStringBatch(const HAPI_Session* session, char* char_buffer, int char_array_length);
+#endif
+
+HAPI_Result HAPI_StandIn_GetTime(const HAPI_Session* session, float* time);
+HAPI_Result HAPI_StandIn_SetTime(const HAPI_Session* session, float time);
+HAPI_Result HAPI_StandIn_GetTimelineOptions(const HAPI_Session* session, HAPI_TimelineOptions* timeline_options);
+
+HAPI_Result HAPI_StandIn_LoadAssetLibraryFromFile(const HAPI_Session* session, const char* file_path,
+	HAPI_Bool allow_overwrite, HAPI_AssetLibraryId* library_id);
+HAPI_Result HAPI_StandIn_GetAvailableAssetCount(const HAPI_Session* session, HAPI_AssetLibraryId library_id, int* asset_count);
+HAPI_Result HAPI_StandIn_GetAvailableAssets(const HAPI_Session* session, HAPI_AssetLibraryId library_id,
+	HAPI_StringHandle* asset_names_array, int asset_count);
+HAPI_Result HAPI_StandIn_CreateNode(const HAPI_Session* session, HAPI_NodeId parent_node_id, const char* operator_name,
+	const char* node_label, HAPI_Bool cook_on_creation, HAPI_NodeId* new_node_id);
+HAPI_Result HAPI_StandIn_DeleteNode(const HAPI_Session* session, HAPI_NodeId node_id);
+HAPI_Result HAPI_StandIn_CookNode(const HAPI_Session* session, HAPI_NodeId node_id, const HAPI_CookOptions* cook_options);
+HAPI_Result HAPI_StandIn_GetNodeInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_NodeInfo* node_info);
+HAPI_Result HAPI_StandIn_IsNodeValid(const HAPI_Session* session, HAPI_NodeId node_id, int unique_node_id, HAPI_Bool* answer);
+HAPI_Result HAPI_StandIn_GetAssetInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_AssetInfo* asset_info);
+
+HAPI_Result HAPI_StandIn_GetObjectTransform(const HAPI_Session* session, HAPI_NodeId node_id,
+	HAPI_NodeId relative_to_node_id, HAPI_RSTOrder rst_order, HAPI_Transform* transform);
+HAPI_Result HAPI_StandIn_ConvertTransformQuatToMatrix(const HAPI_Session* session, const HAPI_Transform* transform, float* matrix);
+HAPI_Result HAPI_StandIn_ComposeObjectList(const HAPI_Session* session, HAPI_NodeId parent_node_id,
+	const char* categories, int* object_count);
+HAPI_Result HAPI_StandIn_GetComposedObjectList(const HAPI_Session* session, HAPI_NodeId parent_node_id,
+	HAPI_ObjectInfo* object_infos_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetComposedObjectTransforms(const HAPI_Session* session, HAPI_NodeId parent_node_id,
+	HAPI_RSTOrder rst_order, HAPI_Transform* transform_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetDisplayGeoInfo(const HAPI_Session* session, HAPI_NodeId object_node_id, HAPI_GeoInfo* geo_info);
+
+HAPI_Result HAPI_StandIn_GetPartInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id, HAPI_PartInfo* part_info);
+HAPI_Result HAPI_StandIn_GetAttributeNames(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	HAPI_AttributeOwner owner, HAPI_StringHandle* attribute_names_array, int count);
+HAPI_Result HAPI_StandIn_GetAttributeInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	const char* name, HAPI_AttributeOwner owner, HAPI_AttributeInfo* attr_info);
+HAPI_Result HAPI_StandIn_GetAttributeFloatData(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	const char* name, HAPI_AttributeInfo* attr_info, int stride, float* data_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetAttributeIntData(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	const char* name, HAPI_AttributeInfo* attr_info, int stride, int* data_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetFaceCounts(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	int* face_counts_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetVertexList(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	int* vertex_list_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetCurveInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id, HAPI_CurveInfo* info);
+HAPI_Result HAPI_StandIn_GetCurveCounts(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	int* counts_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetCurveOrders(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	int* orders_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetCurveKnots(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	float* knots_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetInstancedPartIds(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	HAPI_PartId* instanced_parts_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetInstancerPartTransforms(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	HAPI_RSTOrder rst_order, HAPI_Transform* transforms_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetMaterialNodeIdsOnFaces(const HAPI_Session* session, HAPI_NodeId geometry_node_id,
+	HAPI_PartId part_id, HAPI_Bool* are_all_the_same, HAPI_NodeId* material_ids_array, int start, int length);
+
+HAPI_Result HAPI_StandIn_GetParameters(const HAPI_Session* session, HAPI_NodeId node_id,
+	HAPI_ParmInfo* parm_infos_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetParmInfoFromName(const HAPI_Session* session, HAPI_NodeId node_id, const char* parm_name,
+	HAPI_ParmInfo* parm_info);
+HAPI_Result HAPI_StandIn_GetParmChoiceLists(const HAPI_Session* session, HAPI_NodeId node_id,
+	HAPI_ParmChoiceInfo* parm_choices_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetParmIntValues(const HAPI_Session* session, HAPI_NodeId node_id, int* values_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetParmFloatValues(const HAPI_Session* session, HAPI_NodeId node_id, float* values_array, int start, int length);
+HAPI_Result HAPI_StandIn_GetParmStringValues(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_Bool evaluate,
+	HAPI_StringHandle* values_array, int start, int length);
+HAPI_Result HAPI_StandIn_SetParmIntValues(const HAPI_Session* session, HAPI_NodeId node_id, const int* values_array, int start, int length);
+HAPI_Result HAPI_StandIn_SetParmFloatValues(const HAPI_Session* session, HAPI_NodeId node_id, const float* values_array, int start, int length);
+HAPI_Result HAPI_StandIn_SetParmStringValue(const HAPI_Session* session, HAPI_NodeId node_id, const char* value,
+	HAPI_ParmId parm_id, int index);
+HAPI_Result HAPI_StandIn_InsertMultiparmInstance(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_ParmId parm_id, int instance_position);
+HAPI_Result HAPI_StandIn_RemoveMultiparmInstance(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_ParmId parm_id, int instance_position);
+
+HAPI_Result HAPI_StandIn_GetMaterialInfo(const HAPI_Session* session, HAPI_NodeId material_node_id, HAPI_MaterialInfo* material_info);
+HAPI_Result HAPI_StandIn_RenderTextureToImage(const HAPI_Session* session, HAPI_NodeId material_node_id, HAPI_ParmId parm_id);
+HAPI_Result HAPI_StandIn_GetImageInfo(const HAPI_Session* session, HAPI_NodeId material_node_id, HAPI_ImageInfo* image_info);
+HAPI_Result HAPI_StandIn_GetImagePlaneCount(const HAPI_Session* session, HAPI_NodeId material_node_id, int* image_plane_count);
+HAPI_Result HAPI_StandIn_GetImagePlanes(const HAPI_Session* session, HAPI_NodeId material_node_id,
+	HAPI_StringHandle* image_planes_array, int image_plane_count);
+HAPI_Result HAPI_StandIn_ExtractImageToMemory(const HAPI_Session* session, HAPI_NodeId material_node_id,
+	const char* image_file_format_name, const char* image_planes, int* buffer_size);
+HAPI_Result HAPI_StandIn_GetImageMemoryBuffer(const HAPI_Session* session, HAPI_NodeId material_node_id, char* buffer, int length);
+
+// hapiStandIn.cpp defines this to reach the real functions
+#ifndef HAPI_STANDIN_NO_RENAME
+#define HAPI_StartThriftSocketServer HAPI_StandIn_StartThriftSocketServer
+#define HAPI_CreateThriftSocketSession HAPI_StandIn_CreateThriftSocketSession
+#define HAPI_Initialize HAPI_StandIn_Initialize
+#define HAPI_Cleanup HAPI_StandIn_Cleanup
+#define HAPI_GetEnvInt HAPI_StandIn_GetEnvInt
+#define HAPI_GetStatus HAPI_StandIn_GetStatus
+#define HAPI_GetStatusStringBufLength HAPI_StandIn_GetStatusStringBufLength
+#define HAPI_GetStatusString HAPI_StandIn_GetStatusString
+#define HAPI_GetStringBufLength HAPI_StandIn_GetStringBufLength
+#define HAPI_GetString HAPI_StandIn_GetString
+#if HAPI_HAS_STRING_BATCH
+#define HAPI_GetStringBatchSize HAPI_StandIn_GetStringBatchSize
+#define HAPI_GetStringBatch HAPI_StandIn_GetStringBatch
+#endif
+#define HAPI_GetTime HAPI_StandIn_GetTime
+#define HAPI_SetTime HAPI_StandIn_SetTime
+#define HAPI_GetTimelineOptions HAPI_StandIn_GetTimelineOptions
+#define HAPI_LoadAssetLibraryFromFile HAPI_StandIn_LoadAssetLibraryFromFile
+#define HAPI_GetAvailableAssetCount HAPI_StandIn_GetAvailableAssetCount
+#define HAPI_GetAvailableAssets HAPI_StandIn_GetAvailableAssets
+#define HAPI_CreateNode HAPI_StandIn_CreateNode
+#define HAPI_DeleteNode HAPI_StandIn_DeleteNode
+#define HAPI_CookNode HAPI_StandIn_CookNode
+#define HAPI_GetNodeInfo HAPI_StandIn_GetNodeInfo
+#define HAPI_IsNodeValid HAPI_StandIn_IsNodeValid
+#define HAPI_GetAssetInfo HAPI_StandIn_GetAssetInfo
+#define HAPI_GetObjectTransform HAPI_StandIn_GetObjectTransform
+#define HAPI_ConvertTransformQuatToMatrix HAPI_StandIn_ConvertTransformQuatToMatrix
+#define HAPI_ComposeObjectList HAPI_StandIn_ComposeObjectList
+#define HAPI_GetComposedObjectList HAPI_StandIn_GetComposedObjectList
+#define HAPI_GetComposedObjectTransforms HAPI_StandIn_GetComposedObjectTransforms
+#define HAPI_GetDisplayGeoInfo HAPI_StandIn_GetDisplayGeoInfo
+#define HAPI_GetPartInfo HAPI_StandIn_GetPartInfo
+#define HAPI_GetAttributeNames HAPI_StandIn_GetAttributeNames
+#define HAPI_GetAttributeInfo HAPI_StandIn_GetAttributeInfo
+#define HAPI_GetAttributeFloatData HAPI_StandIn_GetAttributeFloatData
+#define HAPI_GetAttributeIntData HAPI_StandIn_GetAttributeIntData
+#define HAPI_GetFaceCounts HAPI_StandIn_GetFaceCounts
+#define HAPI_GetVertexList HAPI_StandIn_GetVertexList
+#define HAPI_GetCurveInfo HAPI_StandIn_GetCurveInfo
+#define HAPI_GetCurveCounts HAPI_StandIn_GetCurveCounts
+#define HAPI_GetCurveOrders HAPI_StandIn_GetCurveOrders
+#define HAPI_GetCurveKnots HAPI_StandIn_GetCurveKnots
+#define HAPI_GetInstancedPartIds HAPI_StandIn_GetInstancedPartIds
+#define HAPI_GetInstancerPartTransforms HAPI_StandIn_GetInstancerPartTransforms
+#define HAPI_GetMaterialNodeIdsOnFaces HAPI_StandIn_GetMaterialNodeIdsOnFaces
+#define HAPI_GetParameters HAPI_StandIn_GetParameters
+#define HAPI_GetParmInfoFromName HAPI_StandIn_GetParmInfoFromName
+#define HAPI_GetParmChoiceLists HAPI_StandIn_GetParmChoiceLists
+#define HAPI_GetParmIntValues HAPI_StandIn_GetParmIntValues
+#define HAPI_GetParmFloatValues HAPI_StandIn_GetParmFloatValues
+#define HAPI_GetParmStringValues HAPI_StandIn_GetParmStringValues
+#define HAPI_SetParmIntValues HAPI_StandIn_SetParmIntValues
+#define HAPI_SetParmFloatValues HAPI_StandIn_SetParmFloatValues
+#define HAPI_SetParmStringValue HAPI_StandIn_SetParmStringValue
+#define HAPI_InsertMultiparmInstance HAPI_StandIn_InsertMultiparmInstance
+#define HAPI_RemoveMultiparmInstance HAPI_StandIn_RemoveMultiparmInstance
+#define HAPI_GetMaterialInfo HAPI_StandIn_GetMaterialInfo
+#define HAPI_RenderTextureToImage HAPI_StandIn_RenderTextureToImage
+#define HAPI_GetImageInfo HAPI_StandIn_GetImageInfo
+#define HAPI_GetImagePlaneCount HAPI_StandIn_GetImagePlaneCount
+#define HAPI_GetImagePlanes HAPI_StandIn_GetImagePlanes
+#define HAPI_ExtractImageToMemory HAPI_StandIn_ExtractImageToMemory
+#define HAPI_GetImageMemoryBuffer HAPI_StandIn_GetImageMemoryBuffer
+#endif
+
+#endif
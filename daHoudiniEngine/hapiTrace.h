@@ -0,0 +1,120 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	optional tracing of the HAPI calls made by the module: call counts,
+	latencies and bytes moved per call site, with export to the Chrome
+	trace event format (chrome://tracing, ui.perfetto.dev)
+
+	only needs the standard library, so HAPI3_CPP.h can include it
+
+******************************************************************************/
+
+#ifndef __HE_HAPI_TRACE__
+#define __HE_HAPI_TRACE__
+
+#include <cstddef>
+#include <string>
+
+namespace hapi {
+
+	//! Process wide HAPI call recorder. Disabled it costs a flag test per
+	//! call. Calls are grouped by the file and line they are made from
+	class Trace
+	{
+	public:
+		//! Times one call: made just before it and destroyed after it.
+		//! Also usable on its own to time a block, see HAPI_TRACE_SCOPE
+		class Scope
+		{
+		public:
+			Scope(const char* call, const char* file, int line, size_t bytes):
+				myCall(call), myFile(file), myLine(line), myBytes(bytes),
+				myActive(Trace::myEnabled), myStart(0)
+			{
+				if (myActive) myStart = Trace::now();
+			}
+
+			~Scope()
+			{
+				if (myActive) Trace::record(myCall, myFile, myLine, myBytes, myStart, Trace::now());
+			}
+
+		private:
+			const char* myCall;
+			const char* myFile;
+			int myLine;
+			size_t myBytes;
+			bool myActive;
+			double myStart;
+		};
+
+		static void setEnabled(bool toggle);
+		static bool isEnabled() { return myEnabled; }
+
+		//! Forget all recorded calls
+		static void clear();
+
+		//! Number of calls recorded since the last clear
+		static int getCallCount();
+
+		//! Write the recorded calls as Chrome trace json, false if the
+		//! file couldn't be written
+		static bool writeChromeTrace(const std::string& path);
+
+		//! One line per call site: calls, total and max time, bytes.
+		//! Slowest sites first
+		static std::string summary();
+
+	private:
+		// microseconds since the first call
+		static double now();
+		static void record(const char* call, const char* file, int line,
+			size_t bytes, double start, double end);
+
+		static bool myEnabled;
+	};
+};
+
+//! Evaluates a HAPI call, timing it when tracing is enabled. bytes is the
+//! size of the data the call moves, 0 if that isn't worth counting
+#define HAPI_TRACE(bytes, call) \
+	(hapi::Trace::Scope(#call, __FILE__, __LINE__, (bytes)), (call))
+
+//! Times the rest of the enclosing block under name
+#define HAPI_TRACE_SCOPE(name) \
+	hapi::Trace::Scope hapiTraceScope(name, __FILE__, __LINE__, 0)
+
+#endif
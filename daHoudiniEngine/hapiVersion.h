@@ -0,0 +1,56 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+-------------------------------------------------------------------------------
+
+daHEngine
+	HAPI calls that depend on the Houdini Engine version being built against
+
+******************************************************************************/
+
+#ifndef __HE_HAPI_VERSION__
+#define __HE_HAPI_VERSION__
+
+#include <HAPI/HAPI_Version.h>
+
+// HAPI_GetStringBatchSize and HAPI_GetStringBatch came with Houdini Engine
+// 3.2 (Houdini 17). Older versions resolve string handles one at a time
+#if HAPI_VERSION_HOUDINI_ENGINE_MAJOR > 3 || \
+	(HAPI_VERSION_HOUDINI_ENGINE_MAJOR == 3 && HAPI_VERSION_HOUDINI_ENGINE_MINOR >= 2)
+	#define HAPI_HAS_STRING_BATCH 1
+#else
+	#define HAPI_HAS_STRING_BATCH 0
+#endif
+
+#endif
@@ -80,12 +80,15 @@ Based on ModelGeometry from the Cyclops project
 #include <osg/Geometry>
 #include <osg/Billboard>
 #include <osg/Node>
+#include <osg/Version>
 
 #define OMEGA_NO_GL_HEADERS
 #include <omega.h>
 #include <omegaOsg/omegaOsg.h>
 #include <omegaToolkit.h>
 
+#include <daHoudiniEngine/sharedDataTools.h>
+
 #include <vector>
 
 namespace houdiniEngine {
@@ -93,6 +96,44 @@ namespace houdiniEngine {
 	using namespace omega;
 	using namespace omegaOsg;
 
+	//! Draws a part's geometry once per transform, for packed primitive
+	//! instancers. Stands in for the geometry in the geode, the geometry
+	//! itself stays in its HPart and keeps its arrays, hash and syncing.
+	//! The vertex buffers are shared by all instances
+	class InstancedDrawable : public osg::Drawable
+	{
+	public:
+		InstancedDrawable() {}
+		InstancedDrawable(osg::Geometry* source): mySource(source) {}
+		InstancedDrawable(const InstancedDrawable& other, const osg::CopyOp& copyop = osg::CopyOp::SHALLOW_COPY):
+			osg::Drawable(other, copyop), mySource(other.mySource), myInstances(other.myInstances) {}
+
+		META_Object(houdiniEngine, InstancedDrawable);
+
+		osg::Geometry* getSource() const { return mySource.get(); }
+
+		void setInstances(const vector<osg::Matrixf>& instances) {
+			myInstances = instances;
+			dirtyBound();
+		}
+		const vector<osg::Matrixf>& getInstances() const { return myInstances; }
+
+		virtual void drawImplementation(osg::RenderInfo& renderInfo) const;
+		virtual void compileGLObjects(osg::RenderInfo& renderInfo) const;
+		virtual void resizeGLObjectBuffers(unsigned int maxSize);
+		virtual void releaseGLObjects(osg::State* state = 0) const;
+
+#if OSG_VERSION_GREATER_OR_EQUAL(3, 3, 2)
+		virtual osg::BoundingBox computeBoundingBox() const;
+#else
+		virtual osg::BoundingBox computeBound() const;
+#endif
+
+	private:
+		Ref<osg::Geometry> mySource;
+		vector<osg::Matrixf> myInstances;
+	};
+
 	typedef struct {
  		Ref<osg::Vec3Array> vertices;
  		Ref<osg::Vec4Array> colors;
@@ -102,8 +143,73 @@ namespace houdiniEngine {
 		int matId; // material id used by this part
 		// TODO: change this to a stateset
 		bool transparent; // whether this part should be transparent
+		HashValue hash; // content hash, from updateHash()
+		HashValue sentHash; // hash of the content last sent to the slaves
+		HashValue instanceHash; // of the instance transforms, from updateHash()
+		HashValue sentInstanceHash; // of the instance transforms last sent
+		HashValue topology; // connectivity the arrays were built for, 0 if unknown
+		vector<int> sourcePoints; // point each vertex came from
+		vector<int> sourceCorners; // houdini vertex each vertex came from
+		Ref<InstancedDrawable> instancer; // kept once made, see setInstances
+		bool instanced; // instancer is in the geode instead of geometry
 	} HPart;
 
+	//! Arrays and primitive sets for one part, built away from the scene
+	//! graph (eg. on a worker thread) and handed over with
+	//! HoudiniGeometry::setPartArrays. Normals, colors and uvs stay NULL
+	//! until first used, like in HPart
+	struct PartArrays {
+		Ref<osg::Vec3Array> vertices;
+		Ref<osg::Vec4Array> colors;
+		Ref<osg::Vec3Array> normals;
+		Ref<osg::Vec3Array> uvs;
+		vector < Ref<osg::PrimitiveSet> > primitives;
+
+		//! Fingerprint of the connectivity these arrays were built for (0 if
+		//! they can't be updated in place) and, unless every vertex is a
+		//! point, the point and houdini vertex each vertex was built from
+		HashValue topology;
+		vector<int> sourcePoints;
+		vector<int> sourceCorners;
+
+		PartArrays(): vertices(new osg::Vec3Array()), topology(0) {}
+
+		osg::Vec4Array* getOrCreateColors() {
+			if (colors == NULL) colors = new osg::Vec4Array();
+			return colors;
+		}
+		osg::Vec3Array* getOrCreateNormals() {
+			if (normals == NULL) normals = new osg::Vec3Array();
+			return normals;
+		}
+		osg::Vec3Array* getOrCreateUVs() {
+			if (uvs == NULL) uvs = new osg::Vec3Array();
+			return uvs;
+		}
+
+		int addVertex(const Vector3f& v) {
+			vertices->push_back(osg::Vec3(v[0], v[1], v[2]));
+			return vertices->size() - 1;
+		}
+		void addNormal(const Vector3f& v) {
+			getOrCreateNormals()->push_back(osg::Vec3(v[0], v[1], v[2]));
+		}
+		void addColor(const Color& c) {
+			getOrCreateColors()->push_back(osg::Vec4(c[0], c[1], c[2], c[3]));
+		}
+		void addUV(const Vector3f& uv) {
+			getOrCreateUVs()->push_back(osg::Vec3(uv[0], uv[1], uv[2]));
+		}
+		void addPrimitiveOsg(osg::PrimitiveSet::Mode type, int startIndex, int count) {
+			primitives.push_back(new osg::DrawArrays(type, startIndex, count));
+		}
+		osg::DrawElementsUInt* addPrimitiveElements(osg::PrimitiveSet::Mode type) {
+			osg::DrawElementsUInt* de = new osg::DrawElementsUInt(type);
+			primitives.push_back(de);
+			return de;
+		}
+	};
+
 	typedef struct {
 		vector < HPart > hparts;
 		Ref<osg::Geode> geode;
@@ -116,6 +222,11 @@ namespace houdiniEngine {
 		Ref<osg::Transform> trans;
 		bool transformChanged;
 		bool geosChanged;
+		// transform last sent to the slaves
+		bool transformSent;
+		osg::Vec3d sentPos;
+		osg::Quat sentRot;
+		osg::Vec3d sentScale;
 	} HObj;
 
 	/*
@@ -347,6 +458,49 @@ namespace houdiniEngine {
 			const int objIndex
 		);
 
+		//! Adds an empty indexed primitive set and returns it for filling
+		osg::DrawElementsUInt* addPrimitiveElements(
+			osg::PrimitiveSet::Mode type,
+			const int drawableIndex,
+			const int geodeIndex,
+			const int objIndex
+		);
+
+		//! Replaces a part's arrays and primitive sets with prebuilt ones
+		void setPartArrays(
+			const PartArrays& arrays,
+			const int drawableIndex,
+			const int geodeIndex,
+			const int objIndex
+		);
+
+		//! Draws the part once per transform (packed primitive instancing),
+		//! an empty list hides it. clearInstances goes back to drawing it
+		//! once, as does clearDrawable. Either way the part's geometry and
+		//! the state set of its drawable stay the same
+		void setInstances(
+			const vector<osg::Matrixf>& instances,
+			const int drawableIndex,
+			const int geodeIndex,
+			const int objIndex
+		);
+		void clearInstances(const int drawableIndex, const int geodeIndex, const int objIndex);
+
+		bool isInstanced(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].instanced;
+		}
+		const vector<osg::Matrixf>& getInstances(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			static const vector<osg::Matrixf> none;
+			HPart& hpart = hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex];
+			return hpart.instanced ? hpart.instancer->getInstances() : none;
+		}
+
+		//! The part's geometry. Use this rather than the geode's drawable,
+		//! which is an InstancedDrawable for instanced parts
+		osg::Geometry* getGeometry(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].geometry;
+		}
+
 		//! Removes all vertices, colors and primitives from this object
 		void clearDrawable(const int drawableIndex, const int geodeIndex, const int objIndex);
 		void clearGeode(const int geodeIndex, const int objIndex);
@@ -403,6 +557,38 @@ namespace houdiniEngine {
 			hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].uvs->size();
 		}
 
+		//! Direct access to the part arrays, used for bulk transfers.
+		//! Normals, colors and uvs are NULL until first used
+		osg::Vec3Array* getVertexArray(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].vertices;
+		}
+		osg::Vec3Array* getNormalArray(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].normals;
+		}
+		osg::Vec4Array* getColorArray(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].colors;
+		}
+		osg::Vec3Array* getUVArray(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].uvs;
+		}
+
+		//! What setPartArrays was given as PartArrays::topology,
+		//! sourcePoints and sourceCorners. Cleared with the drawable
+		HashValue getTopology(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].topology;
+		}
+		const vector<int>& getSourcePoints(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].sourcePoints;
+		}
+		const vector<int>& getSourceCorners(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].sourceCorners;
+		}
+
+		//! Creates the array and binds it to the drawable if needed
+		osg::Vec3Array* getOrCreateNormalArray(const int drawableIndex, const int geodeIndex, const int objIndex);
+		osg::Vec4Array* getOrCreateColorArray(const int drawableIndex, const int geodeIndex, const int objIndex);
+		osg::Vec3Array* getOrCreateUVArray(const int drawableIndex, const int geodeIndex, const int objIndex);
+
 		inline int getPrimitiveSetCount(
 			const int drawableIndex,
 			const int geodeIndex,
@@ -418,6 +604,12 @@ namespace houdiniEngine {
 
 		bool objectsChanged;
 
+		//! False until process_asset has filled this from a cook, and again
+		//! once it has been filled from elsewhere (a cache). HAPI's change
+		//! flags only say what changed since the last cook, so they can only
+		//! be trusted to skip parts while this is true
+		bool hapiSynced;
+
 		bool getTransformChanged(const int objIndex) {
 			return hobjs[objIndex].transformChanged;
 		}
@@ -443,6 +635,42 @@ namespace houdiniEngine {
 		}
 
 		void dirty();
+		void dirtyDrawable(const int drawableIndex, const int geodeIndex, const int objIndex);
+
+		//! Content hashes, so the master only sends what actually changed.
+		//! updateHash is called once a part has been filled. The instance
+		//! transforms have their own hash, so moving instances doesn't send
+		//! the geometry they share again
+		void updateHash(const int drawableIndex, const int geodeIndex, const int objIndex);
+
+		//! The geometry or the instances changed since last sent
+		bool isDrawableDirty(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			return isContentDirty(drawableIndex, geodeIndex, objIndex) ||
+				isInstancesDirty(drawableIndex, geodeIndex, objIndex);
+		}
+
+		bool isContentDirty(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			HPart& hpart = hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex];
+			return hpart.hash != hpart.sentHash;
+		}
+
+		bool isInstancesDirty(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			HPart& hpart = hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex];
+			return hpart.instanceHash != hpart.sentInstanceHash;
+		}
+
+		void setDrawableSent(const int drawableIndex, const int geodeIndex, const int objIndex) {
+			HPart& hpart = hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex];
+			hpart.sentHash = hpart.hash;
+			hpart.sentInstanceHash = hpart.instanceHash;
+		}
+
+		bool isGeodeDirty(const int geodeIndex, const int objIndex);
+		bool isObjDirty(const int objIndex);
+
+		//! Compares the object transform against the one last sent
+		bool isTransformDirty(const int objIndex);
+		void setTransformSent(const int objIndex);
 
 		void setMatId(int value, const int drawableIndex, const int geodeIndex, const int objIndex) {
 			hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].matId = value;
@@ -0,0 +1,114 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	helpers for moving HoudiniGeometry arrays across the cluster
+	kept free of omega/osg includes so the stand-alone benchmarks can use them
+
+******************************************************************************/
+
+#ifndef __HE_SHARED_DATA_TOOLS__
+#define __HE_SHARED_DATA_TOOLS__
+
+#include <cstddef>
+#include <cstring>
+
+namespace houdiniEngine {
+
+	typedef unsigned long long HashValue;
+
+	// seed for hashBytes, also the hash of nothing at all
+	static const HashValue HASH_SEED = 0xcbf29ce484222325ULL;
+
+	// cheap 64 bit content hash, eight bytes at a time. Chain calls by passing
+	// the previous result as the seed. Not for anything cryptographic
+	inline HashValue hashBytes(const void* data, size_t size, HashValue h = HASH_SEED)
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+		const HashValue prime = 0x100000001b3ULL;
+
+		for (; size >= 8; size -= 8, p += 8) {
+			HashValue w;
+			memcpy(&w, p, 8);
+			h = (h ^ w) * prime;
+			h ^= h >> 29;
+		}
+		for (; size > 0; --size, ++p) {
+			h = (h ^ *p) * prime;
+		}
+		return h;
+	}
+
+	// hash of an array (osg::Vec3Array, std::vector..), including its length.
+	// A NULL array hashes like an empty one
+	template<typename Array>
+	inline HashValue hashArray(const Array* arr, HashValue h = HASH_SEED)
+	{
+		int count = (arr == NULL) ? 0 : int(arr->size());
+		h = hashBytes(&count, sizeof(count), h);
+		if (count > 0) {
+			h = hashBytes(&arr->front(), count * sizeof(typename Array::value_type), h);
+		}
+		return h;
+	}
+
+	// write an array (osg::Vec3Array, osg::Vec4Array, std::vector..) as a
+	// length-prefixed contiguous blob. A NULL array is sent as an empty one.
+	// Stream needs operator<< for int, and write(const void*, size_t)
+	template<typename Stream, typename Array>
+	inline int writeArray(Stream& out, const Array* arr)
+	{
+		int count = (arr == NULL) ? 0 : int(arr->size());
+		out << count;
+		if (count > 0) {
+			out.write(&arr->front(), count * sizeof(typename Array::value_type));
+		}
+		return count;
+	}
+
+	// read the blob following a count written by writeArray straight into
+	// arr, presizing it first. Stream needs read(void*, size_t)
+	template<typename Stream, typename Array>
+	inline void readArrayData(Stream& in, Array* arr, const int count)
+	{
+		arr->resize(count);
+		if (count > 0) {
+			in.read(&arr->front(), count * sizeof(typename Array::value_type));
+		}
+	}
+
+};
+
+#endif
@@ -23,6 +23,10 @@ baseDir = os.path.realpath('../../otl') + "/"
 # init stuff
 he = HoudiniEngine.createAndInitialize()
 he.setLoggingEnabled(False)
+# trade master cpu for bandwidth to the cluster nodes, eg quantised + lz:
+# he.setGeometryCompression(GeometryCompression.All)
+# share points between faces instead of sending every face corner:
+# he.setIndexedGeometry(True)
 hg = None
 
 ui = UiModule.createAndInitialize()
@@ -0,0 +1,323 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+sharedDataBench
+	stand-alone benchmark of the geometry section of commitSharedData and
+	updateSharedData. Compares the old per-element protocol against the bulk
+	length-prefixed arrays and the compression modes of geometryCodec.
+	Needs no omegalib, osg or Houdini Engine.
+
+	run like this:
+
+	./sharedDataBench [vertex count] [iterations]
+
+******************************************************************************/
+
+#include <daHoudiniEngine/sharedDataTools.h>
+#include <daHoudiniEngine/geometryCodec.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+using namespace houdiniEngine;
+
+// same layout as osg::Vec3f / Vector3f and osg::Vec4f / Color
+struct Vec3 { float v[3]; };
+struct Vec4 { float v[4]; };
+
+typedef std::vector<Vec3> Vec3Array;
+typedef std::vector<Vec4> Vec4Array;
+
+// a part, as stored in HPart
+struct Part {
+	Vec3Array vertices;
+	Vec3Array normals;
+	Vec4Array colors;
+	Vec3Array uvs;
+};
+
+// mimics omega::SharedOStream: a growing byte buffer, operator<< writes the
+// raw bytes of a value
+class OStream {
+public:
+	std::vector<char> buffer;
+
+	void write(const void* data, size_t size) {
+		size_t pos = buffer.size();
+		buffer.resize(pos + size);
+		memcpy(&buffer[pos], data, size);
+	}
+
+	template<typename T> OStream& operator<<(const T& value) {
+		write(&value, sizeof(T));
+		return *this;
+	}
+};
+
+// mimics omega::SharedIStream
+class IStream {
+public:
+	IStream(const std::vector<char>& buf): buffer(buf), pos(0) {}
+
+	void read(void* data, size_t size) {
+		memcpy(data, &buffer[pos], size);
+		pos += size;
+	}
+
+	template<typename T> IStream& operator>>(T& value) {
+		read(&value, sizeof(T));
+		return *this;
+	}
+
+private:
+	const std::vector<char>& buffer;
+	size_t pos;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// the old protocol: a count then every element on its own
+template<typename Array>
+void writeElements(OStream& out, const Array& arr)
+{
+	out << int(arr.size());
+	for (size_t i = 0; i < arr.size(); ++i) {
+		out << arr[i];
+	}
+}
+
+// and on the slave, one addVertex/addNormal/.. per element
+template<typename Array>
+void readElements(IStream& in, Array& arr)
+{
+	int count = 0;
+	in >> count;
+	for (int i = 0; i < count; ++i) {
+		typename Array::value_type v;
+		in >> v;
+		arr.push_back(v);
+	}
+}
+
+void commitPerElement(OStream& out, const Part& p)
+{
+	writeElements(out, p.vertices);
+	writeElements(out, p.normals);
+	writeElements(out, p.colors);
+	writeElements(out, p.uvs);
+}
+
+void updatePerElement(IStream& in, Part& p)
+{
+	p.vertices.clear(); p.normals.clear(); p.colors.clear(); p.uvs.clear();
+	readElements(in, p.vertices);
+	readElements(in, p.normals);
+	readElements(in, p.colors);
+	readElements(in, p.uvs);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// the bulk protocol, as used by HoudiniEngine::commitSharedData
+void commitBulk(OStream& out, const Part& p)
+{
+	writeArray(out, &p.vertices);
+	writeArray(out, &p.normals);
+	writeArray(out, &p.colors);
+	writeArray(out, &p.uvs);
+}
+
+template<typename Array>
+void readBulk(IStream& in, Array& arr)
+{
+	int count = 0;
+	in >> count;
+	readArrayData(in, &arr, count);
+}
+
+void updateBulk(IStream& in, Part& p)
+{
+	readBulk(in, p.vertices);
+	readBulk(in, p.normals);
+	readBulk(in, p.colors);
+	readBulk(in, p.uvs);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// compressed, flags as set with HoudiniEngine.setGeometryCompression()
+int compressionFlags = COMPRESS_NONE;
+
+void commitCompressed(OStream& out, const Part& p)
+{
+	writePositionArray(out, &p.vertices, compressionFlags);
+	writeNormalArray(out, &p.normals, compressionFlags);
+	writeColorArray(out, &p.colors, compressionFlags);
+	writeFloatArray(out, &p.uvs, compressionFlags);
+}
+
+void updateCompressed(IStream& in, Part& p)
+{
+	int count = 0;
+	in >> count;
+	readPositionArrayData(in, &p.vertices, count, compressionFlags);
+	in >> count;
+	readNormalArrayData(in, &p.normals, count, compressionFlags);
+	in >> count;
+	readColorArrayData(in, &p.colors, count, compressionFlags);
+	in >> count;
+	readFloatArrayData(in, &p.uvs, count, compressionFlags);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double now()
+{
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// a wavy grid, de-indexed into quads like process_part does, so the arrays
+// look like real geometry rather than noise
+void makePart(Part& p, int count)
+{
+	int side = int(sqrt(count / 4.0f)) + 1;
+	p.vertices.resize(count);
+	p.normals.resize(count);
+	p.colors.resize(count);
+	p.uvs.resize(count);
+	const int corner[4][2] = { {0, 0}, {1, 0}, {1, 1}, {0, 1} };
+	for (int i = 0; i < count; ++i) {
+		int quad = i / 4;
+		float u = float(quad % side + corner[i % 4][0]) / side;
+		float v = float(quad / side + corner[i % 4][1]) / side;
+		float h = 0.1f * sinf(u * 12.0f) * cosf(v * 9.0f);
+		float dhdu = 1.2f * cosf(u * 12.0f) * cosf(v * 9.0f);
+		float dhdv = -0.9f * sinf(u * 12.0f) * sinf(v * 9.0f);
+		float len = sqrtf(dhdu * dhdu + dhdv * dhdv + 1.0f);
+
+		Vec3 pos = { { u * 100.0f, h * 100.0f, v * 100.0f } };
+		Vec3 n = { { -dhdu / len, 1.0f / len, -dhdv / len } };
+		Vec4 c = { { u, v, 0.5f + h, 1.0f } };
+		Vec3 uv = { { u, v, 0.0f } };
+		p.vertices[i] = pos;
+		p.normals[i] = n;
+		p.colors[i] = c;
+		p.uvs[i] = uv;
+	}
+}
+
+template<typename Array>
+float maxError(const Array& a, const Array& b)
+{
+	if (a.size() != b.size()) return INFINITY;
+	if (a.empty()) return 0;
+	const float* fa = reinterpret_cast<const float*>(&a[0]);
+	const float* fb = reinterpret_cast<const float*>(&b[0]);
+	size_t n = a.size() * sizeof(typename Array::value_type) / sizeof(float);
+	float err = 0;
+	for (size_t i = 0; i < n; ++i) {
+		err = std::max(err, fabsf(fa[i] - fb[i]));
+	}
+	return err;
+}
+
+// largest error over all the arrays
+float partError(const Part& a, const Part& b)
+{
+	return std::max(std::max(maxError(a.vertices, b.vertices), maxError(a.normals, b.normals)),
+		std::max(maxError(a.colors, b.colors), maxError(a.uvs, b.uvs)));
+}
+
+typedef void (*CommitFn)(OStream&, const Part&);
+typedef void (*UpdateFn)(IStream&, Part&);
+
+void run(const char* name, CommitFn commit, UpdateFn update, const Part& src, int iterations)
+{
+	double commitTime = 0, updateTime = 0;
+	size_t bytes = 0;
+	float error = 0;
+
+	for (int it = 0; it < iterations; ++it) {
+		OStream out;
+		double t0 = now();
+		commit(out, src);
+		double t1 = now();
+
+		Part dst;
+		IStream in(out.buffer);
+		update(in, dst);
+		double t2 = now();
+
+		commitTime += t1 - t0;
+		updateTime += t2 - t1;
+		bytes = out.buffer.size();
+		error = std::max(error, partError(src, dst));
+	}
+
+	double mb = double(bytes) / (1024.0 * 1024.0);
+	printf("%-18s %8.1f MB  commit %8.2f ms  update %8.2f ms  max error %g\n",
+		name, mb,
+		1000.0 * commitTime / iterations,
+		1000.0 * updateTime / iterations,
+		error);
+}
+
+int main(int argc, char** argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 2000000;
+	int iterations = argc > 2 ? atoi(argv[2]) : 5;
+
+	printf("%d vertices (with normals, colors and uvs), %d iterations\n", count, iterations);
+
+	Part src;
+	makePart(src, count);
+
+	run("per-element", commitPerElement, updatePerElement, src, iterations);
+	run("bulk", commitBulk, updateBulk, src, iterations);
+
+	const struct { const char* name; int flags; } modes[] = {
+		{ "lz", COMPRESS_LZ },
+		{ "quantized", COMPRESS_POSITIONS | COMPRESS_NORMALS | COMPRESS_COLORS },
+		{ "quantized+lz", COMPRESS_ALL },
+	};
+	for (int i = 0; i < 3; ++i) {
+		compressionFlags = modes[i].flags;
+		run(modes[i].name, commitCompressed, updateCompressed, src, iterations);
+	}
+
+	return 0;
+}
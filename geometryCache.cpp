@@ -0,0 +1,451 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	read-only, mappable geometry cache files, see geometryCache.h
+
+******************************************************************************/
+
+#include <daHoudiniEngine/geometryCache.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef WIN32
+	#include <vector>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace houdiniEngine;
+
+namespace {
+	inline unsigned long long alignUp(unsigned long long v)
+	{
+		return (v + GEOMETRY_CACHE_ALIGN - 1) & ~((unsigned long long)GEOMETRY_CACHE_ALIGN - 1);
+	}
+
+	// an array waiting to be written at its offset
+	struct Blob {
+		const void* data;
+		size_t size;
+		unsigned long long offset;
+	};
+
+	// gives the array its place in the file, after the previous one
+	void placeArray(GeometryCacheArray& a, const void* data, const size_t count, const size_t elemSize,
+		unsigned long long& offset, vector<Blob>& blobs)
+	{
+		a.count = count;
+		a.offset = 0;
+		if (count == 0) {
+			return;
+		}
+
+		offset = alignUp(offset);
+		a.offset = offset;
+		Blob b = { data, count * elemSize, offset };
+		blobs.push_back(b);
+		offset += b.size;
+	}
+
+	// the whole file, mapped read-only where possible
+	class MappedFile {
+	public:
+		MappedFile(const String& path): myData(NULL), mySize(0)
+		{
+#ifdef WIN32
+			std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+			if (!in.good()) return;
+			myBuffer.resize(size_t(in.tellg()));
+			in.seekg(0);
+			if (!myBuffer.empty() && in.read(&myBuffer[0], myBuffer.size())) {
+				myData = &myBuffer[0];
+				mySize = myBuffer.size();
+			}
+#else
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) return;
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size > 0) {
+				void* p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (p != MAP_FAILED) {
+					myData = static_cast<const char*>(p);
+					mySize = st.st_size;
+				}
+			}
+			// the mapping stays valid without the descriptor
+			close(fd);
+#endif
+		}
+
+		~MappedFile()
+		{
+#ifndef WIN32
+			if (myData != NULL) {
+				munmap(const_cast<char*>(myData), mySize);
+			}
+#endif
+		}
+
+		const char* data() const { return myData; }
+		size_t size() const { return mySize; }
+
+		// true if count elements of elemSize at a.offset lie inside the file
+		bool holds(const GeometryCacheArray& a, const size_t elemSize) const
+		{
+			if (a.count == 0) return true;
+			if (a.offset > mySize) return false;
+			return a.count <= (mySize - a.offset) / elemSize;
+		}
+
+	private:
+		const char* myData;
+		size_t mySize;
+#ifdef WIN32
+		vector<char> myBuffer;
+#endif
+	};
+
+	template<typename Array>
+	void copyArray(Array* arr, const MappedFile& file, const GeometryCacheArray& a)
+	{
+		arr->resize(size_t(a.count));
+		if (a.count > 0) {
+			memcpy(&arr->front(), file.data() + a.offset, size_t(a.count) * sizeof(typename Array::value_type));
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool houdiniEngine::saveGeometryCache(HoudiniGeometry* hg, const String& path)
+{
+	GeometryCacheHeader header;
+	memcpy(header.magic, GEOMETRY_CACHE_MAGIC, sizeof(header.magic));
+	header.version = GEOMETRY_CACHE_VERSION;
+	header.objectCount = hg->getObjectCount();
+	header.partCount = 0;
+	header.primitiveCount = 0;
+
+	// count first, the arrays go after the tables
+	for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
+		for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
+			for (int d = 0; d < hg->getDrawableCount(g, obj); ++d) {
+				header.partCount++;
+				header.primitiveCount += hg->getPrimitiveSetCount(d, g, obj);
+			}
+		}
+	}
+
+	unsigned long long offset = sizeof(GeometryCacheHeader) +
+		header.objectCount * sizeof(GeometryCacheObject) +
+		header.partCount * sizeof(GeometryCachePart) +
+		header.primitiveCount * sizeof(GeometryCachePrimitive);
+
+	vector<GeometryCacheObject> objects;
+	vector<GeometryCachePart> parts;
+	vector<GeometryCachePrimitive> primitives;
+	vector<Blob> blobs;
+
+	for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
+		osg::PositionAttitudeTransform* pat = hg->getOsgNode()->asGroup()->getChild(obj)->asTransform()->
+			asPositionAttitudeTransform();
+		GeometryCacheObject co;
+		memset(&co, 0, sizeof(co));
+		for (int i = 0; i < 3; ++i) co.pos[i] = pat->getPosition()[i];
+		for (int i = 0; i < 4; ++i) co.rot[i] = pat->getAttitude()[i];
+		for (int i = 0; i < 3; ++i) co.scale[i] = pat->getScale()[i];
+		co.geodeCount = hg->getGeodeCount(obj);
+		objects.push_back(co);
+
+		for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
+			for (int d = 0; d < hg->getDrawableCount(g, obj); ++d) {
+				GeometryCachePart cp;
+				memset(&cp, 0, sizeof(cp));
+				cp.objIndex = obj;
+				cp.geodeIndex = g;
+				cp.drawableIndex = d;
+				cp.matId = hg->getMatId(d, g, obj);
+				cp.transparent = hg->isTransparent(d, g, obj) ? 1 : 0;
+
+				osg::Vec3Array* vertices = hg->getVertexArray(d, g, obj);
+				osg::Vec3Array* normals = hg->getNormalArray(d, g, obj);
+				osg::Vec4Array* colors = hg->getColorArray(d, g, obj);
+				osg::Vec3Array* uvs = hg->getUVArray(d, g, obj);
+				placeArray(cp.vertices, vertices == NULL || vertices->empty() ? NULL : &vertices->front(),
+					vertices == NULL ? 0 : vertices->size(), sizeof(osg::Vec3), offset, blobs);
+				placeArray(cp.normals, normals == NULL || normals->empty() ? NULL : &normals->front(),
+					normals == NULL ? 0 : normals->size(), sizeof(osg::Vec3), offset, blobs);
+				placeArray(cp.colors, colors == NULL || colors->empty() ? NULL : &colors->front(),
+					colors == NULL ? 0 : colors->size(), sizeof(osg::Vec4), offset, blobs);
+				placeArray(cp.uvs, uvs == NULL || uvs->empty() ? NULL : &uvs->front(),
+					uvs == NULL ? 0 : uvs->size(), sizeof(osg::Vec3), offset, blobs);
+
+				const vector<osg::Matrixf>& instances = hg->getInstances(d, g, obj);
+				cp.instanced = hg->isInstanced(d, g, obj) ? 1 : 0;
+				placeArray(cp.instances, instances.empty() ? NULL : &instances[0],
+					instances.size(), sizeof(osg::Matrixf), offset, blobs);
+
+				osg::Geometry* geo = hg->getGeometry(d, g, obj);
+				const osg::Geometry::PrimitiveSetList& psl = geo->getPrimitiveSetList();
+				cp.firstPrimitive = primitives.size();
+				cp.primitiveCount = psl.size();
+				for (int i = 0; i < psl.size(); ++i) {
+					GeometryCachePrimitive prim;
+					memset(&prim, 0, sizeof(prim));
+					prim.mode = psl[i]->getMode();
+
+					osg::DrawElementsUInt* de = dynamic_cast<osg::DrawElementsUInt*>(psl[i].get());
+					osg::DrawArrays* da = dynamic_cast<osg::DrawArrays*>(psl[i].get());
+					if (de != NULL) {
+						prim.first = -1;
+						prim.count = de->size();
+						placeArray(prim.indices, de->empty() ? NULL : &de->front(),
+							de->size(), sizeof(GLuint), offset, blobs);
+					} else if (da != NULL) {
+						prim.first = da->getFirst();
+						prim.count = da->getCount();
+					}
+					primitives.push_back(prim);
+				}
+
+				parts.push_back(cp);
+			}
+		}
+	}
+
+	header.fileSize = offset;
+
+	// write to a temporary file first, readers never see half a cache
+	String tmpPath = path + ".tmp";
+	{
+		std::ofstream out(tmpPath.c_str(), std::ios::binary | std::ios::trunc);
+		if (!out.good()) {
+			ofwarn("[saveGeometryCache] unable to write %1%", %tmpPath);
+			return false;
+		}
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		if (!objects.empty()) {
+			out.write(reinterpret_cast<const char*>(&objects[0]), objects.size() * sizeof(GeometryCacheObject));
+		}
+		if (!parts.empty()) {
+			out.write(reinterpret_cast<const char*>(&parts[0]), parts.size() * sizeof(GeometryCachePart));
+		}
+		if (!primitives.empty()) {
+			out.write(reinterpret_cast<const char*>(&primitives[0]), primitives.size() * sizeof(GeometryCachePrimitive));
+		}
+
+		unsigned long long written = sizeof(GeometryCacheHeader) +
+			objects.size() * sizeof(GeometryCacheObject) +
+			parts.size() * sizeof(GeometryCachePart) +
+			primitives.size() * sizeof(GeometryCachePrimitive);
+		static const char zeros[GEOMETRY_CACHE_ALIGN] = { 0 };
+		for (int i = 0; i < blobs.size(); ++i) {
+			out.write(zeros, size_t(blobs[i].offset - written));
+			out.write(static_cast<const char*>(blobs[i].data), blobs[i].size);
+			written = blobs[i].offset + blobs[i].size;
+		}
+
+		if (!out.good()) {
+			ofwarn("[saveGeometryCache] failed writing %1%", %tmpPath);
+			out.close();
+			remove(tmpPath.c_str());
+			return false;
+		}
+	}
+
+	if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+		ofwarn("[saveGeometryCache] unable to move %1% into place", %tmpPath);
+		remove(tmpPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool houdiniEngine::loadGeometryCache(HoudiniGeometry* hg, const String& path)
+{
+	MappedFile file(path);
+	if (file.data() == NULL) {
+		return false;
+	}
+
+	// check everything before touching hg
+	if (file.size() < sizeof(GeometryCacheHeader)) {
+		ofwarn("[loadGeometryCache] %1% is too short", %path);
+		return false;
+	}
+
+	GeometryCacheHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+	if (memcmp(header.magic, GEOMETRY_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != GEOMETRY_CACHE_VERSION ||
+		header.fileSize != file.size()) {
+		ofwarn("[loadGeometryCache] %1% is not a geometry cache of this version", %path);
+		return false;
+	}
+
+	GeometryCacheArray tables;
+	tables.offset = 0;
+	tables.count = sizeof(GeometryCacheHeader) +
+		(unsigned long long)header.objectCount * sizeof(GeometryCacheObject) +
+		(unsigned long long)header.partCount * sizeof(GeometryCachePart) +
+		(unsigned long long)header.primitiveCount * sizeof(GeometryCachePrimitive);
+	if (!file.holds(tables, 1)) {
+		ofwarn("[loadGeometryCache] %1% is truncated", %path);
+		return false;
+	}
+
+	// the tables are read in place, the writer put them at 8 byte offsets
+	const GeometryCacheObject* objects = reinterpret_cast<const GeometryCacheObject*>(
+		file.data() + sizeof(GeometryCacheHeader));
+	const GeometryCachePart* parts = reinterpret_cast<const GeometryCachePart*>(
+		objects + header.objectCount);
+	const GeometryCachePrimitive* primitives = reinterpret_cast<const GeometryCachePrimitive*>(
+		parts + header.partCount);
+
+	for (unsigned int i = 0; i < header.partCount; ++i) {
+		const GeometryCachePart& cp = parts[i];
+		bool ok = cp.objIndex >= 0 && cp.objIndex < int(header.objectCount) &&
+			cp.geodeIndex >= 0 && cp.geodeIndex < int(objects[cp.objIndex].geodeCount) &&
+			cp.drawableIndex >= 0 &&
+			cp.firstPrimitive <= header.primitiveCount &&
+			cp.primitiveCount <= header.primitiveCount - cp.firstPrimitive &&
+			file.holds(cp.vertices, sizeof(osg::Vec3)) &&
+			file.holds(cp.normals, sizeof(osg::Vec3)) &&
+			file.holds(cp.colors, sizeof(osg::Vec4)) &&
+			file.holds(cp.uvs, sizeof(osg::Vec3)) &&
+			file.holds(cp.instances, sizeof(osg::Matrixf));
+		for (unsigned int j = 0; ok && j < cp.primitiveCount; ++j) {
+			ok = file.holds(primitives[cp.firstPrimitive + j].indices, sizeof(GLuint));
+		}
+		if (!ok) {
+			ofwarn("[loadGeometryCache] %1% has a corrupt part table", %path);
+			return false;
+		}
+	}
+
+	// objects and their transforms. Everything is emptied first, whatever
+	// the file doesn't fill stays empty
+	if (hg->getObjectCount() < int(header.objectCount)) {
+		hg->addObject(header.objectCount - hg->getObjectCount());
+	}
+
+	for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
+		hg->clearObj(obj);
+		if (obj >= int(header.objectCount)) {
+			continue;
+		}
+
+		const GeometryCacheObject& co = objects[obj];
+		osg::PositionAttitudeTransform* pat = hg->getOsgNode()->asGroup()->getChild(obj)->asTransform()->
+			asPositionAttitudeTransform();
+		pat->setPosition(osg::Vec3d(co.pos[0], co.pos[1], co.pos[2]));
+		pat->setAttitude(osg::Quat(co.rot[0], co.rot[1], co.rot[2], co.rot[3]));
+		pat->setScale(osg::Vec3d(co.scale[0], co.scale[1], co.scale[2]));
+
+		if (hg->getGeodeCount(obj) < int(co.geodeCount)) {
+			hg->addGeode(co.geodeCount - hg->getGeodeCount(obj), obj);
+		}
+	}
+
+	// drawables of each geode, parts come in object, geode, drawable order
+	for (unsigned int i = 0; i < header.partCount; ) {
+		const int obj = parts[i].objIndex;
+		const int g = parts[i].geodeIndex;
+
+		unsigned int end = i;
+		int drawableCount = 0;
+		while (end < header.partCount && parts[end].objIndex == obj && parts[end].geodeIndex == g) {
+			drawableCount = std::max(drawableCount, parts[end].drawableIndex + 1);
+			++end;
+		}
+
+		if (hg->getDrawableCount(g, obj) < drawableCount) {
+			hg->addDrawable(drawableCount - hg->getDrawableCount(g, obj), g, obj);
+		}
+
+		for (; i < end; ++i) {
+			const GeometryCachePart& cp = parts[i];
+
+			PartArrays arrays;
+			copyArray(arrays.vertices.get(), file, cp.vertices);
+			if (cp.normals.count > 0) copyArray(arrays.getOrCreateNormals(), file, cp.normals);
+			if (cp.colors.count > 0) copyArray(arrays.getOrCreateColors(), file, cp.colors);
+			if (cp.uvs.count > 0) copyArray(arrays.getOrCreateUVs(), file, cp.uvs);
+
+			for (unsigned int j = 0; j < cp.primitiveCount; ++j) {
+				const GeometryCachePrimitive& prim = primitives[cp.firstPrimitive + j];
+				osg::PrimitiveSet::Mode mode = osg::PrimitiveSet::Mode(prim.mode);
+				if (prim.first < 0) {
+					copyArray(arrays.addPrimitiveElements(mode), file, prim.indices);
+				} else {
+					arrays.addPrimitiveOsg(mode, prim.first, prim.count);
+				}
+			}
+
+			hg->setPartArrays(arrays, cp.drawableIndex, g, obj);
+
+			if (cp.instanced) {
+				vector<osg::Matrixf> instances;
+				copyArray(&instances, file, cp.instances);
+				hg->setInstances(instances, cp.drawableIndex, g, obj);
+			}
+			hg->setMatId(cp.matId, cp.drawableIndex, g, obj);
+			hg->setTransparent(cp.transparent != 0, cp.drawableIndex, g, obj);
+		}
+	}
+
+	// rehash everything, cleared parts included
+	for (int obj = 0; obj < hg->getObjectCount(); ++obj) {
+		for (int g = 0; g < hg->getGeodeCount(obj); ++g) {
+			for (int d = 0; d < hg->getDrawableCount(g, obj); ++d) {
+				hg->updateHash(d, g, obj);
+			}
+		}
+	}
+
+	hg->objectsChanged = true;
+	hg->hapiSynced = false;
+
+	return true;
+}
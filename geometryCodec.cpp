@@ -0,0 +1,324 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	optional compression of the geometry arrays sent across the cluster
+
+******************************************************************************/
+
+#include <daHoudiniEngine/geometryCodec.h>
+
+#include <cmath>
+#include <cstring>
+
+using namespace houdiniEngine;
+
+namespace {
+	inline float clampf(float v, float lo, float hi)
+	{
+		return v < lo ? lo : (v > hi ? hi : v);
+	}
+
+	inline float signNotZero(float v)
+	{
+		return v < 0.0f ? -1.0f : 1.0f;
+	}
+
+	inline unsigned int read32(const char* p)
+	{
+		unsigned int v;
+		memcpy(&v, p, 4);
+		return v;
+	}
+
+	// lz token lengths: 15 in the nibble means more bytes follow
+	inline void writeLength(std::vector<char>& dst, size_t len)
+	{
+		for (; len >= 255; len -= 255) {
+			dst.push_back(char(255));
+		}
+		dst.push_back(char(len));
+	}
+
+	inline bool readLength(const unsigned char*& ip, const unsigned char* end, size_t& len)
+	{
+		unsigned char b;
+		do {
+			if (ip >= end) return false;
+			b = *ip++;
+			len += b;
+		} while (b == 255);
+		return true;
+	}
+
+	const int LZ_MIN_MATCH = 4;
+	const int LZ_HASH_BITS = 16;
+	const size_t LZ_WINDOW = 65535;
+	// the last few bytes always go out as literals
+	const size_t LZ_LAST_LITERALS = 5;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void houdiniEngine::encodePositions(const float* xyz, const int count, float bbox[6], std::vector<unsigned short>& q)
+{
+	for (int c = 0; c < 3; ++c) {
+		bbox[c] = bbox[c + 3] = (count > 0) ? xyz[c] : 0.0f;
+	}
+	for (int i = 0; i < count; ++i) {
+		for (int c = 0; c < 3; ++c) {
+			float v = xyz[i * 3 + c];
+			if (v < bbox[c]) bbox[c] = v;
+			if (v > bbox[c + 3]) bbox[c + 3] = v;
+		}
+	}
+
+	float scale[3];
+	for (int c = 0; c < 3; ++c) {
+		float range = bbox[c + 3] - bbox[c];
+		scale[c] = (range > 0.0f) ? 65535.0f / range : 0.0f;
+	}
+
+	q.resize(count * 3);
+	for (int i = 0; i < count * 3; ++i) {
+		int c = i % 3;
+		q[i] = (unsigned short)((xyz[i] - bbox[c]) * scale[c] + 0.5f);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void houdiniEngine::decodePositions(const unsigned short* q, const int count, const float bbox[6], float* xyz)
+{
+	float scale[3];
+	for (int c = 0; c < 3; ++c) {
+		scale[c] = (bbox[c + 3] - bbox[c]) / 65535.0f;
+	}
+	for (int i = 0; i < count * 3; ++i) {
+		int c = i % 3;
+		xyz[i] = bbox[c] + q[i] * scale[c];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// octahedral mapping: project onto the octahedron |x|+|y|+|z| = 1, fold the
+// lower half over the upper one and keep x, y
+void houdiniEngine::encodeNormals(const float* xyz, const int count, std::vector<short>& q)
+{
+	q.resize(count * 2);
+	for (int i = 0; i < count; ++i) {
+		float x = xyz[i * 3], y = xyz[i * 3 + 1], z = xyz[i * 3 + 2];
+		float l1 = fabsf(x) + fabsf(y) + fabsf(z);
+		float u = 0.0f, v = 0.0f;
+		if (l1 > 0.0f) {
+			u = x / l1;
+			v = y / l1;
+			if (z < 0.0f) {
+				float fu = (1.0f - fabsf(v)) * signNotZero(u);
+				float fv = (1.0f - fabsf(u)) * signNotZero(v);
+				u = fu;
+				v = fv;
+			}
+		}
+		q[i * 2] = short(floorf(clampf(u, -1.0f, 1.0f) * 32767.0f + 0.5f));
+		q[i * 2 + 1] = short(floorf(clampf(v, -1.0f, 1.0f) * 32767.0f + 0.5f));
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void houdiniEngine::decodeNormals(const short* q, const int count, float* xyz)
+{
+	for (int i = 0; i < count; ++i) {
+		float x = clampf(q[i * 2] / 32767.0f, -1.0f, 1.0f);
+		float y = clampf(q[i * 2 + 1] / 32767.0f, -1.0f, 1.0f);
+		float z = 1.0f - fabsf(x) - fabsf(y);
+		if (z < 0.0f) {
+			float fx = (1.0f - fabsf(y)) * signNotZero(x);
+			float fy = (1.0f - fabsf(x)) * signNotZero(y);
+			x = fx;
+			y = fy;
+		}
+		float len = sqrtf(x * x + y * y + z * z);
+		if (len > 0.0f) {
+			x /= len; y /= len; z /= len;
+		}
+		xyz[i * 3] = x;
+		xyz[i * 3 + 1] = y;
+		xyz[i * 3 + 2] = z;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void houdiniEngine::encodeColors(const float* rgba, const int count, std::vector<unsigned char>& q)
+{
+	q.resize(count * 4);
+	for (int i = 0; i < count * 4; ++i) {
+		q[i] = (unsigned char)(clampf(rgba[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void houdiniEngine::decodeColors(const unsigned char* q, const int count, float* rgba)
+{
+	for (int i = 0; i < count * 4; ++i) {
+		rgba[i] = q[i] / 255.0f;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void houdiniEngine::shuffleBytes(const void* src, const size_t size, const size_t stride, char* dst)
+{
+	const char* s = static_cast<const char*>(src);
+	size_t n = size / stride;
+	for (size_t b = 0; b < stride; ++b) {
+		for (size_t i = 0; i < n; ++i) {
+			*dst++ = s[i * stride + b];
+		}
+	}
+	// bytes past the last whole element stay where they are
+	memcpy(dst, s + n * stride, size - n * stride);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void houdiniEngine::unshuffleBytes(const char* src, const size_t size, const size_t stride, void* dst)
+{
+	char* d = static_cast<char*>(dst);
+	size_t n = size / stride;
+	for (size_t b = 0; b < stride; ++b) {
+		for (size_t i = 0; i < n; ++i) {
+			d[i * stride + b] = *src++;
+		}
+	}
+	memcpy(d + n * stride, src, size - n * stride);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// a block is a list of sequences:
+//   token (literal length << 4 | match length - 4), [more literal length],
+//   literals, offset (2 bytes), [more match length]
+// the last sequence only has literals
+size_t houdiniEngine::lzCompress(const char* src, const size_t size, std::vector<char>& dst)
+{
+	dst.clear();
+	dst.reserve(size + size / 255 + 16);
+
+	std::vector<int> table(1 << LZ_HASH_BITS, -1);
+
+	size_t anchor = 0;
+	size_t i = 0;
+	size_t limit = (size > LZ_LAST_LITERALS + LZ_MIN_MATCH) ? size - LZ_LAST_LITERALS - LZ_MIN_MATCH : 0;
+
+	while (i < limit) {
+		unsigned int seq = read32(src + i);
+		unsigned int h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+		int ref = table[h];
+		table[h] = int(i);
+
+		if (ref < 0 || i - ref > LZ_WINDOW || read32(src + ref) != seq) {
+			// skip faster through data that doesn't compress
+			i += 1 + ((i - anchor) >> 6);
+			continue;
+		}
+
+		size_t matchLen = LZ_MIN_MATCH;
+		while (i + matchLen < size - LZ_LAST_LITERALS && src[ref + matchLen] == src[i + matchLen]) {
+			++matchLen;
+		}
+
+		size_t litLen = i - anchor;
+		size_t ml = matchLen - LZ_MIN_MATCH;
+		dst.push_back(char(((litLen < 15 ? litLen : 15) << 4) | (ml < 15 ? ml : 15)));
+		if (litLen >= 15) writeLength(dst, litLen - 15);
+		dst.insert(dst.end(), src + anchor, src + i);
+
+		size_t offset = i - ref;
+		dst.push_back(char(offset & 0xff));
+		dst.push_back(char(offset >> 8));
+		if (ml >= 15) writeLength(dst, ml - 15);
+
+		i += matchLen;
+		anchor = i;
+	}
+
+	size_t litLen = size - anchor;
+	dst.push_back(char((litLen < 15 ? litLen : 15) << 4));
+	if (litLen >= 15) writeLength(dst, litLen - 15);
+	dst.insert(dst.end(), src + anchor, src + size);
+
+	return dst.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool houdiniEngine::lzDecompress(const char* src, const size_t srcSize, char* dst, const size_t dstSize)
+{
+	const unsigned char* ip = reinterpret_cast<const unsigned char*>(src);
+	const unsigned char* end = ip + srcSize;
+	size_t op = 0;
+
+	while (ip < end) {
+		unsigned char token = *ip++;
+
+		size_t litLen = token >> 4;
+		if (litLen == 15 && !readLength(ip, end, litLen)) return false;
+		if (litLen > size_t(end - ip) || op + litLen > dstSize) return false;
+		memcpy(dst + op, ip, litLen);
+		ip += litLen;
+		op += litLen;
+
+		// last sequence
+		if (ip == end) break;
+
+		if (end - ip < 2) return false;
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op) return false;
+
+		size_t matchLen = token & 15;
+		if (matchLen == 15 && !readLength(ip, end, matchLen)) return false;
+		matchLen += LZ_MIN_MATCH;
+		if (op + matchLen > dstSize) return false;
+
+		// overlapping matches (runs) have to go byte by byte
+		const char* match = dst + op - offset;
+		if (offset >= matchLen) {
+			memcpy(dst + op, match, matchLen);
+		} else {
+			for (size_t k = 0; k < matchLen; ++k) {
+				dst[op + k] = match[k];
+			}
+		}
+		op += matchLen;
+	}
+
+	return op == dstSize;
+}
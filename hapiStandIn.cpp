@@ -0,0 +1,984 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	record/replay stand-in for HAPI, see hapiStandIn.h
+
+******************************************************************************/
+
+// the real HAPI functions, not the renamed ones
+#define HAPI_STANDIN_NO_RENAME
+#include <daHoudiniEngine/hapiStandIn.h>
+#include <daHoudiniEngine/sharedDataTools.h>
+
+#define OMEGA_NO_GL_HEADERS
+#include <omega.h>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+using namespace hapi;
+using namespace houdiniEngine;
+using namespace omega;
+
+namespace {
+
+	// bump when the layout of a recording or its keys change
+	const int STANDIN_VERSION = 2;
+	const char STANDIN_MAGIC[8] = { 'H', 'A', 'P', 'I', 'R', 'E', 'C', '\0' };
+
+	// only the first few misses are logged
+	const int MAX_LOGGED_MISSES = 20;
+
+	struct Response
+	{
+		int result;
+		std::vector<std::string> outputs;
+	};
+
+	// the responses to one function and set of inputs, in call order
+	struct ResponseList
+	{
+		ResponseList(): next(0) {}
+
+		std::vector<Response> responses;
+		size_t next;
+	};
+
+	OpenThreads::Mutex standInMutex;
+	StandIn::Mode standInMode = StandIn::Live;
+	std::ofstream recording;
+	std::map<HashValue, ResponseList> replay;
+	int replayMisses = 0;
+
+	// sessions numbered in order of first use, the same on record and
+	// replay as long as the sessions are created in the same order
+	std::map<const HAPI_Session*, int> standInSessions;
+
+	int session_ordinal(const HAPI_Session* session)
+	{
+		std::map<const HAPI_Session*, int>::iterator it = standInSessions.find(session);
+		if (it == standInSessions.end()) {
+			int ordinal = int(standInSessions.size());
+			it = standInSessions.insert(std::make_pair(session, ordinal)).first;
+		}
+		return it->second;
+	}
+
+	template<typename T>
+	void write_value(std::ostream& out, const T& value)
+	{
+		out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<typename T>
+	bool read_value(std::istream& in, T& value)
+	{
+		return bool(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	bool read_string(std::istream& in, std::string& s)
+	{
+		unsigned int size;
+		if (!read_value(in, size)) return false;
+		s.resize(size);
+		return size == 0 || bool(in.read(&s[0], size));
+	}
+
+	// one call to a stand-in. Hashes the inputs into a key, then either
+	// records the real call's outputs under it or serves recorded ones
+	class StandInCall
+	{
+	public:
+		StandInCall(const char* name, const HAPI_Session* session = NULL):
+			myName(name), myKey(hashBytes(name, strlen(name))),
+			myResult(HAPI_RESULT_FAILURE), myResponse(NULL), myOutput(0)
+		{
+			myMode = standInMode;
+			if (myMode != StandIn::Live) {
+				standInMutex.lock();
+				// calls to different sessions of a pool are told apart
+				if (session != NULL) in(session_ordinal(session));
+			}
+		}
+
+		~StandInCall()
+		{
+			if (myMode != StandIn::Live) standInMutex.unlock();
+		}
+
+		template<typename T>
+		StandInCall& in(const T& value)
+		{
+			myKey = hashBytes(&value, sizeof(T), myKey);
+			return *this;
+		}
+
+		// arrays and strings are keyed by content, not address
+		template<typename T>
+		StandInCall& in(const T* values, int count)
+		{
+			if (values == NULL || count < 0) count = 0;
+			myKey = hashBytes(&count, sizeof(count), myKey);
+			myKey = hashBytes(values, count * sizeof(T), myKey);
+			return *this;
+		}
+
+		StandInCall& str(const char* s)
+		{
+			return in(s, s == NULL ? -1 : int(strlen(s)));
+		}
+
+		//! False when replaying: the real function must not be called,
+		//! the outputs come from the recording
+		bool live()
+		{
+			if (myMode != StandIn::Replay) return true;
+
+			std::map<HashValue, ResponseList>::iterator it = replay.find(myKey);
+			if (it == replay.end() || it->second.responses.empty()) {
+				if (replayMisses++ < MAX_LOGGED_MISSES) {
+					ofwarn("[HAPI stand-in] no recorded response for %1%", %myName);
+				}
+				return false;
+			}
+
+			// calls past the recorded ones repeat the last response
+			ResponseList& list = it->second;
+			myResponse = &list.responses[std::min(list.next, list.responses.size() - 1)];
+			list.next++;
+			myResult = HAPI_Result(myResponse->result);
+			return false;
+		}
+
+		void result(HAPI_Result result) { myResult = result; }
+
+		bool isLive() const { return myMode == StandIn::Live; }
+
+		//! An output argument, count elements of T
+		template<typename T>
+		void out(T* data, int count = 1)
+		{
+			if (data == NULL || count < 0) count = 0;
+			size_t size = count * sizeof(T);
+
+			if (myMode == StandIn::Record) {
+				myOutputs.push_back(std::string(reinterpret_cast<const char*>(data), size));
+			} else if (myMode == StandIn::Replay && myResponse != NULL) {
+				if (myOutput < myResponse->outputs.size()) {
+					const std::string& recorded = myResponse->outputs[myOutput];
+					memcpy(data, recorded.data(), std::min(size, recorded.size()));
+				}
+				myOutput++;
+			}
+		}
+
+		HAPI_Result finish()
+		{
+			if (myMode == StandIn::Record && recording) {
+				write_value(recording, myKey);
+				write_value(recording, int(myResult));
+				unsigned int size = (unsigned int) strlen(myName);
+				write_value(recording, size);
+				recording.write(myName, size);
+				write_value(recording, (unsigned int) myOutputs.size());
+				for (size_t i = 0; i < myOutputs.size(); ++i) {
+					size = (unsigned int) myOutputs[i].size();
+					write_value(recording, size);
+					recording.write(myOutputs[i].data(), size);
+				}
+			}
+			return myResult;
+		}
+
+	private:
+		const char* myName;
+		StandIn::Mode myMode;
+		HashValue myKey;
+		HAPI_Result myResult;
+		const Response* myResponse;
+		size_t myOutput;
+		std::vector<std::string> myOutputs;
+	};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+bool StandIn::startRecording(const std::string& path)
+{
+	stop();
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(standInMutex);
+	standInSessions.clear();
+	recording.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!recording) {
+		ofwarn("[HAPI stand-in] could not write %1%", %path);
+		return false;
+	}
+	recording.write(STANDIN_MAGIC, sizeof(STANDIN_MAGIC));
+	write_value(recording, STANDIN_VERSION);
+
+	standInMode = Record;
+	ofmsg("[HAPI stand-in] recording HAPI responses to %1%", %path);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool StandIn::startReplay(const std::string& path)
+{
+	stop();
+
+	std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+	char magic[sizeof(STANDIN_MAGIC)];
+	int version = 0;
+	if (!in || !in.read(magic, sizeof(magic)) || !read_value(in, version) ||
+		memcmp(magic, STANDIN_MAGIC, sizeof(magic)) != 0 || version != STANDIN_VERSION) {
+		ofwarn("[HAPI stand-in] %1% is not a HAPI recording (version %2%)", %path %STANDIN_VERSION);
+		return false;
+	}
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(standInMutex);
+	replay.clear();
+	replayMisses = 0;
+	standInSessions.clear();
+
+	int calls = 0;
+	HashValue key;
+	while (read_value(in, key)) {
+		Response r;
+		std::string name;
+		unsigned int outputs = 0;
+		if (!read_value(in, r.result) || !read_string(in, name) || !read_value(in, outputs)) break;
+
+		r.outputs.resize(outputs);
+		bool complete = true;
+		for (unsigned int i = 0; i < outputs && complete; ++i) {
+			complete = read_string(in, r.outputs[i]);
+		}
+		// a recording cut short by a crash is still usable up to there
+		if (!complete) break;
+
+		replay[key].responses.push_back(r);
+		calls++;
+	}
+
+	standInMode = Replay;
+	ofmsg("[HAPI stand-in] replaying %1% HAPI responses from %2%", %calls %path);
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StandIn::stop()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(standInMutex);
+	if (standInMode == Record) {
+		recording.close();
+	} else if (standInMode == Replay) {
+		if (replayMisses > 0) {
+			ofwarn("[HAPI stand-in] %1% calls had no recorded response", %replayMisses);
+		}
+		replay.clear();
+	}
+	standInMode = Live;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void StandIn::startFromEnvironment()
+{
+	const char* replayPath = std::getenv("DA_HAPI_REPLAY");
+	const char* recordPath = std::getenv("DA_HAPI_RECORD");
+
+	if (replayPath) {
+		startReplay(replayPath);
+	} else if (recordPath) {
+		startRecording(recordPath);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+StandIn::Mode StandIn::getMode()
+{
+	return standInMode;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int StandIn::getMisses()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(standInMutex);
+	return replayMisses;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sessions
+
+HAPI_Result HAPI_StandIn_StartThriftSocketServer(const HAPI_ThriftServerOptions* options, int port, HAPI_ProcessId* process_id)
+{
+	StandInCall c("HAPI_StartThriftSocketServer");
+	c.in(port);
+	if (c.live()) c.result(HAPI_StartThriftSocketServer(options, port, process_id));
+	c.out(process_id);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_CreateThriftSocketSession(HAPI_Session* session, const char* host_name, int port)
+{
+	StandInCall c("HAPI_CreateThriftSocketSession");
+	c.in(port);
+	if (c.live()) c.result(HAPI_CreateThriftSocketSession(session, host_name, port));
+	c.out(session);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_Initialize(const HAPI_Session* session, const HAPI_CookOptions* cook_options,
+	HAPI_Bool use_cooking_thread, int cooking_thread_stack_size, const char* houdini_environment_files,
+	const char* otl_search_path, const char* dso_search_path, const char* image_dso_search_path,
+	const char* audio_dso_search_path)
+{
+	StandInCall c("HAPI_Initialize", session);
+	if (c.live()) c.result(HAPI_Initialize(session, cook_options, use_cooking_thread, cooking_thread_stack_size,
+		houdini_environment_files, otl_search_path, dso_search_path, image_dso_search_path, audio_dso_search_path));
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_Cleanup(const HAPI_Session* session)
+{
+	StandInCall c("HAPI_Cleanup", session);
+	if (c.live()) c.result(HAPI_Cleanup(session));
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetEnvInt(HAPI_EnvIntType int_type, int* value)
+{
+	StandInCall c("HAPI_GetEnvInt");
+	c.in(int_type);
+	if (c.live()) c.result(HAPI_GetEnvInt(int_type, value));
+	c.out(value);
+	return c.finish();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// status and strings
+
+HAPI_Result HAPI_StandIn_GetStatus(const HAPI_Session* session, HAPI_StatusType status_type, int* status)
+{
+	StandInCall c("HAPI_GetStatus", session);
+	c.in(status_type);
+	if (c.live()) c.result(HAPI_GetStatus(session, status_type, status));
+	c.out(status);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetStatusStringBufLength(const HAPI_Session* session, HAPI_StatusType status_type,
+	HAPI_StatusVerbosity verbosity, int* buffer_length)
+{
+	StandInCall c("HAPI_GetStatusStringBufLength", session);
+	c.in(status_type).in(verbosity);
+	if (c.live()) c.result(HAPI_GetStatusStringBufLength(session, status_type, verbosity, buffer_length));
+	c.out(buffer_length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetStatusString(const HAPI_Session* session, HAPI_StatusType status_type,
+	char* string_value, int length)
+{
+	StandInCall c("HAPI_GetStatusString", session);
+	c.in(status_type).in(length);
+	if (c.live()) c.result(HAPI_GetStatusString(session, status_type, string_value, length));
+	c.out(string_value, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetStringBufLength(const HAPI_Session* session, HAPI_StringHandle string_handle, int* buffer_length)
+{
+	StandInCall c("HAPI_GetStringBufLength", session);
+	c.in(string_handle);
+	if (c.live()) c.result(HAPI_GetStringBufLength(session, string_handle, buffer_length));
+	c.out(buffer_length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetString(const HAPI_Session* session, HAPI_StringHandle string_handle, char* string_value, int length)
+{
+	StandInCall c("HAPI_GetString", session);
+	c.in(string_handle).in(length);
+	if (c.live()) c.result(HAPI_GetString(session, string_handle, string_value, length));
+	c.out(string_value, length);
+	return c.finish();
+}
+
+#if HAPI_HAS_STRING_BATCH
+// the batch is keyed by the handles given to the size call before it
+static std::vector<int> standInBatchHandles;
+
+HAPI_Result HAPI_StandIn_GetStringBatchSize(const HAPI_Session* session, const int* string_handle_array,
+	int string_handle_count, int* string_buffer_size)
+{
+	StandInCall c("HAPI_GetStringBatchSize", session);
+	c.in(string_handle_array, string_handle_count);
+	if (!c.isLive()) {
+		standInBatchHandles.assign(string_handle_array, string_handle_array + std::max(string_handle_count, 0));
+	}
+	if (c.live()) c.result(HAPI_GetStringBatchSize(session, string_handle_array, string_handle_count, string_buffer_size));
+	c.out(string_buffer_size);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetStringBatch(const HAPI_Session* session, char* char_buffer, int char_array_length)
+{
+	StandInCall c("HAPI_GetStringBatch", session);
+	c.in(standInBatchHandles.empty() ? NULL : &standInBatchHandles[0], int(standInBatchHandles.size()));
+	c.in(char_array_length);
+	if (c.live()) c.result(HAPI_GetStringBatch(session, char_buffer, char_array_length));
+	c.out(char_buffer, char_array_length);
+	return c.finish();
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// time
+
+HAPI_Result HAPI_StandIn_GetTime(const HAPI_Session* session, float* time)
+{
+	StandInCall c("HAPI_GetTime", session);
+	if (c.live()) c.result(HAPI_GetTime(session, time));
+	c.out(time);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_SetTime(const HAPI_Session* session, float time)
+{
+	StandInCall c("HAPI_SetTime", session);
+	c.in(time);
+	if (c.live()) c.result(HAPI_SetTime(session, time));
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetTimelineOptions(const HAPI_Session* session, HAPI_TimelineOptions* timeline_options)
+{
+	StandInCall c("HAPI_GetTimelineOptions", session);
+	if (c.live()) c.result(HAPI_GetTimelineOptions(session, timeline_options));
+	c.out(timeline_options);
+	return c.finish();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// assets and nodes
+
+HAPI_Result HAPI_StandIn_LoadAssetLibraryFromFile(const HAPI_Session* session, const char* file_path,
+	HAPI_Bool allow_overwrite, HAPI_AssetLibraryId* library_id)
+{
+	StandInCall c("HAPI_LoadAssetLibraryFromFile", session);
+	c.str(file_path);
+	if (c.live()) c.result(HAPI_LoadAssetLibraryFromFile(session, file_path, allow_overwrite, library_id));
+	c.out(library_id);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetAvailableAssetCount(const HAPI_Session* session, HAPI_AssetLibraryId library_id, int* asset_count)
+{
+	StandInCall c("HAPI_GetAvailableAssetCount", session);
+	c.in(library_id);
+	if (c.live()) c.result(HAPI_GetAvailableAssetCount(session, library_id, asset_count));
+	c.out(asset_count);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetAvailableAssets(const HAPI_Session* session, HAPI_AssetLibraryId library_id,
+	HAPI_StringHandle* asset_names_array, int asset_count)
+{
+	StandInCall c("HAPI_GetAvailableAssets", session);
+	c.in(library_id).in(asset_count);
+	if (c.live()) c.result(HAPI_GetAvailableAssets(session, library_id, asset_names_array, asset_count));
+	c.out(asset_names_array, asset_count);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_CreateNode(const HAPI_Session* session, HAPI_NodeId parent_node_id, const char* operator_name,
+	const char* node_label, HAPI_Bool cook_on_creation, HAPI_NodeId* new_node_id)
+{
+	StandInCall c("HAPI_CreateNode", session);
+	c.in(parent_node_id).str(operator_name).str(node_label).in(cook_on_creation);
+	if (c.live()) c.result(HAPI_CreateNode(session, parent_node_id, operator_name, node_label, cook_on_creation, new_node_id));
+	c.out(new_node_id);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_DeleteNode(const HAPI_Session* session, HAPI_NodeId node_id)
+{
+	StandInCall c("HAPI_DeleteNode", session);
+	c.in(node_id);
+	if (c.live()) c.result(HAPI_DeleteNode(session, node_id));
+	return c.finish();
+}
+
+// cook options aren't keyed, their padding bytes aren't reliable
+HAPI_Result HAPI_StandIn_CookNode(const HAPI_Session* session, HAPI_NodeId node_id, const HAPI_CookOptions* cook_options)
+{
+	StandInCall c("HAPI_CookNode", session);
+	c.in(node_id);
+	if (c.live()) c.result(HAPI_CookNode(session, node_id, cook_options));
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetNodeInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_NodeInfo* node_info)
+{
+	StandInCall c("HAPI_GetNodeInfo", session);
+	c.in(node_id);
+	if (c.live()) c.result(HAPI_GetNodeInfo(session, node_id, node_info));
+	c.out(node_info);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_IsNodeValid(const HAPI_Session* session, HAPI_NodeId node_id, int unique_node_id, HAPI_Bool* answer)
+{
+	StandInCall c("HAPI_IsNodeValid", session);
+	c.in(node_id).in(unique_node_id);
+	if (c.live()) c.result(HAPI_IsNodeValid(session, node_id, unique_node_id, answer));
+	c.out(answer);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetAssetInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_AssetInfo* asset_info)
+{
+	StandInCall c("HAPI_GetAssetInfo", session);
+	c.in(node_id);
+	if (c.live()) c.result(HAPI_GetAssetInfo(session, node_id, asset_info));
+	c.out(asset_info);
+	return c.finish();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// objects
+
+HAPI_Result HAPI_StandIn_GetObjectTransform(const HAPI_Session* session, HAPI_NodeId node_id,
+	HAPI_NodeId relative_to_node_id, HAPI_RSTOrder rst_order, HAPI_Transform* transform)
+{
+	StandInCall c("HAPI_GetObjectTransform", session);
+	c.in(node_id).in(relative_to_node_id).in(rst_order);
+	if (c.live()) c.result(HAPI_GetObjectTransform(session, node_id, relative_to_node_id, rst_order, transform));
+	c.out(transform);
+	return c.finish();
+}
+
+// pure maths, but served too so replay needs no session at all
+HAPI_Result HAPI_StandIn_ConvertTransformQuatToMatrix(const HAPI_Session* session, const HAPI_Transform* transform, float* matrix)
+{
+	StandInCall c("HAPI_ConvertTransformQuatToMatrix", session);
+	c.in(transform->position, 3).in(transform->rotationQuaternion, 4).in(transform->scale, 3);
+	if (c.live()) c.result(HAPI_ConvertTransformQuatToMatrix(session, transform, matrix));
+	c.out(matrix, 16);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_ComposeObjectList(const HAPI_Session* session, HAPI_NodeId parent_node_id,
+	const char* categories, int* object_count)
+{
+	StandInCall c("HAPI_ComposeObjectList", session);
+	c.in(parent_node_id).str(categories);
+	if (c.live()) c.result(HAPI_ComposeObjectList(session, parent_node_id, categories, object_count));
+	c.out(object_count);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetComposedObjectList(const HAPI_Session* session, HAPI_NodeId parent_node_id,
+	HAPI_ObjectInfo* object_infos_array, int start, int length)
+{
+	StandInCall c("HAPI_GetComposedObjectList", session);
+	c.in(parent_node_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetComposedObjectList(session, parent_node_id, object_infos_array, start, length));
+	c.out(object_infos_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetComposedObjectTransforms(const HAPI_Session* session, HAPI_NodeId parent_node_id,
+	HAPI_RSTOrder rst_order, HAPI_Transform* transform_array, int start, int length)
+{
+	StandInCall c("HAPI_GetComposedObjectTransforms", session);
+	c.in(parent_node_id).in(rst_order).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetComposedObjectTransforms(session, parent_node_id, rst_order, transform_array, start, length));
+	c.out(transform_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetDisplayGeoInfo(const HAPI_Session* session, HAPI_NodeId object_node_id, HAPI_GeoInfo* geo_info)
+{
+	StandInCall c("HAPI_GetDisplayGeoInfo", session);
+	c.in(object_node_id);
+	if (c.live()) c.result(HAPI_GetDisplayGeoInfo(session, object_node_id, geo_info));
+	c.out(geo_info);
+	return c.finish();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// parts
+
+HAPI_Result HAPI_StandIn_GetPartInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id, HAPI_PartInfo* part_info)
+{
+	StandInCall c("HAPI_GetPartInfo", session);
+	c.in(node_id).in(part_id);
+	if (c.live()) c.result(HAPI_GetPartInfo(session, node_id, part_id, part_info));
+	c.out(part_info);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetAttributeNames(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	HAPI_AttributeOwner owner, HAPI_StringHandle* attribute_names_array, int count)
+{
+	StandInCall c("HAPI_GetAttributeNames", session);
+	c.in(node_id).in(part_id).in(owner).in(count);
+	if (c.live()) c.result(HAPI_GetAttributeNames(session, node_id, part_id, owner, attribute_names_array, count));
+	c.out(attribute_names_array, count);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetAttributeInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	const char* name, HAPI_AttributeOwner owner, HAPI_AttributeInfo* attr_info)
+{
+	StandInCall c("HAPI_GetAttributeInfo", session);
+	c.in(node_id).in(part_id).str(name).in(owner);
+	if (c.live()) c.result(HAPI_GetAttributeInfo(session, node_id, part_id, name, owner, attr_info));
+	c.out(attr_info);
+	return c.finish();
+}
+
+// the data is recorded packed, as count x tupleSize values, and served
+// into the caller's stride
+template<typename T>
+void attrib_data_out(StandInCall& c, const HAPI_AttributeInfo* attr_info, int stride, T* data_array, int length)
+{
+	int tuple = attr_info->tupleSize;
+	if (c.isLive()) return;
+	if (stride <= tuple) {
+		c.out(data_array, length * tuple);
+		return;
+	}
+
+	std::vector<T> packed(length * tuple);
+	for (int i = 0; i < length; ++i) {
+		memcpy(&packed[i * tuple], data_array + i * stride, tuple * sizeof(T));
+	}
+	c.out(packed.empty() ? NULL : &packed[0], int(packed.size()));
+	for (int i = 0; i < length; ++i) {
+		memcpy(data_array + i * stride, &packed[i * tuple], tuple * sizeof(T));
+	}
+}
+
+HAPI_Result HAPI_StandIn_GetAttributeFloatData(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	const char* name, HAPI_AttributeInfo* attr_info, int stride, float* data_array, int start, int length)
+{
+	StandInCall c("HAPI_GetAttributeFloatData", session);
+	c.in(node_id).in(part_id).str(name).in(attr_info->owner).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetAttributeFloatData(session, node_id, part_id, name, attr_info, stride, data_array, start, length));
+	c.out(attr_info);
+	attrib_data_out(c, attr_info, stride, data_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetAttributeIntData(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	const char* name, HAPI_AttributeInfo* attr_info, int stride, int* data_array, int start, int length)
+{
+	StandInCall c("HAPI_GetAttributeIntData", session);
+	c.in(node_id).in(part_id).str(name).in(attr_info->owner).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetAttributeIntData(session, node_id, part_id, name, attr_info, stride, data_array, start, length));
+	c.out(attr_info);
+	attrib_data_out(c, attr_info, stride, data_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetFaceCounts(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	int* face_counts_array, int start, int length)
+{
+	StandInCall c("HAPI_GetFaceCounts", session);
+	c.in(node_id).in(part_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetFaceCounts(session, node_id, part_id, face_counts_array, start, length));
+	c.out(face_counts_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetVertexList(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	int* vertex_list_array, int start, int length)
+{
+	StandInCall c("HAPI_GetVertexList", session);
+	c.in(node_id).in(part_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetVertexList(session, node_id, part_id, vertex_list_array, start, length));
+	c.out(vertex_list_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetCurveInfo(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id, HAPI_CurveInfo* info)
+{
+	StandInCall c("HAPI_GetCurveInfo", session);
+	c.in(node_id).in(part_id);
+	if (c.live()) c.result(HAPI_GetCurveInfo(session, node_id, part_id, info));
+	c.out(info);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetCurveCounts(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	int* counts_array, int start, int length)
+{
+	StandInCall c("HAPI_GetCurveCounts", session);
+	c.in(node_id).in(part_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetCurveCounts(session, node_id, part_id, counts_array, start, length));
+	c.out(counts_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetCurveOrders(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	int* orders_array, int start, int length)
+{
+	StandInCall c("HAPI_GetCurveOrders", session);
+	c.in(node_id).in(part_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetCurveOrders(session, node_id, part_id, orders_array, start, length));
+	c.out(orders_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetCurveKnots(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	float* knots_array, int start, int length)
+{
+	StandInCall c("HAPI_GetCurveKnots", session);
+	c.in(node_id).in(part_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetCurveKnots(session, node_id, part_id, knots_array, start, length));
+	c.out(knots_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetInstancedPartIds(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	HAPI_PartId* instanced_parts_array, int start, int length)
+{
+	StandInCall c("HAPI_GetInstancedPartIds", session);
+	c.in(node_id).in(part_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetInstancedPartIds(session, node_id, part_id, instanced_parts_array, start, length));
+	c.out(instanced_parts_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetInstancerPartTransforms(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_PartId part_id,
+	HAPI_RSTOrder rst_order, HAPI_Transform* transforms_array, int start, int length)
+{
+	StandInCall c("HAPI_GetInstancerPartTransforms", session);
+	c.in(node_id).in(part_id).in(rst_order).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetInstancerPartTransforms(session, node_id, part_id, rst_order, transforms_array, start, length));
+	c.out(transforms_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetMaterialNodeIdsOnFaces(const HAPI_Session* session, HAPI_NodeId geometry_node_id,
+	HAPI_PartId part_id, HAPI_Bool* are_all_the_same, HAPI_NodeId* material_ids_array, int start, int length)
+{
+	StandInCall c("HAPI_GetMaterialNodeIdsOnFaces", session);
+	c.in(geometry_node_id).in(part_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetMaterialNodeIdsOnFaces(session, geometry_node_id, part_id, are_all_the_same,
+		material_ids_array, start, length));
+	c.out(are_all_the_same);
+	c.out(material_ids_array, length);
+	return c.finish();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// parameters
+
+HAPI_Result HAPI_StandIn_GetParameters(const HAPI_Session* session, HAPI_NodeId node_id,
+	HAPI_ParmInfo* parm_infos_array, int start, int length)
+{
+	StandInCall c("HAPI_GetParameters", session);
+	c.in(node_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetParameters(session, node_id, parm_infos_array, start, length));
+	c.out(parm_infos_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetParmInfoFromName(const HAPI_Session* session, HAPI_NodeId node_id, const char* parm_name,
+	HAPI_ParmInfo* parm_info)
+{
+	StandInCall c("HAPI_GetParmInfoFromName", session);
+	c.in(node_id).str(parm_name);
+	if (c.live()) c.result(HAPI_GetParmInfoFromName(session, node_id, parm_name, parm_info));
+	c.out(parm_info);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetParmChoiceLists(const HAPI_Session* session, HAPI_NodeId node_id,
+	HAPI_ParmChoiceInfo* parm_choices_array, int start, int length)
+{
+	StandInCall c("HAPI_GetParmChoiceLists", session);
+	c.in(node_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetParmChoiceLists(session, node_id, parm_choices_array, start, length));
+	c.out(parm_choices_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetParmIntValues(const HAPI_Session* session, HAPI_NodeId node_id, int* values_array, int start, int length)
+{
+	StandInCall c("HAPI_GetParmIntValues", session);
+	c.in(node_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetParmIntValues(session, node_id, values_array, start, length));
+	c.out(values_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetParmFloatValues(const HAPI_Session* session, HAPI_NodeId node_id, float* values_array, int start, int length)
+{
+	StandInCall c("HAPI_GetParmFloatValues", session);
+	c.in(node_id).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetParmFloatValues(session, node_id, values_array, start, length));
+	c.out(values_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetParmStringValues(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_Bool evaluate,
+	HAPI_StringHandle* values_array, int start, int length)
+{
+	StandInCall c("HAPI_GetParmStringValues", session);
+	c.in(node_id).in(evaluate).in(start).in(length);
+	if (c.live()) c.result(HAPI_GetParmStringValues(session, node_id, evaluate, values_array, start, length));
+	c.out(values_array, length);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_SetParmIntValues(const HAPI_Session* session, HAPI_NodeId node_id, const int* values_array, int start, int length)
+{
+	StandInCall c("HAPI_SetParmIntValues", session);
+	c.in(node_id).in(start).in(values_array, length);
+	if (c.live()) c.result(HAPI_SetParmIntValues(session, node_id, values_array, start, length));
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_SetParmFloatValues(const HAPI_Session* session, HAPI_NodeId node_id, const float* values_array, int start, int length)
+{
+	StandInCall c("HAPI_SetParmFloatValues", session);
+	c.in(node_id).in(start).in(values_array, length);
+	if (c.live()) c.result(HAPI_SetParmFloatValues(session, node_id, values_array, start, length));
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_SetParmStringValue(const HAPI_Session* session, HAPI_NodeId node_id, const char* value,
+	HAPI_ParmId parm_id, int index)
+{
+	StandInCall c("HAPI_SetParmStringValue", session);
+	c.in(node_id).str(value).in(parm_id).in(index);
+	if (c.live()) c.result(HAPI_SetParmStringValue(session, node_id, value, parm_id, index));
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_InsertMultiparmInstance(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_ParmId parm_id, int instance_position)
+{
+	StandInCall c("HAPI_InsertMultiparmInstance", session);
+	c.in(node_id).in(parm_id).in(instance_position);
+	if (c.live()) c.result(HAPI_InsertMultiparmInstance(session, node_id, parm_id, instance_position));
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_RemoveMultiparmInstance(const HAPI_Session* session, HAPI_NodeId node_id, HAPI_ParmId parm_id, int instance_position)
+{
+	StandInCall c("HAPI_RemoveMultiparmInstance", session);
+	c.in(node_id).in(parm_id).in(instance_position);
+	if (c.live()) c.result(HAPI_RemoveMultiparmInstance(session, node_id, parm_id, instance_position));
+	return c.finish();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// materials and images
+
+HAPI_Result HAPI_StandIn_GetMaterialInfo(const HAPI_Session* session, HAPI_NodeId material_node_id, HAPI_MaterialInfo* material_info)
+{
+	StandInCall c("HAPI_GetMaterialInfo", session);
+	c.in(material_node_id);
+	if (c.live()) c.result(HAPI_GetMaterialInfo(session, material_node_id, material_info));
+	c.out(material_info);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_RenderTextureToImage(const HAPI_Session* session, HAPI_NodeId material_node_id, HAPI_ParmId parm_id)
+{
+	StandInCall c("HAPI_RenderTextureToImage", session);
+	c.in(material_node_id).in(parm_id);
+	if (c.live()) c.result(HAPI_RenderTextureToImage(session, material_node_id, parm_id));
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetImageInfo(const HAPI_Session* session, HAPI_NodeId material_node_id, HAPI_ImageInfo* image_info)
+{
+	StandInCall c("HAPI_GetImageInfo", session);
+	c.in(material_node_id);
+	if (c.live()) c.result(HAPI_GetImageInfo(session, material_node_id, image_info));
+	c.out(image_info);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetImagePlaneCount(const HAPI_Session* session, HAPI_NodeId material_node_id, int* image_plane_count)
+{
+	StandInCall c("HAPI_GetImagePlaneCount", session);
+	c.in(material_node_id);
+	if (c.live()) c.result(HAPI_GetImagePlaneCount(session, material_node_id, image_plane_count));
+	c.out(image_plane_count);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetImagePlanes(const HAPI_Session* session, HAPI_NodeId material_node_id,
+	HAPI_StringHandle* image_planes_array, int image_plane_count)
+{
+	StandInCall c("HAPI_GetImagePlanes", session);
+	c.in(material_node_id).in(image_plane_count);
+	if (c.live()) c.result(HAPI_GetImagePlanes(session, material_node_id, image_planes_array, image_plane_count));
+	c.out(image_planes_array, image_plane_count);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_ExtractImageToMemory(const HAPI_Session* session, HAPI_NodeId material_node_id,
+	const char* image_file_format_name, const char* image_planes, int* buffer_size)
+{
+	StandInCall c("HAPI_ExtractImageToMemory", session);
+	c.in(material_node_id).str(image_file_format_name).str(image_planes);
+	if (c.live()) c.result(HAPI_ExtractImageToMemory(session, material_node_id, image_file_format_name, image_planes, buffer_size));
+	c.out(buffer_size);
+	return c.finish();
+}
+
+HAPI_Result HAPI_StandIn_GetImageMemoryBuffer(const HAPI_Session* session, HAPI_NodeId material_node_id, char* buffer, int length)
+{
+	StandInCall c("HAPI_GetImageMemoryBuffer", session);
+	c.in(material_node_id).in(length);
+	if (c.live()) c.result(HAPI_GetImageMemoryBuffer(session, material_node_id, buffer, length));
+	c.out(buffer, length);
+	return c.finish();
+}
@@ -0,0 +1,267 @@
+/******************************************************************************
+Houdini Engine Module for Omegalib
+
+Authors:
+  Darren Lee             darren.lee@uts.edu.au
+
+Copyright 2015-2016,     Data Arena, University of Technology Sydney
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and authors, and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the Data Arena Project.
+
+-------------------------------------------------------------------------------
+
+daHEngine
+	HAPI call tracing, see hapiTrace.h
+
+******************************************************************************/
+
+#include <daHoudiniEngine/hapiTrace.h>
+
+#include <osg/Timer>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+#include <OpenThreads/Thread>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace hapi;
+
+namespace {
+
+	// events kept for the json, calls past this are still counted per site
+	const size_t MAX_TRACE_EVENTS = 1 << 20;
+
+	struct TraceEvent
+	{
+		const char* call;
+		const char* file;
+		int line;
+		size_t bytes;
+		double start;
+		double duration;
+		int thread;
+	};
+
+	struct TraceSite
+	{
+		TraceSite(): calls(0), total(0), longest(0), bytes(0) {}
+
+		std::string name;
+		std::string site;
+		int calls;
+		double total;
+		double longest;
+		size_t bytes;
+	};
+
+	OpenThreads::Mutex traceMutex;
+	std::vector<TraceEvent> traceEvents;
+	std::map<std::string, TraceSite> traceSites;
+	int traceCalls = 0;
+	osg::Timer_t traceStart = 0;
+
+	// the HAPI function name from the stringified call, or the whole of a
+	// HAPI_TRACE_SCOPE name. Stand-in calls (hapiStandIn.h) get the name
+	// of the function they stand in for
+	std::string call_name(const char* call)
+	{
+		const char* end = call;
+		while (*end != '\0' && *end != '(') ++end;
+		// "HAPI_Foo (" is the same call as "HAPI_Foo("
+		while (end > call && isspace((unsigned char) end[-1])) --end;
+		std::string name(call, end);
+		if (name.compare(0, 13, "HAPI_StandIn_") == 0) name.erase(5, 8);
+		return name;
+	}
+
+	// file name without its directories
+	std::string call_site(const char* file, int line)
+	{
+		const char* name = file;
+		for (const char* c = file; *c != '\0'; ++c) {
+			if (*c == '/' || *c == '\\') name = c + 1;
+		}
+		std::ostringstream os;
+		os << name << ":" << line;
+		return os.str();
+	}
+
+	std::string json_escape(const std::string& s)
+	{
+		std::string result;
+		for (size_t i = 0; i < s.size(); ++i) {
+			char c = s[i];
+			if (c == '"' || c == '\\') {
+				result += '\\';
+				result += c;
+			} else if ((unsigned char)c < 0x20) {
+				char buf[8];
+				sprintf(buf, "\\u%04x", (unsigned char)c);
+				result += buf;
+			} else {
+				result += c;
+			}
+		}
+		return result;
+	}
+
+	bool slowest_first(const TraceSite* a, const TraceSite* b)
+	{
+		return a->total > b->total;
+	}
+};
+
+bool Trace::myEnabled = false;
+
+///////////////////////////////////////////////////////////////////////////////
+void Trace::setEnabled(bool toggle)
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(traceMutex);
+	if (traceStart == 0) traceStart = osg::Timer::instance()->tick();
+	myEnabled = toggle;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Trace::clear()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(traceMutex);
+	traceEvents.clear();
+	traceSites.clear();
+	traceCalls = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Trace::getCallCount()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(traceMutex);
+	return traceCalls;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double Trace::now()
+{
+	return osg::Timer::instance()->delta_u(traceStart, osg::Timer::instance()->tick());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Trace::record(const char* call, const char* file, int line,
+	size_t bytes, double start, double end)
+{
+	OpenThreads::Thread* thread = OpenThreads::Thread::CurrentThread();
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(traceMutex);
+	traceCalls++;
+
+	if (traceEvents.size() < MAX_TRACE_EVENTS) {
+		TraceEvent e;
+		e.call = call;
+		e.file = file;
+		e.line = line;
+		e.bytes = bytes;
+		e.start = start;
+		e.duration = end - start;
+		// threads not started through OpenThreads (the main one) are 0
+		e.thread = thread == NULL ? 0 : thread->getThreadId();
+		traceEvents.push_back(e);
+	}
+
+	std::string site = call_site(file, line);
+	TraceSite& s = traceSites[site];
+	if (s.calls == 0) {
+		s.name = call_name(call);
+		s.site = site;
+	}
+	s.calls++;
+	s.total += end - start;
+	s.longest = std::max(s.longest, end - start);
+	s.bytes += bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Trace::writeChromeTrace(const std::string& path)
+{
+	std::ofstream out(path.c_str());
+	if (!out) return false;
+	out.setf(std::ios::fixed);
+	out.precision(3);
+
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(traceMutex);
+
+	// complete ("X") events, times in microseconds
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	for (size_t i = 0; i < traceEvents.size(); ++i) {
+		const TraceEvent& e = traceEvents[i];
+		std::string name = call_name(e.call);
+		bool isHapi = name.compare(0, 5, "HAPI_") == 0;
+
+		out << (i == 0 ? "\n" : ",\n");
+		out << "{\"name\":\"" << json_escape(name) << "\"" <<
+			",\"cat\":\"" << (isHapi ? "hapi" : "daHEngine") << "\"" <<
+			",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread <<
+			",\"ts\":" << e.start << ",\"dur\":" << e.duration <<
+			",\"args\":{\"site\":\"" << json_escape(call_site(e.file, e.line)) << "\"" <<
+			",\"bytes\":" << e.bytes << "}}";
+	}
+	out << "\n]}\n";
+
+	return out.good();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+std::string Trace::summary()
+{
+	OpenThreads::ScopedLock<OpenThreads::Mutex> lock(traceMutex);
+
+	std::vector<const TraceSite*> sites;
+	for (std::map<std::string, TraceSite>::const_iterator i = traceSites.begin();
+		i != traceSites.end(); ++i) {
+		sites.push_back(&i->second);
+	}
+	std::sort(sites.begin(), sites.end(), slowest_first);
+
+	std::ostringstream os;
+	char buf[256];
+	sprintf(buf, "%8s %10s %10s %12s  %s\n", "calls", "total ms", "max ms", "bytes", "call (site)");
+	os << buf;
+	for (size_t i = 0; i < sites.size(); ++i) {
+		const TraceSite* s = sites[i];
+		sprintf(buf, "%8d %10.3f %10.3f %12lu  ", s->calls, s->total / 1000.0,
+			s->longest / 1000.0, (unsigned long) s->bytes);
+		os << buf << s->name << " (" << s->site << ")\n";
+	}
+	os << traceCalls << " calls";
+	if (traceCalls > int(traceEvents.size())) {
+		os << ", " << traceEvents.size() << " kept for the trace";
+	}
+	os << "\n";
+	return os.str();
+}
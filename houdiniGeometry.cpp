@@ -75,6 +75,8 @@ HoudiniGeometry::HoudiniGeometry(const String& name):
 	oflog(Debug, "[HoudiniGeometry] %1%", %myName);
 	// create geometry and geodes to hold the data
 	myNode = new osg::Group();
+	objectsChanged = false;
+	hapiSynced = false;
 
 	addObject(1);
 	addGeode(1, 0);
@@ -101,6 +103,13 @@ int HoudiniGeometry::addDrawable(const int count, const int geodeIndex, const in
 		hobjs[objIndex].hgeoms[geodeIndex].hparts.back().geometry->setVertexArray(hobjs[objIndex].hgeoms[geodeIndex].hparts.back().vertices);
 		hobjs[objIndex].hgeoms[geodeIndex].geode->addDrawable(hobjs[objIndex].hgeoms[geodeIndex].hparts.back().geometry);
 		hobjs[objIndex].hgeoms[geodeIndex].hparts.back().transparent = false;
+		hobjs[objIndex].hgeoms[geodeIndex].hparts.back().matId = -1;
+		hobjs[objIndex].hgeoms[geodeIndex].hparts.back().hash = HASH_SEED;
+		hobjs[objIndex].hgeoms[geodeIndex].hparts.back().sentHash = 0;
+		hobjs[objIndex].hgeoms[geodeIndex].hparts.back().instanceHash = HASH_SEED;
+		hobjs[objIndex].hgeoms[geodeIndex].hparts.back().sentInstanceHash = 0;
+		hobjs[objIndex].hgeoms[geodeIndex].hparts.back().topology = 0;
+		hobjs[objIndex].hgeoms[geodeIndex].hparts.back().instanced = false;
 	}
 	return hobjs[objIndex].hgeoms[geodeIndex].geode->getNumDrawables();
 }
@@ -141,6 +150,7 @@ int HoudiniGeometry::addObject(const int count)
 	for (int i = 0; i < count; ++i) {
 		hobjs.push_back(HObj());
 		hobjs.back().trans = new osg::PositionAttitudeTransform();
+		hobjs.back().transformSent = false;
 		myNode->addChild(hobjs.back().trans);
 	}
 	return myNode->getNumChildren();
@@ -175,7 +185,7 @@ Vector3f HoudiniGeometry::getVertex(int index, const int drawableIndex, const in
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-int HoudiniGeometry::addColor(const Color& c, const int drawableIndex, const int geodeIndex, const int objIndex)
+osg::Vec4Array* HoudiniGeometry::getOrCreateColorArray(const int drawableIndex, const int geodeIndex, const int objIndex)
 {
 	oassert(hobjs[objIndex].hgeoms[geodeIndex].hparts.size() > drawableIndex);
 	if(hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].colors == NULL)
@@ -184,8 +194,15 @@ int HoudiniGeometry::addColor(const Color& c, const int drawableIndex, const int
 		hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].geometry->setColorArray(hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].colors);
 		hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].geometry->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
 	}
-	hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].colors->push_back(osg::Vec4d(c[0], c[1], c[2], c[3]));
-	return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].colors->size() - 1;
+	return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].colors;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int HoudiniGeometry::addColor(const Color& c, const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	osg::Vec4Array* colors = getOrCreateColorArray(drawableIndex, geodeIndex, objIndex);
+	colors->push_back(osg::Vec4d(c[0], c[1], c[2], c[3]));
+	return colors->size() - 1;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -230,7 +247,50 @@ void HoudiniGeometry::addPrimitiveOsg(osg::PrimitiveSet::Mode type, int startInd
 	hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].geometry->addPrimitiveSet(new osg::DrawArrays(type, startIndex, endIndex));
 }
 
+///////////////////////////////////////////////////////////////////////////////
+osg::DrawElementsUInt* HoudiniGeometry::addPrimitiveElements(osg::PrimitiveSet::Mode type, const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	osg::DrawElementsUInt* de = new osg::DrawElementsUInt(type);
+	hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].geometry->addPrimitiveSet(de);
+	return de;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+void HoudiniGeometry::setPartArrays(const PartArrays& arrays, const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	oassert(hobjs[objIndex].hgeoms[geodeIndex].hparts.size() > drawableIndex);
+	HPart* hpart = &hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex];
+
+	hpart->vertices = arrays.vertices;
+	hpart->geometry->setVertexArray(hpart->vertices);
+
+	hpart->normals = arrays.normals;
+	hpart->geometry->setNormalArray(hpart->normals);
+	if (hpart->normals != NULL) {
+		hpart->geometry->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
+	}
+
+	hpart->colors = arrays.colors;
+	hpart->geometry->setColorArray(hpart->colors);
+	if (hpart->colors != NULL) {
+		hpart->geometry->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
+	}
+
+	hpart->uvs = arrays.uvs;
+	hpart->geometry->setTexCoordArray(0, hpart->uvs, osg::Array::BIND_PER_VERTEX);
 
+	hpart->geometry->removePrimitiveSet(0, hpart->geometry->getNumPrimitiveSets());
+	for (int i = 0; i < arrays.primitives.size(); ++i) {
+		hpart->geometry->addPrimitiveSet(arrays.primitives[i]);
+	}
+
+	hpart->topology = arrays.topology;
+	hpart->sourcePoints = arrays.sourcePoints;
+	hpart->sourceCorners = arrays.sourceCorners;
+
+	dirtyDrawable(drawableIndex, geodeIndex, objIndex);
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 void HoudiniGeometry::clear()
@@ -259,9 +319,49 @@ void HoudiniGeometry::clearDrawable(const int drawableIndex, const int geodeInde
 
 	if (hpart->colors != NULL) hpart->colors->clear();
 	if (hpart->normals != NULL) hpart->normals->clear();
+	if (hpart->uvs != NULL) hpart->uvs->clear();
 	hpart->vertices->clear();
 	hpart->geometry->removePrimitiveSet(0, hpart->geometry->getNumPrimitiveSets());
 	hpart->geometry->dirtyBound();
+
+	hpart->topology = 0;
+	hpart->sourcePoints.clear();
+	hpart->sourceCorners.clear();
+
+	clearInstances(drawableIndex, geodeIndex, objIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void HoudiniGeometry::setInstances(const vector<osg::Matrixf>& instances, const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	HPart* hpart = &hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex];
+
+	if (hpart->instancer == NULL) {
+		hpart->instancer = new InstancedDrawable(hpart->geometry);
+	}
+	hpart->instancer->setInstances(instances);
+
+	// swap the instancer in, taking the part's state along
+	if (!hpart->instanced) {
+		hpart->instancer->setStateSet(hpart->geometry->getStateSet());
+		hpart->geometry->setStateSet(NULL);
+		hobjs[objIndex].hgeoms[geodeIndex].geode->setDrawable(drawableIndex, hpart->instancer);
+		hpart->instanced = true;
+	}
+}
+
+void HoudiniGeometry::clearInstances(const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	HPart* hpart = &hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex];
+
+	if (!hpart->instanced) {
+		return;
+	}
+
+	hpart->geometry->setStateSet(hpart->instancer->getStateSet());
+	hpart->instancer->setStateSet(NULL);
+	hobjs[objIndex].hgeoms[geodeIndex].geode->setDrawable(drawableIndex, hpart->geometry);
+	hpart->instanced = false;
 }
 
 
@@ -271,16 +371,111 @@ void HoudiniGeometry::dirty()
 	for (int obj = 0; obj < hobjs.size(); ++obj) {
 		for (int g = 0; g < hobjs[obj].hgeoms.size(); ++g) {
 			for (int i = 0; i < hobjs[obj].hgeoms[g].hparts.size(); ++i) {
-				hobjs[obj].hgeoms[g].hparts[i].vertices->dirty();
-				if (hobjs[obj].hgeoms[g].hparts[i].colors != NULL) hobjs[obj].hgeoms[g].hparts[i].colors->dirty();
-				if (hobjs[obj].hgeoms[g].hparts[i].normals != NULL) hobjs[obj].hgeoms[g].hparts[i].normals->dirty();
+				dirtyDrawable(i, g, obj);
 			}
 		}
 	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-int HoudiniGeometry::addNormal(const Vector3f& v, const int drawableIndex, const int geodeIndex, const int objIndex)
+void HoudiniGeometry::dirtyDrawable(const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	HPart* hpart = &hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex];
+
+	hpart->vertices->dirty();
+	if (hpart->colors != NULL) hpart->colors->dirty();
+	if (hpart->normals != NULL) hpart->normals->dirty();
+	if (hpart->uvs != NULL) hpart->uvs->dirty();
+	hpart->geometry->dirtyBound();
+	if (hpart->instancer != NULL) hpart->instancer->dirtyBound();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void HoudiniGeometry::updateHash(const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	HPart* hpart = &hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex];
+
+	HashValue h = hashArray(hpart->vertices.get());
+	h = hashArray(hpart->normals.get(), h);
+	h = hashArray(hpart->colors.get(), h);
+	h = hashArray(hpart->uvs.get(), h);
+
+	// primitive sets are sent as mode, first, count or as mode and indices
+	osg::Geometry::PrimitiveSetList& psl = hpart->geometry->getPrimitiveSetList();
+	for (int i = 0; i < psl.size(); ++i) {
+		osg::DrawArrays* da = dynamic_cast<osg::DrawArrays*>(psl[i].get());
+		osg::DrawElementsUInt* de = dynamic_cast<osg::DrawElementsUInt*>(psl[i].get());
+		if (da != NULL) {
+			int ps[3] = { int(da->getMode()), int(da->getFirst()), int(da->getCount()) };
+			h = hashBytes(ps, sizeof(ps), h);
+		} else if (de != NULL) {
+			int mode = int(de->getMode());
+			h = hashBytes(&mode, sizeof(mode), h);
+			h = hashArray(de, h);
+		}
+	}
+
+	h = hashBytes(&hpart->matId, sizeof(hpart->matId), h);
+	h = hashBytes(&hpart->transparent, sizeof(hpart->transparent), h);
+
+	hpart->hash = h;
+
+	// instanced parts also send their transforms, on their own
+	HashValue ih = hashBytes(&hpart->instanced, sizeof(hpart->instanced));
+	if (hpart->instanced) {
+		ih = hashArray(&hpart->instancer->getInstances(), ih);
+	}
+	hpart->instanceHash = ih;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool HoudiniGeometry::isGeodeDirty(const int geodeIndex, const int objIndex)
+{
+	for (int i = 0; i < hobjs[objIndex].hgeoms[geodeIndex].hparts.size(); ++i) {
+		if (isDrawableDirty(i, geodeIndex, objIndex)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool HoudiniGeometry::isObjDirty(const int objIndex)
+{
+	for (int g = 0; g < hobjs[objIndex].hgeoms.size(); ++g) {
+		if (isGeodeDirty(g, objIndex)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool HoudiniGeometry::isTransformDirty(const int objIndex)
+{
+	HObj* hobj = &hobjs[objIndex];
+	osg::PositionAttitudeTransform* pat = hobj->trans->asPositionAttitudeTransform();
+
+	return !hobj->transformSent ||
+		pat->getPosition() != hobj->sentPos ||
+		pat->getAttitude() != hobj->sentRot ||
+		pat->getScale() != hobj->sentScale;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void HoudiniGeometry::setTransformSent(const int objIndex)
+{
+	HObj* hobj = &hobjs[objIndex];
+	osg::PositionAttitudeTransform* pat = hobj->trans->asPositionAttitudeTransform();
+
+	hobj->sentPos = pat->getPosition();
+	hobj->sentRot = pat->getAttitude();
+	hobj->sentScale = pat->getScale();
+	hobj->transformSent = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+osg::Vec3Array* HoudiniGeometry::getOrCreateNormalArray(const int drawableIndex, const int geodeIndex, const int objIndex)
 {
 	oassert(hobjs[objIndex].hgeoms[geodeIndex].hparts.size() > drawableIndex);
 	if(hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].normals == NULL) {
@@ -288,9 +483,15 @@ int HoudiniGeometry::addNormal(const Vector3f& v, const int drawableIndex, const
 		hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].geometry->setNormalArray(hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].normals);
 		hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].geometry->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
 	}
+	return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].normals;
+}
 
-	hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].normals->push_back(osg::Vec3d(v[0], v[1], v[2]));
-	return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].normals->size() - 1;
+///////////////////////////////////////////////////////////////////////////////
+int HoudiniGeometry::addNormal(const Vector3f& v, const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	osg::Vec3Array* normals = getOrCreateNormalArray(drawableIndex, geodeIndex, objIndex);
+	normals->push_back(osg::Vec3d(v[0], v[1], v[2]));
+	return normals->size() - 1;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -313,7 +514,7 @@ Vector3f HoudiniGeometry::getNormal(int index, const int drawableIndex, const in
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-int HoudiniGeometry::addUV(const Vector3f& uv, const int drawableIndex, const int geodeIndex, const int objIndex)
+osg::Vec3Array* HoudiniGeometry::getOrCreateUVArray(const int drawableIndex, const int geodeIndex, const int objIndex)
 {
 	oassert(hobjs[objIndex].hgeoms[geodeIndex].hparts.size() > drawableIndex);
 	if(hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].uvs == NULL) {
@@ -321,9 +522,15 @@ int HoudiniGeometry::addUV(const Vector3f& uv, const int drawableIndex, const in
 		hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].geometry->
 			setTexCoordArray(0, hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].uvs, osg::Array::BIND_PER_VERTEX);
 	}
+	return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].uvs;
+}
 
-	hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].uvs->push_back(osg::Vec3d(uv[0], uv[1], uv[2]));
-	return hobjs[objIndex].hgeoms[geodeIndex].hparts[drawableIndex].uvs->size() - 1;
+///////////////////////////////////////////////////////////////////////////////
+int HoudiniGeometry::addUV(const Vector3f& uv, const int drawableIndex, const int geodeIndex, const int objIndex)
+{
+	osg::Vec3Array* uvs = getOrCreateUVArray(drawableIndex, geodeIndex, objIndex);
+	uvs->push_back(osg::Vec3d(uv[0], uv[1], uv[2]));
+	return uvs->size() - 1;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -345,3 +552,59 @@ Vector3f HoudiniGeometry::getUV(int index, const int drawableIndex, const int ge
 	return Vector3f(c[0], c[1], c[2]);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// each instance is the source drawn with its transform in front of the
+// current model view. Not hardware instancing: the generated cyclops shaders
+// have no per-instance input, but the arrays are only uploaded once
+void InstancedDrawable::drawImplementation(osg::RenderInfo& renderInfo) const
+{
+	osg::State& state = *renderInfo.getState();
+	const osg::Matrix modelView = state.getModelViewMatrix();
+
+	for (int i = 0; i < myInstances.size(); ++i) {
+		state.applyModelViewMatrix(osg::Matrix(myInstances[i]) * modelView);
+		mySource->drawImplementation(renderInfo);
+	}
+
+	state.applyModelViewMatrix(modelView);
+}
+
+void InstancedDrawable::compileGLObjects(osg::RenderInfo& renderInfo) const
+{
+	mySource->compileGLObjects(renderInfo);
+}
+
+void InstancedDrawable::resizeGLObjectBuffers(unsigned int maxSize)
+{
+	osg::Drawable::resizeGLObjectBuffers(maxSize);
+	mySource->resizeGLObjectBuffers(maxSize);
+}
+
+void InstancedDrawable::releaseGLObjects(osg::State* state) const
+{
+	osg::Drawable::releaseGLObjects(state);
+	mySource->releaseGLObjects(state);
+}
+
+// the source's box at every instance
+#if OSG_VERSION_GREATER_OR_EQUAL(3, 3, 2)
+osg::BoundingBox InstancedDrawable::computeBoundingBox() const
+{
+	const osg::BoundingBox& source = mySource->getBoundingBox();
+#else
+osg::BoundingBox InstancedDrawable::computeBound() const
+{
+	const osg::BoundingBox& source = mySource->getBound();
+#endif
+	osg::BoundingBox bb;
+	if (!source.valid()) {
+		return bb;
+	}
+
+	for (int i = 0; i < myInstances.size(); ++i) {
+		for (unsigned int c = 0; c < 8; ++c) {
+			bb.expandBy(source.corner(c) * myInstances[i]);
+		}
+	}
+	return bb;
+}
@@ -620,7 +620,8 @@ void HoudiniUiParm::handleEvent(const Event& evt) {
 			}
 		}
 		
+		// cook_one has already waited for the cook, or queued it with async
+		// cooking on
 		he->cook();
-		he->wait_for_cook();
 	}
 }